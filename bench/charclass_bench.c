@@ -0,0 +1,138 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/lib/charclass/charclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "bytes/cycle"
+#else
+#define BENCH_UNIT "bytes/ns"
+#endif
+
+#define BUFFER_SIZE (64 * 1024 * 1024)
+#define ROUNDS 5
+
+static uint64_t now();
+static void fill_text(char *buffer, size_t length);
+static size_t legacy_path(char *buffer, size_t length);
+static double measure_kernel(CharclassKernel kernel, const char *text, char *work, size_t length);
+static double measure_legacy(const char *text, char *work, size_t length);
+
+int main(int argc, char *argv[]){
+    size_t length = BUFFER_SIZE;
+    char *text = malloc(length);
+    char *work = malloc(length);
+    if(!text || !work){
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    fill_text(text, length);
+    printf("{\n");
+    printf("  \"benchmark\": \"charclass\",\n");
+    printf("  \"bytes\": %zu,\n", length);
+    printf("  \"rounds\": %d,\n", ROUNDS);
+    printf("  \"unit\": \"%s\",\n", BENCH_UNIT);
+    printf("  \"results\": [\n");
+    printf("    {\"name\": \"legacy\", \"throughput\": %.3f}", measure_legacy(text, work, length));
+    const char *names[] = {"scalar", "sse2", "avx2"};
+    for(int kernel = CHARCLASS_SCALAR; kernel <= CHARCLASS_AVX2; kernel++){
+        if(charclass_kernel_is_supported(kernel)){
+            printf(",\n    {\"name\": \"%s\", \"throughput\": %.3f}", names[kernel], measure_kernel(kernel, text, work, length));
+        }
+    }
+    printf("\n  ]\n");
+    printf("}\n");
+    free(text);
+    free(work);
+    return EXIT_SUCCESS;
+}
+
+static uint64_t now(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* Parole di lunghezza variabile con maiuscole, cifre e punteggiatura */
+static void fill_text(char *buffer, size_t length){
+    const char *alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.,;!";
+    const char *spaces = "      \n\t";
+    srand(42);
+    size_t i = 0;
+    while(i < length){
+        int word_length = 1 + rand() % 12;
+        for(int j = 0; j < word_length && i < length; j++){
+            buffer[i++] = alphabet[rand() % 66];
+        }
+        if(i < length){
+            buffer[i++] = spaces[rand() % 8];
+        }
+    }
+}
+
+/* Il percorso di get_word() e word_is_valid() precedente al kernel */
+static size_t legacy_path(char *buffer, size_t length){
+    size_t valid = 0, i = 0;
+    while(i < length){
+        while(i < length && isspace((unsigned char) buffer[i]))
+            i++;
+        size_t start = i;
+        while(i < length && !isblank((unsigned char) buffer[i]) && !isspace((unsigned char) buffer[i])){
+            buffer[i] = tolower((unsigned char) buffer[i]);
+            i++;
+        }
+        bool is_valid = i > start;
+        for(size_t j = start; j < i; j++){
+            if(!isalnum((unsigned char) buffer[j]) || isdigit((unsigned char) buffer[j])){
+                is_valid = false;
+                break;
+            }
+        }
+        valid += is_valid;
+    }
+    return valid;
+}
+
+static double measure_legacy(const char *text, char *work, size_t length){
+    uint64_t best = UINT64_MAX;
+    volatile size_t sink = 0;
+    for(int round = 0; round < ROUNDS; round++){
+        memcpy(work, text, length);
+        uint64_t begin = now();
+        sink += legacy_path(work, length);
+        uint64_t elapsed = now() - begin;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    (void) sink;
+    return (double) length / best;
+}
+
+static double measure_kernel(CharclassKernel kernel, const char *text, char *work, size_t length){
+    size_t words = (length + 63) / 64;
+    uint64_t *delimiters = malloc(words * sizeof(uint64_t));
+    uint64_t *non_alnum = malloc(words * sizeof(uint64_t));
+    uint64_t *digits = malloc(words * sizeof(uint64_t));
+    uint64_t best = UINT64_MAX;
+    for(int round = 0; round < ROUNDS; round++){
+        memcpy(work, text, length);
+        uint64_t begin = now();
+        charclass_scan_with_kernel(kernel, work, length, delimiters, non_alnum, digits);
+        uint64_t elapsed = now() - begin;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    free(delimiters);
+    free(non_alnum);
+    free(digits);
+    return (double) length / best;
+}
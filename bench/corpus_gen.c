@@ -0,0 +1,176 @@
+#define _XOPEN_SOURCE 700
+
+#include "zipf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DEFAULT_VOCABULARY 50000
+#define DEFAULT_FILES 1000
+#define DEFAULT_WORDS 1000
+#define DEFAULT_EXPONENT 1.0
+#define DEFAULT_SEED 42
+#define DEFAULT_FILES_PER_FOLDER 100
+#define WORDS_PER_LINE 12
+/* La deviazione standard del logaritmo delle dimensioni lognormali */
+#define LOGNORMAL_SIGMA 1.0
+
+typedef enum SizeDistribution {
+    SIZE_FIXED,
+    SIZE_UNIFORM,
+    SIZE_LOGNORMAL
+} SizeDistribution;
+
+static const char *SizeDistributionNames[] = {"fixed", "uniform", "lognormal"};
+
+static size_t next_file_words(SizeDistribution distribution, size_t mean, Zipf *zipf);
+static void usage(const char *name);
+
+/*
+ * Genera un corpus sintetico e riproducibile: files file di testo,
+ * divisi in cartelle, con parole estratte da una distribuzione di
+ * Zipf e un numero di parole per file che segue la distribuzione
+ * scelta. Al termine stampa in JSON i parametri e le dimensioni
+ * del corpus, da allegare ai risultati dei benchmark.
+ */
+int main(int argc, char *argv[]){
+    size_t vocabulary = DEFAULT_VOCABULARY;
+    size_t files = DEFAULT_FILES;
+    size_t mean_words = DEFAULT_WORDS;
+    size_t files_per_folder = DEFAULT_FILES_PER_FOLDER;
+    double exponent = DEFAULT_EXPONENT;
+    unsigned long long seed = DEFAULT_SEED;
+    SizeDistribution distribution = SIZE_LOGNORMAL;
+    int opt;
+    while( (opt = getopt(argc, argv, "v:n:w:d:z:s:p:")) != -1){
+        switch(opt){
+            case 'v': vocabulary = strtoul(optarg, NULL, 10);
+                break;
+            case 'n': files = strtoul(optarg, NULL, 10);
+                break;
+            case 'w': mean_words = strtoul(optarg, NULL, 10);
+                break;
+            case 'p': files_per_folder = strtoul(optarg, NULL, 10);
+                break;
+            case 'z': exponent = strtod(optarg, NULL);
+                break;
+            case 's': seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'd': {
+                size_t i = 0;
+                while(i < 3 && strcmp(optarg, SizeDistributionNames[i]) != 0){
+                    i++;
+                }
+                if(i == 3){
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                distribution = i;
+            } break;
+            default: usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(optind != argc - 1 || vocabulary == 0 || files_per_folder == 0 || exponent < 0){
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *directory = argv[optind];
+    if(mkdir(directory, 0755) < 0 && errno != EEXIST){
+        perror(directory);
+        return EXIT_FAILURE;
+    }
+    Zipf *zipf = zipf_new(vocabulary, exponent, seed);
+    if(!zipf){
+        perror("zipf_new");
+        return EXIT_FAILURE;
+    }
+
+    size_t path_size = strlen(directory) + 32;
+    char *path = malloc(path_size);
+    if(!path){
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    char word[ZIPF_MAX_WORD_LENGTH + 1];
+    size_t total_words = 0, total_bytes = 0, largest = 0;
+    for(size_t i = 0; i < files; i++){
+        if(i % files_per_folder == 0){
+            snprintf(path, path_size, "%s/d%04zu", directory, i / files_per_folder);
+            if(mkdir(path, 0755) < 0 && errno != EEXIST){
+                perror(path);
+                return EXIT_FAILURE;
+            }
+        }
+        snprintf(path, path_size, "%s/d%04zu/f%06zu.txt", directory, i / files_per_folder, i);
+        FILE *file = fopen(path, "w");
+        if(!file){
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        size_t words = next_file_words(distribution, mean_words, zipf);
+        size_t bytes = 0;
+        for(size_t j = 0; j < words; j++){
+            size_t length = zipf_word(zipf_next_rank(zipf), zipf, word);
+            fputs(word, file);
+            fputc((j % WORDS_PER_LINE == WORDS_PER_LINE - 1 || j == words - 1) ? '\n' : ' ', file);
+            bytes += length + 1;
+        }
+        if(fclose(file) != 0){
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        total_words += words;
+        total_bytes += bytes;
+        if(bytes > largest){
+            largest = bytes;
+        }
+    }
+
+    printf("{\n");
+    printf("  \"directory\": \"%s\",\n", directory);
+    printf("  \"vocabulary\": %zu,\n", vocabulary);
+    printf("  \"exponent\": %g,\n", exponent);
+    printf("  \"seed\": %llu,\n", seed);
+    printf("  \"size_distribution\": \"%s\",\n", SizeDistributionNames[distribution]);
+    printf("  \"mean_words_per_file\": %zu,\n", mean_words);
+    printf("  \"files\": %zu,\n", files);
+    printf("  \"words\": %zu,\n", total_words);
+    printf("  \"bytes\": %zu,\n", total_bytes);
+    printf("  \"largest_file_bytes\": %zu\n", largest);
+    printf("}\n");
+    free(path);
+    zipf_destroy(zipf);
+    return EXIT_SUCCESS;
+}
+
+/* La media di tutte le distribuzioni è mean */
+static size_t next_file_words(SizeDistribution distribution, size_t mean, Zipf *zipf){
+    switch(distribution){
+        case SIZE_FIXED:
+            return mean;
+        case SIZE_UNIFORM:
+            return (size_t) (zipf_uniform(zipf) * (2 * mean + 1));
+        case SIZE_LOGNORMAL: {
+            if(mean == 0){
+                return 0;
+            }
+            /* Box-Muller; 1 - u evita log(0) */
+            double u = 1 - zipf_uniform(zipf), v = zipf_uniform(zipf);
+            double normal = sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+            double mu = log(mean) - LOGNORMAL_SIGMA * LOGNORMAL_SIGMA / 2;
+            return (size_t) llround(exp(mu + LOGNORMAL_SIGMA * normal));
+        }
+    }
+    return mean;
+}
+
+static void usage(const char *name){
+    fprintf(stderr, "Usage: %s [-v vocabulary] [-n files] [-w mean words per file] "
+        "[-d fixed|uniform|lognormal] [-z exponent] [-s seed] [-p files per folder] <directory>\n", name);
+}
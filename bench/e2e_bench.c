@@ -0,0 +1,274 @@
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#define DEFAULT_RUNS 3
+#define MAX_RUNS 64
+#define MAX_ARGS 64
+/* Le parole più frequenti del corpus, usate con --ignore */
+#define IGNORED_WORDS 100
+
+typedef struct Configuration {
+    const char *name;
+    /* Le opzioni di swordx, terminate da NULL; l'output viene aggiunto dal benchmark */
+    const char *options[4];
+    const char *output;
+} Configuration;
+
+typedef struct Run {
+    double wall_seconds;
+    double user_seconds;
+    double system_seconds;
+    long max_rss_kb;
+} Run;
+
+static int run_swordx(const char *swordx, const Configuration *configuration, const char *directory,
+    char *extra[], int extra_count, Run *run);
+static int write_ignored_words(const char *sorted_path, const char *ignore_path);
+static int copy_file(const char *source_path, const char *destination_path);
+static long count_lines(const char *path);
+static int compare_doubles(const void *a, const void *b);
+static double median(double *values, int count);
+static double now();
+
+/*
+ * Misura l'esecuzione completa di swordx su un corpus, ad esempio
+ * quello generato da corpus_gen, con le opzioni più usate: -r,
+ * -s, -u (sull'output della prima configurazione) e -i (con le
+ * parole più frequenti, prese dall'output della seconda).
+ * Gli argomenti dopo il corpus vengono passati a ogni esecuzione.
+ * I tempi e la memoria dei processi figli sono stampati in JSON.
+ */
+int main(int argc, char *argv[]){
+    int runs = DEFAULT_RUNS;
+    const char *label = "";
+    int opt;
+    while( (opt = getopt(argc, argv, "+n:l:")) != -1){
+        switch(opt){
+            case 'n': runs = atoi(optarg);
+                break;
+            case 'l': label = optarg;
+                break;
+            default: runs = 0;
+        }
+    }
+    if(argc - optind < 2 || runs < 1 || runs > MAX_RUNS || argc - optind - 2 > MAX_ARGS - 10){
+        fprintf(stderr, "Usage: %s [-n runs] [-l label] <swordx> <corpus directory> [swordx options]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *swordx = argv[optind];
+    const char *corpus = argv[optind + 1];
+    char **extra = argv + optind + 2;
+    int extra_count = argc - optind - 2;
+
+    char work[] = "/tmp/e2e_bench.XXXXXX";
+    if(!mkdtemp(work)){
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    char output[sizeof(work) + 16], sorted[sizeof(work) + 16], updated[sizeof(work) + 16];
+    char ignored[sizeof(work) + 16], ignore_list[sizeof(work) + 16];
+    sprintf(output, "%s/output", work);
+    sprintf(sorted, "%s/sorted", work);
+    sprintf(updated, "%s/updated", work);
+    sprintf(ignored, "%s/ignored", work);
+    sprintf(ignore_list, "%s/ignore", work);
+    /* -u aggiorna il file di output, che quindi viene copiato prima di ogni esecuzione */
+    Configuration configurations[] = {
+        {"recursive", {"-r", NULL}, output},
+        {"sortbyoccurrency", {"-r", "-s", NULL}, sorted},
+        {"update", {"-r", "-u", NULL}, updated},
+        {"ignore", {"-r", "-i", ignore_list, NULL}, ignored}
+    };
+    size_t configurations_count = sizeof(configurations) / sizeof(configurations[0]);
+
+    printf("{\n");
+    printf("  \"benchmark\": \"e2e\",\n");
+    printf("  \"label\": \"%s\",\n", label);
+    printf("  \"timestamp\": %ld,\n", (long) time(NULL));
+    printf("  \"swordx\": \"%s\",\n", swordx);
+    printf("  \"corpus\": \"%s\",\n", corpus);
+    printf("  \"extra_options\": \"");
+    for(int i = 0; i < extra_count; i++){
+        printf("%s%s", (i > 0) ? " " : "", extra[i]);
+    }
+    printf("\",\n");
+    printf("  \"runs\": %d,\n", runs);
+    printf("  \"results\": [\n");
+    int status = EXIT_SUCCESS;
+    for(size_t c = 0; c < configurations_count && status == EXIT_SUCCESS; c++){
+        const Configuration *configuration = &configurations[c];
+        if(configuration->output == ignored){
+            if(write_ignored_words(sorted, ignore_list) < 0){
+                perror("ignore list");
+                status = EXIT_FAILURE;
+                break;
+            }
+        }
+        double wall_seconds[MAX_RUNS], user_seconds[MAX_RUNS], system_seconds[MAX_RUNS];
+        long max_rss_kb = 0;
+        for(int r = 0; r < runs; r++){
+            if(configuration->output == updated && copy_file(output, updated) < 0){
+                perror(updated);
+                status = EXIT_FAILURE;
+                break;
+            }
+            Run run;
+            if(run_swordx(swordx, configuration, corpus, extra, extra_count, &run) < 0){
+                fprintf(stderr, "%s: swordx failed\n", configuration->name);
+                status = EXIT_FAILURE;
+                break;
+            }
+            wall_seconds[r] = run.wall_seconds;
+            user_seconds[r] = run.user_seconds;
+            system_seconds[r] = run.system_seconds;
+            if(run.max_rss_kb > max_rss_kb){
+                max_rss_kb = run.max_rss_kb;
+            }
+        }
+        if(status != EXIT_SUCCESS){
+            break;
+        }
+        printf("    {\"name\": \"%s\", \"options\": \"", configuration->name);
+        for(int i = 0; configuration->options[i]; i++){
+            printf("%s%s", (i > 0) ? " " : "", (configuration->options[i] == ignore_list) ? "<ignore>" : configuration->options[i]);
+        }
+        printf("\", \"median_wall_seconds\": %.4f, \"median_user_seconds\": %.4f, \"median_system_seconds\": %.4f, "
+            "\"max_rss_kb\": %ld, \"output_words\": %ld}%s\n",
+            median(wall_seconds, runs), median(user_seconds, runs), median(system_seconds, runs),
+            max_rss_kb, count_lines(configuration->output), (c == configurations_count - 1) ? "" : ",");
+    }
+    printf("  ]\n");
+    printf("}\n");
+
+    const char *files[] = {output, sorted, updated, ignored, ignore_list};
+    for(size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++){
+        unlink(files[i]);
+    }
+    rmdir(work);
+    return status;
+}
+
+static int run_swordx(const char *swordx, const Configuration *configuration, const char *directory,
+    char *extra[], int extra_count, Run *run){
+    const char *args[MAX_ARGS];
+    int count = 0;
+    args[count++] = swordx;
+    for(int i = 0; configuration->options[i]; i++){
+        args[count++] = configuration->options[i];
+    }
+    for(int i = 0; i < extra_count; i++){
+        args[count++] = extra[i];
+    }
+    args[count++] = "-o";
+    args[count++] = configuration->output;
+    args[count++] = directory;
+    args[count] = NULL;
+
+    double begin = now();
+    pid_t pid = fork();
+    if(pid < 0){
+        return -1;
+    }
+    if(pid == 0){
+        int null = open("/dev/null", O_WRONLY);
+        if(null >= 0){
+            dup2(null, STDOUT_FILENO);
+        }
+        execv(swordx, (char **) args);
+        perror(swordx);
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    while(wait4(pid, &status, 0, &usage) < 0){
+        if(errno != EINTR){
+            return -1;
+        }
+    }
+    run->wall_seconds = now() - begin;
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+        return -1;
+    }
+    run->user_seconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    run->system_seconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    run->max_rss_kb = usage.ru_maxrss;
+    return 0;
+}
+
+/* Le righe dell'output ordinato sono "parola occorrenze", dalla più frequente */
+static int write_ignored_words(const char *sorted_path, const char *ignore_path){
+    FILE *sorted = fopen(sorted_path, "r");
+    if(!sorted){
+        return -1;
+    }
+    FILE *ignore = fopen(ignore_path, "w");
+    if(!ignore){
+        fclose(sorted);
+        return -1;
+    }
+    char line[256];
+    for(int i = 0; i < IGNORED_WORDS && fgets(line, sizeof(line), sorted); i++){
+        line[strcspn(line, " ")] = '\0';
+        fprintf(ignore, "%s\n", line);
+    }
+    fclose(sorted);
+    return (fclose(ignore) == 0) ? 0 : -1;
+}
+
+static int copy_file(const char *source_path, const char *destination_path){
+    FILE *source = fopen(source_path, "r");
+    if(!source){
+        return -1;
+    }
+    FILE *destination = fopen(destination_path, "w");
+    if(!destination){
+        fclose(source);
+        return -1;
+    }
+    char buffer[BUFSIZ];
+    size_t read;
+    while( (read = fread(buffer, 1, sizeof(buffer), source)) > 0){
+        fwrite(buffer, 1, read, destination);
+    }
+    fclose(source);
+    return (fclose(destination) == 0) ? 0 : -1;
+}
+
+static long count_lines(const char *path){
+    FILE *file = fopen(path, "r");
+    if(!file){
+        return -1;
+    }
+    long lines = 0;
+    int c;
+    while( (c = getc(file)) != EOF){
+        lines += (c == '\n');
+    }
+    fclose(file);
+    return lines;
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *values, int count){
+    qsort(values, count, sizeof(double), compare_doubles);
+    return values[count / 2];
+}
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
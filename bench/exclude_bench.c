@@ -0,0 +1,127 @@
+#define _XOPEN_SOURCE 700
+
+#include "../src/lib/exclude/exclude.h"
+#include "../src/lib/list/list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DEFAULT_EXCLUDES 10000
+#define LOOKUPS 100000
+#define PATH_LENGTH 64
+
+static double now();
+static void print_result(const char *name, long operations, double seconds, long check, bool last);
+
+/*
+ * Confronta la ricerca di un percorso tra le esclusioni nella
+ * lista, come avveniva per ogni file visitato, e nell'insieme.
+ * I file esclusi vengono creati in una cartella temporanea,
+ * perché l'insieme li registra anche per (dispositivo, inode).
+ */
+int main(int argc, char *argv[]){
+    long count = (argc > 1) ? atol(argv[1]) : DEFAULT_EXCLUDES;
+    if(count <= 0){
+        fprintf(stderr, "Usage: %s [excludes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char directory[] = "/tmp/exclude_bench.XXXXXX";
+    if(!mkdtemp(directory)){
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    char (*paths)[PATH_LENGTH] = malloc(2 * count * sizeof(*paths));
+    List *list = list_new();
+    ExcludeSet *set = exclude_set_new();
+    if(!paths || !list || !set){
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    /* Le prime count posizioni sono escluse, le altre no */
+    for(long i = 0; i < 2 * count; i++){
+        snprintf(paths[i], PATH_LENGTH, "%s/file%ld", directory, i);
+    }
+    for(long i = 0; i < count; i++){
+        int fd = open(paths[i], O_WRONLY | O_CREAT, 0644);
+        if(fd < 0){
+            perror("open");
+            return EXIT_FAILURE;
+        }
+        close(fd);
+    }
+
+    double begin = now();
+    for(long i = 0; i < count; i++){
+        list_append(paths[i], list);
+    }
+    double list_build = now() - begin;
+    begin = now();
+    for(long i = 0; i < count; i++){
+        if(exclude_set_add(paths[i], set) < 0){
+            perror("exclude_set_add");
+            return EXIT_FAILURE;
+        }
+    }
+    double set_build = now() - begin;
+
+    srand(42);
+    long *lookups = malloc(LOOKUPS * sizeof(long));
+    if(!lookups){
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    for(long i = 0; i < LOOKUPS; i++){
+        lookups[i] = rand() % (2 * count);
+    }
+    long list_hits = 0;
+    begin = now();
+    for(long i = 0; i < LOOKUPS; i++){
+        list_hits += list_contains(paths[lookups[i]], list);
+    }
+    double list_lookup = now() - begin;
+    long set_hits = 0;
+    begin = now();
+    for(long i = 0; i < LOOKUPS; i++){
+        /* Come nel walker, il percorso arriva senza l'inode di un file escluso */
+        set_hits += exclude_set_contains(paths[lookups[i]], 0, 0, set);
+    }
+    double set_lookup = now() - begin;
+
+    printf("{\n");
+    printf("  \"benchmark\": \"exclude\",\n");
+    printf("  \"excludes\": %ld,\n", count);
+    printf("  \"lookups\": %d,\n", LOOKUPS);
+    printf("  \"results\": [\n");
+    print_result("list_append", count, list_build, count, false);
+    print_result("exclude_set_add", count, set_build, count, false);
+    print_result("list_contains", LOOKUPS, list_lookup, list_hits, false);
+    print_result("exclude_set_contains", LOOKUPS, set_lookup, set_hits, true);
+    printf("  ]\n");
+    printf("}\n");
+
+    for(long i = 0; i < count; i++){
+        unlink(paths[i]);
+    }
+    rmdir(directory);
+    exclude_set_destroy(set);
+    list_destroy(list);
+    free(lookups);
+    free(paths);
+    return (list_hits == set_hits) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void print_result(const char *name, long operations, double seconds, long check, bool last){
+    printf("    {\"name\": \"%s\", \"operations\": %ld, \"seconds\": %.6f, \"ns_per_operation\": %.2f, \"check\": %ld}%s\n",
+        name, operations, seconds, seconds * 1e9 / operations, check, (last) ? "" : ",");
+}
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
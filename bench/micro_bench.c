@@ -0,0 +1,293 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "zipf.h"
+#include "../src/lib/tokenizer/tokenizer.h"
+#include "../src/lib/trie/trie.h"
+#include "../src/lib/hashtable/hashtable.h"
+#include "../src/lib/list/list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_TOKENS 1000000
+#define DEFAULT_VOCABULARY 50000
+#define DEFAULT_EXPONENT 1.0
+#define DEFAULT_SEED 42
+#define DEFAULT_REPEATS 5
+/* Le parole ignorate sono le più frequenti, come in una lista di stopword */
+#define DEFAULT_IGNORED 100
+#define MAX_REPEATS 64
+
+typedef struct MemoryReader {
+    const char *text;
+    size_t length;
+    size_t position;
+} MemoryReader;
+
+typedef struct Corpus {
+    /* Il testo, con le parole separate da spazi */
+    char *text;
+    size_t length;
+    /* Le parole del testo, terminate da '\0' */
+    char **words;
+    size_t count;
+    List *ignored;
+} Corpus;
+
+typedef struct Result {
+    const char *name;
+    size_t operations;
+    double seconds[MAX_REPEATS];
+    /* Un valore calcolato dal benchmark, per verificarne il risultato */
+    long check;
+} Result;
+
+static int build_corpus(size_t tokens, size_t vocabulary, double exponent, uint64_t seed, size_t ignored, Corpus *corpus);
+static ssize_t memory_read(void *context, char *buffer, size_t size);
+static int count_visited(const char *word, int occurrences, void *context);
+static int compare_doubles(const void *a, const void *b);
+static void print_result(Result *result, int repeats, bool last);
+static double now();
+
+/*
+ * Misura le operazioni su cui si basa il conteggio delle parole,
+ * su un testo generato in memoria con distribuzione di Zipf:
+ * la lettura delle parole (tokenizer_next, che ha sostituito
+ * get_word), l'inserimento nel trie, l'estrazione delle parole
+ * dal trie, l'inserimento e la visita ordinata della tabella hash
+ * di --engine hash e la ricerca tra le parole ignorate.
+ * Ogni misura viene ripetuta e i risultati sono stampati in JSON.
+ */
+int main(int argc, char *argv[]){
+    size_t tokens = DEFAULT_TOKENS;
+    size_t vocabulary = DEFAULT_VOCABULARY;
+    double exponent = DEFAULT_EXPONENT;
+    unsigned long long seed = DEFAULT_SEED;
+    int repeats = DEFAULT_REPEATS;
+    size_t ignored = DEFAULT_IGNORED;
+    int opt;
+    while( (opt = getopt(argc, argv, "t:v:z:s:r:i:")) != -1){
+        switch(opt){
+            case 't': tokens = strtoul(optarg, NULL, 10);
+                break;
+            case 'v': vocabulary = strtoul(optarg, NULL, 10);
+                break;
+            case 'z': exponent = strtod(optarg, NULL);
+                break;
+            case 's': seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'r': repeats = atoi(optarg);
+                break;
+            case 'i': ignored = strtoul(optarg, NULL, 10);
+                break;
+            default: repeats = 0;
+        }
+    }
+    if(optind != argc || tokens == 0 || vocabulary == 0 || exponent < 0 || repeats < 1 || repeats > MAX_REPEATS){
+        fprintf(stderr, "Usage: %s [-t tokens] [-v vocabulary] [-z exponent] [-s seed] [-r repeats] [-i ignored words]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    Corpus corpus;
+    if(build_corpus(tokens, vocabulary, exponent, seed, ignored, &corpus) < 0){
+        perror("build_corpus");
+        return EXIT_FAILURE;
+    }
+
+    Result tokenizer_result = {"tokenizer_next", tokens};
+    Result insert_result = {"trie_insert", tokens};
+    Result wordlist_result = {"trie_get_wordlist"};
+    Result visit_result = {"trie_visit"};
+    Result hash_insert_result = {"hashtable_insert", tokens};
+    Result hash_visit_result = {"hashtable_visit"};
+    Result ignored_result = {"list_contains", tokens};
+    for(int r = 0; r < repeats; r++){
+        MemoryReader reader = {corpus.text, corpus.length, 0};
+        Tokenizer *tokenizer = tokenizer_new_reader(memory_read, &reader);
+        Trie *trie = trie_new();
+        if(!tokenizer || !trie){
+            perror("malloc");
+            return EXIT_FAILURE;
+        }
+        Token token;
+        long read = 0;
+        double begin = now();
+        while(tokenizer_next(tokenizer, &token) > 0){
+            read++;
+        }
+        tokenizer_result.seconds[r] = now() - begin;
+        tokenizer_result.check = read;
+        tokenizer_destroy(tokenizer);
+
+        begin = now();
+        for(size_t i = 0; i < corpus.count; i++){
+            if(trie_insert(corpus.words[i], trie) < 0){
+                perror("trie_insert");
+                return EXIT_FAILURE;
+            }
+        }
+        insert_result.seconds[r] = now() - begin;
+
+        begin = now();
+        List *wordlist = trie_get_wordlist(trie);
+        wordlist_result.seconds[r] = now() - begin;
+        if(!wordlist){
+            perror("trie_get_wordlist");
+            return EXIT_FAILURE;
+        }
+        wordlist_result.operations = list_get_elements_count(wordlist);
+        wordlist_result.check = wordlist_result.operations;
+        list_destroy(wordlist);
+
+        long visited = 0;
+        begin = now();
+        trie_visit(trie, count_visited, &visited);
+        visit_result.seconds[r] = now() - begin;
+        visit_result.operations = visited;
+        visit_result.check = visited;
+        insert_result.check = visited;
+
+        HashTable *table = hashtable_new();
+        if(!table){
+            perror("hashtable_new");
+            return EXIT_FAILURE;
+        }
+        begin = now();
+        for(size_t i = 0; i < corpus.count; i++){
+            if(hashtable_insert_n(corpus.words[i], strlen(corpus.words[i]), 1, table) < 0){
+                perror("hashtable_insert_n");
+                return EXIT_FAILURE;
+            }
+        }
+        hash_insert_result.seconds[r] = now() - begin;
+        long hash_visited = 0;
+        begin = now();
+        if(hashtable_visit(table, count_visited, &hash_visited) != 0){
+            perror("hashtable_visit");
+            return EXIT_FAILURE;
+        }
+        hash_visit_result.seconds[r] = now() - begin;
+        hash_visit_result.operations = hash_visited;
+        hash_visit_result.check = hash_visited;
+        hash_insert_result.check = hash_visited;
+        hashtable_destroy(table);
+        trie_destroy(trie);
+
+        long hits = 0;
+        begin = now();
+        for(size_t i = 0; i < corpus.count; i++){
+            hits += list_contains(corpus.words[i], corpus.ignored);
+        }
+        ignored_result.seconds[r] = now() - begin;
+        ignored_result.check = hits;
+    }
+
+    printf("{\n");
+    printf("  \"benchmark\": \"micro\",\n");
+    printf("  \"tokens\": %zu,\n", tokens);
+    printf("  \"vocabulary\": %zu,\n", vocabulary);
+    printf("  \"exponent\": %g,\n", exponent);
+    printf("  \"seed\": %llu,\n", seed);
+    printf("  \"ignored_words\": %d,\n", list_get_elements_count(corpus.ignored));
+    printf("  \"bytes\": %zu,\n", corpus.length);
+    printf("  \"repeats\": %d,\n", repeats);
+    printf("  \"results\": [\n");
+    print_result(&tokenizer_result, repeats, false);
+    print_result(&insert_result, repeats, false);
+    print_result(&wordlist_result, repeats, false);
+    print_result(&visit_result, repeats, false);
+    print_result(&hash_insert_result, repeats, false);
+    print_result(&hash_visit_result, repeats, false);
+    print_result(&ignored_result, repeats, true);
+    printf("  ]\n");
+    printf("}\n");
+
+    list_destroy(corpus.ignored);
+    /* La prima parola è l'inizio della copia del testo */
+    free(corpus.words[0]);
+    free(corpus.words);
+    free(corpus.text);
+    return (tokenizer_result.check == (long) tokens) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Il testo viene generato una sola volta: una copia con le parole
+ * separate da spazi per il tokenizer e una con le parole terminate
+ * da '\0' per le altre misure.
+ */
+static int build_corpus(size_t tokens, size_t vocabulary, double exponent, uint64_t seed, size_t ignored, Corpus *corpus){
+    Zipf *zipf = zipf_new(vocabulary, exponent, seed);
+    corpus->text = malloc(tokens * (ZIPF_MAX_WORD_LENGTH + 1));
+    corpus->words = malloc(tokens * sizeof(char *));
+    corpus->ignored = list_new();
+    if(!zipf || !corpus->text || !corpus->words || !corpus->ignored){
+        return -1;
+    }
+    size_t length = 0;
+    for(size_t i = 0; i < tokens; i++){
+        length += zipf_word(zipf_next_rank(zipf), zipf, corpus->text + length);
+        corpus->text[length++] = ' ';
+    }
+    char *words = malloc(length);
+    if(!words){
+        return -1;
+    }
+    memcpy(words, corpus->text, length);
+    corpus->length = length;
+    corpus->count = 0;
+    for(size_t i = 0, begin = 0; i < length; i++){
+        if(words[i] == ' '){
+            words[i] = '\0';
+            corpus->words[corpus->count++] = words + begin;
+            begin = i + 1;
+        }
+    }
+    char word[ZIPF_MAX_WORD_LENGTH + 1];
+    for(size_t rank = 0; rank < ignored && rank < vocabulary; rank++){
+        zipf_word(rank, zipf, word);
+        if(list_append(word, corpus->ignored) < 0){
+            return -1;
+        }
+    }
+    zipf_destroy(zipf);
+    return 0;
+}
+
+static ssize_t memory_read(void *context, char *buffer, size_t size){
+    MemoryReader *reader = context;
+    size_t available = reader->length - reader->position;
+    if(size > available){
+        size = available;
+    }
+    memcpy(buffer, reader->text + reader->position, size);
+    reader->position += size;
+    return size;
+}
+
+static int count_visited(const char *word, int occurrences, void *context){
+    (*(long *) context)++;
+    return 0;
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* Il tempo per operazione è calcolato sulla mediana delle ripetizioni */
+static void print_result(Result *result, int repeats, bool last){
+    qsort(result->seconds, repeats, sizeof(double), compare_doubles);
+    double median = result->seconds[repeats / 2];
+    printf("    {\"name\": \"%s\", \"operations\": %zu, \"min_seconds\": %.6f, \"median_seconds\": %.6f, "
+        "\"max_seconds\": %.6f, \"ns_per_operation\": %.2f, \"check\": %ld}%s\n",
+        result->name, result->operations, result->seconds[0], median, result->seconds[repeats - 1],
+        (result->operations > 0) ? median * 1e9 / result->operations : 0, result->check, (last) ? "" : ",");
+}
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "zipf.h"
+#include "../src/lib/trie/trie.h"
+#include "../src/lib/wordmap/wordmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define DEFAULT_TOKENS 2000000
+#define DEFAULT_VOCABULARY 200000
+#define DEFAULT_EXPONENT 1.0
+#define DEFAULT_SEED 42
+#define DEFAULT_REPEATS 3
+#define MAX_REPEATS 64
+
+typedef enum Engine {
+    /* Un Trie per thread, uniti alla fine come in collect_words_parallel() */
+    PER_THREAD_TRIES,
+    /* Una WordMap condivisa, come con --shared-map */
+    SHARED_MAP,
+    ENGINES
+} Engine;
+
+static const char *EngineNames[ENGINES] = {"per_thread_tries", "shared_map"};
+
+typedef struct Corpus {
+    char **words;
+    size_t count;
+    /* Le parole, terminate da '\0', una di seguito all'altra */
+    char *text;
+} Corpus;
+
+typedef struct Task {
+    pthread_t thread;
+    const Corpus *corpus;
+    size_t begin;
+    size_t end;
+    Trie *trie;
+    WordMap *map;
+    int result;
+} Task;
+
+typedef struct Point {
+    double seconds[MAX_REPEATS];
+    size_t memory_bytes;
+    size_t distinct_words;
+} Point;
+
+static int build_corpus(size_t tokens, size_t vocabulary, double exponent, uint64_t seed, Corpus *corpus);
+static int run(Engine engine, unsigned int threads, const Corpus *corpus, Point *point, int repeat);
+static void *insert_words(void *args);
+static int count_word(const char *word, int occurrences, void *context);
+static int compare_doubles(const void *a, const void *b);
+static double now();
+
+/*
+ * Misura come scala il conteggio delle parole con il numero dei
+ * thread, da 1 a -n, contando lo stesso testo di Zipf con un Trie
+ * per thread uniti alla fine oppure con una WordMap condivisa.
+ * Per ogni punto vengono stampati il tempo, la memoria occupata
+ * dai conteggi prima dell'unione e il numero di parole distinte,
+ * che deve essere lo stesso per tutti i punti.
+ */
+int main(int argc, char *argv[]){
+    size_t tokens = DEFAULT_TOKENS;
+    size_t vocabulary = DEFAULT_VOCABULARY;
+    double exponent = DEFAULT_EXPONENT;
+    unsigned long long seed = DEFAULT_SEED;
+    int repeats = DEFAULT_REPEATS;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_threads = (processors > 0) ? processors : 1;
+    int opt;
+    while( (opt = getopt(argc, argv, "t:v:z:s:r:n:")) != -1){
+        switch(opt){
+            case 't': tokens = strtoul(optarg, NULL, 10);
+                break;
+            case 'v': vocabulary = strtoul(optarg, NULL, 10);
+                break;
+            case 'z': exponent = strtod(optarg, NULL);
+                break;
+            case 's': seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'r': repeats = atoi(optarg);
+                break;
+            case 'n': max_threads = strtoul(optarg, NULL, 10);
+                break;
+            default: repeats = 0;
+        }
+    }
+    if(optind != argc || tokens == 0 || vocabulary == 0 || exponent < 0 || repeats < 1 || repeats > MAX_REPEATS || max_threads < 1){
+        fprintf(stderr, "Usage: %s [-t tokens] [-v vocabulary] [-z exponent] [-s seed] [-r repeats] [-n max threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    Corpus corpus;
+    if(build_corpus(tokens, vocabulary, exponent, seed, &corpus) < 0){
+        perror("build_corpus");
+        return EXIT_FAILURE;
+    }
+
+    printf("{\n");
+    printf("  \"benchmark\": \"scaling\",\n");
+    printf("  \"tokens\": %zu,\n", tokens);
+    printf("  \"vocabulary\": %zu,\n", vocabulary);
+    printf("  \"exponent\": %g,\n", exponent);
+    printf("  \"seed\": %llu,\n", seed);
+    printf("  \"repeats\": %d,\n", repeats);
+    printf("  \"results\": [\n");
+    size_t distinct_words = 0;
+    bool consistent = true;
+    double baseline[ENGINES] = {0};
+    /* I thread raddoppiano a ogni punto; l'ultimo punto è sempre -n */
+    for(unsigned int threads = 1; threads <= max_threads; threads = (threads < max_threads && threads * 2 > max_threads) ? max_threads : threads * 2){
+        for(Engine engine = 0; engine < ENGINES; engine++){
+            Point point = {{0}, 0, 0};
+            for(int r = 0; r < repeats; r++){
+                if(run(engine, threads, &corpus, &point, r) < 0){
+                    perror(EngineNames[engine]);
+                    return EXIT_FAILURE;
+                }
+            }
+            if(distinct_words == 0){
+                distinct_words = point.distinct_words;
+            }
+            consistent = consistent && point.distinct_words == distinct_words;
+            qsort(point.seconds, repeats, sizeof(double), compare_doubles);
+            double median = point.seconds[repeats / 2];
+            if(threads == 1){
+                baseline[engine] = median;
+            }
+            bool last = threads == max_threads && engine == ENGINES - 1;
+            printf("    {\"engine\": \"%s\", \"threads\": %u, \"min_seconds\": %.6f, \"median_seconds\": %.6f, "
+                "\"max_seconds\": %.6f, \"mtokens_per_second\": %.2f, \"speedup\": %.2f, \"memory_bytes\": %zu, \"check\": %zu}%s\n",
+                EngineNames[engine], threads, point.seconds[0], median, point.seconds[repeats - 1],
+                tokens / median / 1e6, baseline[engine] / median, point.memory_bytes, point.distinct_words, (last) ? "" : ",");
+        }
+    }
+    printf("  ]\n");
+    printf("}\n");
+
+    free(corpus.text);
+    free(corpus.words);
+    return (consistent) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int build_corpus(size_t tokens, size_t vocabulary, double exponent, uint64_t seed, Corpus *corpus){
+    Zipf *zipf = zipf_new(vocabulary, exponent, seed);
+    corpus->text = malloc(tokens * (ZIPF_MAX_WORD_LENGTH + 1));
+    corpus->words = malloc(tokens * sizeof(char *));
+    if(!zipf || !corpus->text || !corpus->words){
+        return -1;
+    }
+    size_t length = 0;
+    for(size_t i = 0; i < tokens; i++){
+        corpus->words[i] = corpus->text + length;
+        length += zipf_word(zipf_next_rank(zipf), zipf, corpus->text + length);
+        corpus->text[length++] = '\0';
+    }
+    corpus->count = tokens;
+    zipf_destroy(zipf);
+    return 0;
+}
+
+/* La memoria è misurata quando tutti i thread hanno terminato, prima dell'unione dei Trie */
+static int run(Engine engine, unsigned int threads, const Corpus *corpus, Point *point, int repeat){
+    Task *tasks = calloc(threads, sizeof(Task));
+    WordMap *map = (engine == SHARED_MAP) ? wordmap_new() : NULL;
+    if(!tasks || (engine == SHARED_MAP && !map)){
+        free(tasks);
+        return -1;
+    }
+    int res = 0;
+    for(unsigned int i = 0; i < threads; i++){
+        tasks[i].corpus = corpus;
+        tasks[i].begin = corpus->count * i / threads;
+        tasks[i].end = corpus->count * (i + 1) / threads;
+        tasks[i].map = map;
+        tasks[i].trie = (engine == PER_THREAD_TRIES) ? trie_new() : NULL;
+        if(engine == PER_THREAD_TRIES && !tasks[i].trie){
+            res = -1;
+        }
+    }
+    double begin = now();
+    unsigned int started = 0;
+    for(; res == 0 && started < threads; started++){
+        if(pthread_create(&tasks[started].thread, NULL, insert_words, &tasks[started]) != 0){
+            res = -1;
+            break;
+        }
+    }
+    for(unsigned int i = 0; i < started; i++){
+        pthread_join(tasks[i].thread, NULL);
+        res = (tasks[i].result < 0) ? -1 : res;
+    }
+    size_t memory = 0;
+    if(engine == SHARED_MAP){
+        memory = wordmap_get_memory_usage(map);
+    } else {
+        for(unsigned int i = 0; i < threads; i++){
+            memory += (tasks[i].trie) ? trie_get_memory_usage(tasks[i].trie) : 0;
+        }
+        for(unsigned int i = 1; res == 0 && i < threads; i++){
+            res = trie_merge(tasks[i].trie, tasks[0].trie);
+        }
+    }
+    point->seconds[repeat] = now() - begin;
+    point->memory_bytes = memory;
+    size_t distinct_words = 0;
+    if(res == 0){
+        res = (engine == SHARED_MAP) ? wordmap_visit(map, count_word, &distinct_words) : trie_visit(tasks[0].trie, count_word, &distinct_words);
+    }
+    point->distinct_words = distinct_words;
+    for(unsigned int i = 0; i < threads; i++){
+        trie_destroy(tasks[i].trie);
+    }
+    wordmap_destroy(map);
+    free(tasks);
+    return res;
+}
+
+static void *insert_words(void *args){
+    Task *task = args;
+    char **words = task->corpus->words;
+    int res = 0;
+    for(size_t i = task->begin; i < task->end && res >= 0; i++){
+        size_t length = strlen(words[i]);
+        res = (task->map) ? wordmap_insert_n(words[i], length, 1, task->map) : trie_insert_n(words[i], length, 1, task->trie);
+    }
+    task->result = (res < 0) ? -1 : 0;
+    return NULL;
+}
+
+static int count_word(const char *word, int occurrences, void *context){
+    (*(size_t *) context)++;
+    return 0;
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,85 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/lib/trie/trie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define DEFAULT_WORDS 1000000
+#define MAX_WORD_LENGTH 12
+
+static double now();
+static long peak_rss_kb();
+static void print_result(const char *name, long operations, double seconds, bool last);
+
+int main(int argc, char *argv[]){
+    long count = (argc > 1) ? atol(argv[1]) : DEFAULT_WORDS;
+    bool huge_pages = (argc > 2) && strcmp(argv[2], "--hugepages") == 0;
+    if(count <= 0){
+        fprintf(stderr, "Usage: %s [words] [--hugepages]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *alphabet = "abcdefghijklmnopqrstuvwxyz0123456789";
+    char (*words)[MAX_WORD_LENGTH + 1] = malloc(count * sizeof(*words));
+    if(!words){
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    srand(42);
+    for(long i = 0; i < count; i++){
+        int length = 3 + rand() % (MAX_WORD_LENGTH - 2);
+        for(int j = 0; j < length; j++){
+            words[i][j] = alphabet[rand() % 36];
+        }
+        words[i][length] = '\0';
+    }
+    long rss_before = peak_rss_kb();
+
+    double begin = now();
+    Trie *trie = (huge_pages) ? trie_new_huge_pages() : trie_new();
+    for(long i = 0; i < count; i++){
+        if(trie_insert(words[i], trie) < 0){
+            perror("trie_insert");
+            return EXIT_FAILURE;
+        }
+    }
+    double build = now() - begin;
+    long rss_after = peak_rss_kb();
+
+    begin = now();
+    trie_destroy(trie);
+    double teardown = now() - begin;
+
+    printf("{\n");
+    printf("  \"benchmark\": \"trie\",\n");
+    printf("  \"words\": %ld,\n", count);
+    printf("  \"huge_pages\": %s,\n", (huge_pages) ? "true" : "false");
+    printf("  \"trie_rss_kb\": %ld,\n", rss_after - rss_before);
+    printf("  \"results\": [\n");
+    print_result("trie_insert", count, build, false);
+    print_result("trie_destroy", count, teardown, true);
+    printf("  ]\n");
+    printf("}\n");
+    free(words);
+    return EXIT_SUCCESS;
+}
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_result(const char *name, long operations, double seconds, bool last){
+    printf("    {\"name\": \"%s\", \"operations\": %ld, \"seconds\": %.6f, \"ns_per_operation\": %.2f}%s\n",
+        name, operations, seconds, seconds * 1e9 / operations, (last) ? "" : ",");
+}
+
+static long peak_rss_kb(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
@@ -0,0 +1,109 @@
+#include "zipf.h"
+
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+/* Le parole hanno da 0 a MAX_PADDING lettere prima del codice del rango */
+#define MAX_PADDING 7
+
+static uint64_t _splitmix64(uint64_t *state);
+
+typedef struct Zipf {
+    /* cdf[r] è la probabilità di estrarre un rango minore o uguale a r */
+    double *cdf;
+    size_t vocabulary;
+    /* Le lettere necessarie a scrivere in base 26 il rango più alto */
+    size_t code_length;
+    uint64_t state;
+} Zipf;
+
+Zipf *zipf_new(size_t vocabulary, double exponent, uint64_t seed){
+    assert(vocabulary > 0);
+    Zipf *zipf = malloc(sizeof(Zipf));
+    if(!zipf){
+        return NULL;
+    }
+    zipf->cdf = malloc(vocabulary * sizeof(double));
+    if(!zipf->cdf){
+        free(zipf);
+        return NULL;
+    }
+    double sum = 0;
+    for(size_t rank = 0; rank < vocabulary; rank++){
+        sum += 1.0 / pow(rank + 1, exponent);
+        zipf->cdf[rank] = sum;
+    }
+    for(size_t rank = 0; rank < vocabulary; rank++){
+        zipf->cdf[rank] /= sum;
+    }
+    zipf->vocabulary = vocabulary;
+    zipf->code_length = 1;
+    for(size_t max = 26; max < vocabulary; max *= 26){
+        zipf->code_length++;
+    }
+    assert(zipf->code_length + MAX_PADDING <= ZIPF_MAX_WORD_LENGTH);
+    zipf->state = seed;
+    return zipf;
+}
+
+void zipf_destroy(Zipf *zipf){
+    if(zipf){
+        free(zipf->cdf);
+        free(zipf);
+    }
+}
+
+size_t zipf_next_rank(Zipf *zipf){
+    assert(zipf);
+    double target = zipf_uniform(zipf);
+    size_t low = 0, high = zipf->vocabulary - 1;
+    while(low < high){
+        size_t middle = low + (high - low) / 2;
+        if(zipf->cdf[middle] <= target){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+double zipf_uniform(Zipf *zipf){
+    assert(zipf);
+    return (_splitmix64(&zipf->state) >> 11) * 0x1.0p-53;
+}
+
+size_t zipf_word(size_t rank, const Zipf *zipf, char *word){
+    assert(zipf);
+    assert(word);
+    /*
+     * Le lettere iniziali derivano dal rango, quindi le parole hanno
+     * lunghezze e prefissi vari; il codice finale a larghezza fissa
+     * rende distinte parole di rango diverso.
+     */
+    uint64_t state = rank;
+    uint64_t hash = _splitmix64(&state);
+    size_t padding = hash % (MAX_PADDING + 1);
+    size_t length = 0;
+    for(size_t i = 0; i < padding; i++){
+        hash = _splitmix64(&state);
+        word[length++] = 'a' + hash % 26;
+    }
+    for(size_t i = 0; i < zipf->code_length; i++){
+        word[length + zipf->code_length - 1 - i] = 'a' + rank % 26;
+        rank /= 26;
+    }
+    length += zipf->code_length;
+    word[length] = '\0';
+    return length;
+}
+
+/* Private Methods */
+
+static uint64_t _splitmix64(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
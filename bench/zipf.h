@@ -0,0 +1,65 @@
+#ifndef ZIPF_H
+#define ZIPF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Generatore riproducibile di parole con frequenze distribuite
+ * secondo la legge di Zipf: la parola di rango r compare con
+ * probabilità proporzionale a 1 / (r + 1)^exponent. Usa un proprio
+ * generatore pseudocasuale, così lo stesso seme produce lo stesso
+ * corpus su qualsiasi libc.
+ */
+typedef struct Zipf Zipf;
+
+/* La lunghezza massima di una parola generata, senza '\0' */
+#define ZIPF_MAX_WORD_LENGTH 24
+
+/**
+ * @brief Crea un generatore
+ *
+ * @param vocabulary Il numero di parole distinte
+ * @param exponent L'esponente della distribuzione, 1 per il linguaggio naturale
+ * @param seed Il seme del generatore pseudocasuale
+ * @return Zipf* Il puntatore al generatore creato
+ * @return NULL Failure
+ */
+Zipf *zipf_new(size_t vocabulary, double exponent, uint64_t seed);
+
+/**
+ * @brief Libera la memoria riservata al generatore
+ *
+ * @param zipf Il generatore da distruggere
+ */
+void zipf_destroy(Zipf *zipf);
+
+/**
+ * @brief Estrae il rango di una parola secondo la distribuzione
+ *
+ * @param zipf Il generatore
+ * @return size_t Il rango estratto, tra 0 e vocabulary - 1
+ */
+size_t zipf_next_rank(Zipf *zipf);
+
+/**
+ * @brief Estrae un numero con distribuzione uniforme
+ *
+ * @param zipf Il generatore
+ * @return double Il numero estratto, in [0, 1)
+ */
+double zipf_uniform(Zipf *zipf);
+
+/**
+ * @brief Scrive la parola di rango specificato. Le parole sono
+ * composte solo da lettere minuscole, sono distinte per ranghi
+ * distinti e non dipendono dal seme.
+ *
+ * @param rank Il rango della parola
+ * @param zipf Il generatore
+ * @param word Il buffer, di almeno ZIPF_MAX_WORD_LENGTH + 1 byte
+ * @return size_t La lunghezza della parola
+ */
+size_t zipf_word(size_t rank, const Zipf *zipf, char *word);
+
+#endif
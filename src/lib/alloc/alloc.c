@@ -0,0 +1,181 @@
+#define _GNU_SOURCE
+
+#include "alloc.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+static atomic_bool counting;
+static atomic_uint_fast64_t allocations;
+static atomic_uint_fast64_t reallocations;
+static atomic_uint_fast64_t frees;
+static atomic_uint_fast64_t allocated_bytes;
+static atomic_int_fast64_t live_bytes;
+static atomic_int_fast64_t peak_live_bytes;
+
+#ifdef __GLIBC__
+
+#include <malloc.h>
+
+/* Le funzioni di glibc, esportate proprio per chi ne sostituisce l'allocatore */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+
+static void _count_allocation(size_t requested, void *pointer);
+static void _add_live_bytes(int64_t bytes);
+
+void *malloc(size_t size){
+    void *pointer = __libc_malloc(size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(size, pointer);
+    }
+    return pointer;
+}
+
+void *calloc(size_t count, size_t size){
+    /* Il prodotto non deve traboccare nei byte conteggiati */
+    if(count != 0 && size > SIZE_MAX / count){
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *pointer = __libc_calloc(count, size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(count * size, pointer);
+    }
+    return pointer;
+}
+
+void *realloc(void *pointer, size_t size){
+    if(!atomic_load_explicit(&counting, memory_order_relaxed)){
+        return __libc_realloc(pointer, size);
+    }
+    if(!pointer){
+        pointer = __libc_malloc(size);
+        if(pointer){
+            _count_allocation(size, pointer);
+        }
+        return pointer;
+    }
+    size_t old_size = malloc_usable_size(pointer);
+    if(size == 0){
+        /* glibc libera il blocco: è una free(), seguita dall'eventuale nuovo blocco */
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+        _add_live_bytes(-(int64_t) old_size);
+        void *resized = __libc_realloc(pointer, 0);
+        if(resized){
+            _count_allocation(0, resized);
+        }
+        return resized;
+    }
+    void *resized = __libc_realloc(pointer, size);
+    if(resized){
+        atomic_fetch_add_explicit(&reallocations, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+        _add_live_bytes((int64_t) malloc_usable_size(resized) - (int64_t) old_size);
+    }
+    return resized;
+}
+
+void *aligned_alloc(size_t alignment, size_t size){
+    void *pointer = __libc_memalign(alignment, size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(size, pointer);
+    }
+    return pointer;
+}
+
+void *memalign(size_t alignment, size_t size){
+    void *pointer = __libc_memalign(alignment, size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(size, pointer);
+    }
+    return pointer;
+}
+
+void *valloc(size_t size){
+    void *pointer = __libc_valloc(size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(size, pointer);
+    }
+    return pointer;
+}
+
+void *pvalloc(size_t size){
+    void *pointer = __libc_pvalloc(size);
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        _count_allocation(size, pointer);
+    }
+    return pointer;
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size){
+    if(alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0){
+        return EINVAL;
+    }
+    void *allocated = __libc_memalign(alignment, size);
+    if(!allocated){
+        return ENOMEM;
+    }
+    if(atomic_load_explicit(&counting, memory_order_relaxed)){
+        _count_allocation(size, allocated);
+    }
+    *pointer = allocated;
+    return 0;
+}
+
+void free(void *pointer){
+    if(atomic_load_explicit(&counting, memory_order_relaxed) && pointer){
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+        _add_live_bytes(-(int64_t) malloc_usable_size(pointer));
+    }
+    __libc_free(pointer);
+}
+
+bool alloc_enable_counting(){
+    atomic_store(&counting, true);
+    return true;
+}
+
+#else
+
+bool alloc_enable_counting(){
+    return false;
+}
+
+#endif
+
+void alloc_get_stats(AllocStats *stats){
+    stats->allocations = atomic_load(&allocations);
+    stats->reallocations = atomic_load(&reallocations);
+    stats->frees = atomic_load(&frees);
+    stats->allocated_bytes = atomic_load(&allocated_bytes);
+    stats->peak_live_bytes = atomic_load(&peak_live_bytes);
+}
+
+/* Private Methods */
+
+#ifdef __GLIBC__
+
+static void _count_allocation(size_t requested, void *pointer){
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, requested, memory_order_relaxed);
+    _add_live_bytes(malloc_usable_size(pointer));
+}
+
+/* I byte vivi sono quelli utilizzabili dei blocchi, gli unici noti anche a free() */
+static void _add_live_bytes(int64_t bytes){
+    int64_t live = atomic_fetch_add_explicit(&live_bytes, bytes, memory_order_relaxed) + bytes;
+    int64_t peak = atomic_load_explicit(&peak_live_bytes, memory_order_relaxed);
+    while(live > peak && !atomic_compare_exchange_weak_explicit(&peak_live_bytes, &peak, live,
+        memory_order_relaxed, memory_order_relaxed)){
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Allocatore che conta le chiamate a malloc(), calloc(), realloc(),
+ * aligned_alloc(), posix_memalign(), memalign(), valloc(), pvalloc()
+ * e free() di tutto il processo, librerie comprese. Le funzioni
+ * sostituiscono quelle della libc e le inoltrano a glibc; il
+ * conteggio è attivo solo dopo alloc_enable_counting(). Senza glibc
+ * le funzioni non vengono sostituite e i conteggi restano a zero.
+ */
+typedef struct AllocStats {
+    /* Le chiamate alle funzioni di allocazione e a realloc() con un puntatore nullo */
+    uint64_t allocations;
+    /* Le chiamate a realloc() su un blocco esistente */
+    uint64_t reallocations;
+    /* Le chiamate a free() e a realloc() con dimensione 0 su un puntatore non nullo */
+    uint64_t frees;
+    /* I byte richiesti in totale */
+    uint64_t allocated_bytes;
+    /* Il massimo dei byte allocati e non ancora liberati */
+    int64_t peak_live_bytes;
+} AllocStats;
+
+/**
+ * @brief Attiva il conteggio. I blocchi allocati prima non
+ * vengono conteggiati, ma lo è la loro liberazione, che farebbe
+ * sottostimare i byte vivi: va invocata prima di ogni allocazione.
+ *
+ * @return true Il conteggio è disponibile
+ * @return false L'allocatore non è stato sostituito
+ */
+bool alloc_enable_counting();
+
+/**
+ * @brief Restituisce i conteggi dall'attivazione
+ *
+ * @param stats Le statistiche in cui salvare il risultato
+ */
+void alloc_get_stats(AllocStats *stats);
+
+#endif
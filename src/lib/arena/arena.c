@@ -0,0 +1,163 @@
+#define _GNU_SOURCE
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+/*
+ * Il blocco k contiene FIRST_CHUNK_ELEMENTS << k elementi, quindi
+ * l'indice i appartiene al blocco floor(log2(i / FIRST_CHUNK_ELEMENTS + 1)).
+ * I blocchi non vengono mai spostati: i puntatori agli elementi
+ * restano validi e la distruzione costa O(blocchi).
+ */
+#define FIRST_CHUNK_SHIFT 6
+#define FIRST_CHUNK_ELEMENTS ((uint32_t) 1 << FIRST_CHUNK_SHIFT)
+#define MAX_CHUNKS (32 - FIRST_CHUNK_SHIFT)
+#define HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+static int _get_chunk(uint32_t index);
+static uint32_t _get_chunk_start(int chunk);
+static int _chunk_new(Arena *arena, int chunk);
+static void _chunk_destroy(Arena *arena, int chunk);
+
+typedef struct Arena {
+    size_t element_size;
+    bool huge_pages;
+    char *chunks[MAX_CHUNKS];
+    size_t sizes[MAX_CHUNKS];
+    bool mapped[MAX_CHUNKS];
+    int chunks_count;
+    uint32_t next;
+    uint32_t free_list;
+    size_t elements_count;
+    size_t memory_usage;
+} Arena;
+
+Arena *arena_new(size_t element_size, bool huge_pages){
+    assert(element_size > 0);
+    Arena *arena = calloc(1, sizeof(Arena));
+    if(!arena){
+        return NULL;
+    }
+    /* Gli elementi liberi contengono l'indice del successivo */
+    arena->element_size = (element_size < sizeof(uint32_t)) ? sizeof(uint32_t) : element_size;
+    arena->huge_pages = huge_pages;
+    /* L'indice 0 è riservato ad ARENA_NULL */
+    arena->next = 1;
+    arena->free_list = ARENA_NULL;
+    return arena;
+}
+
+void arena_destroy(Arena *arena){
+    if(arena){
+        for(int i = 0; i < arena->chunks_count; i++){
+            _chunk_destroy(arena, i);
+        }
+        free(arena);
+    }
+}
+
+uint32_t arena_alloc(Arena *arena){
+    assert(arena);
+    uint32_t index;
+    if(arena->free_list != ARENA_NULL){
+        index = arena->free_list;
+        void *element = arena_get(index, arena);
+        memcpy(&arena->free_list, element, sizeof(uint32_t));
+        memset(element, 0, arena->element_size);
+    } else {
+        index = arena->next;
+        int chunk = _get_chunk(index);
+        if(chunk >= MAX_CHUNKS){
+            errno = ENOMEM;
+            return ARENA_NULL;
+        }
+        if(chunk == arena->chunks_count && _chunk_new(arena, chunk) < 0){
+            return ARENA_NULL;
+        }
+        arena->next++;
+    }
+    arena->elements_count++;
+    return index;
+}
+
+void arena_free(uint32_t index, Arena *arena){
+    assert(arena);
+    if(index == ARENA_NULL){
+        return;
+    }
+    memcpy(arena_get(index, arena), &arena->free_list, sizeof(uint32_t));
+    arena->free_list = index;
+    arena->elements_count--;
+}
+
+void *arena_get(uint32_t index, const Arena *arena){
+    assert(arena);
+    assert(index != ARENA_NULL && index < arena->next);
+    int chunk = _get_chunk(index);
+    return arena->chunks[chunk] + (size_t) (index - _get_chunk_start(chunk)) * arena->element_size;
+}
+
+size_t arena_get_elements_count(const Arena *arena){
+    assert(arena);
+    return arena->elements_count;
+}
+
+size_t arena_get_memory_usage(const Arena *arena){
+    assert(arena);
+    return arena->memory_usage;
+}
+
+/* Private Methods */
+
+static int _get_chunk(uint32_t index){
+    return 31 - __builtin_clz((index >> FIRST_CHUNK_SHIFT) + 1);
+}
+
+static uint32_t _get_chunk_start(int chunk){
+    return (FIRST_CHUNK_ELEMENTS << chunk) - FIRST_CHUNK_ELEMENTS;
+}
+
+static int _chunk_new(Arena *arena, int chunk){
+    assert(chunk < MAX_CHUNKS);
+    size_t size = ((size_t) FIRST_CHUNK_ELEMENTS << chunk) * arena->element_size;
+    char *memory = NULL;
+    if(arena->huge_pages && size >= HUGE_PAGE_SIZE){
+        size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(memory == MAP_FAILED){
+            /* Nessuna huge page riservata: si ricorre alle transparent huge pages */
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(memory == MAP_FAILED){
+                return -1;
+            }
+            madvise(memory, size, MADV_HUGEPAGE);
+        }
+        arena->mapped[chunk] = true;
+    } else {
+        memory = calloc(1, size);
+        if(!memory){
+            return -1;
+        }
+        arena->mapped[chunk] = false;
+    }
+    arena->chunks[chunk] = memory;
+    arena->sizes[chunk] = size;
+    arena->memory_usage += size;
+    arena->chunks_count++;
+    return 0;
+}
+
+static void _chunk_destroy(Arena *arena, int chunk){
+    if(arena->mapped[chunk]){
+        munmap(arena->chunks[chunk], arena->sizes[chunk]);
+    } else {
+        free(arena->chunks[chunk]);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Indice che non corrisponde a nessun elemento dell'arena.
+ */
+#define ARENA_NULL 0
+
+typedef struct Arena Arena;
+
+/**
+ * @brief Crea un'arena di elementi di dimensione fissa.
+ * Gli elementi vengono allocati in blocchi di dimensione
+ * crescente e sono identificati da indici a 32 bit.
+ * 
+ * @param element_size La dimensione in byte di ogni elemento
+ * @param huge_pages Se true i blocchi più grandi vengono
+ * allocati, quando possibile, su huge pages
+ * @return Arena* Il puntatore all'arena creata
+ * @return NULL Failure
+ */
+Arena *arena_new(size_t element_size, bool huge_pages);
+
+/**
+ * @brief Libera in un'unica volta tutti gli elementi
+ * e la memoria riservata all'arena
+ * 
+ * @param arena L'arena da distruggere
+ */
+void arena_destroy(Arena *arena);
+
+/**
+ * @brief Alloca un nuovo elemento, inizializzato a zero
+ * 
+ * @param arena L'arena in cui allocare l'elemento
+ * @return uint32_t L'indice dell'elemento allocato
+ * @return ARENA_NULL Failure
+ */
+uint32_t arena_alloc(Arena *arena);
+
+/**
+ * @brief Restituisce l'elemento all'arena, che potrà
+ * riutilizzarlo per le allocazioni successive
+ * 
+ * @param index L'indice dell'elemento da liberare
+ * @param arena L'arena a cui appartiene l'elemento
+ */
+void arena_free(uint32_t index, Arena *arena);
+
+/**
+ * @brief Restituisce il puntatore all'elemento con l'indice
+ * specificato. Il puntatore resta valido fino alla distruzione
+ * dell'arena.
+ * 
+ * @param index L'indice dell'elemento
+ * @param arena L'arena a cui appartiene l'elemento
+ * @return void* Il puntatore all'elemento
+ */
+void *arena_get(uint32_t index, const Arena *arena);
+
+/**
+ * @brief Restituisce il numero di elementi allocati
+ * 
+ * @param arena 
+ * @return size_t 
+ */
+size_t arena_get_elements_count(const Arena *arena);
+
+/**
+ * @brief Restituisce la memoria in byte riservata dall'arena
+ * 
+ * @param arena 
+ * @return size_t 
+ */
+size_t arena_get_memory_usage(const Arena *arena);
+
+#endif
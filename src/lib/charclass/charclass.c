@@ -0,0 +1,165 @@
+#include "charclass.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHARCLASS_X86
+#include <immintrin.h>
+#endif
+
+#define CLASS_DELIMITER 1
+#define CLASS_NON_ALNUM 2
+#define CLASS_DIGIT 4
+#define CLASS_UPPER 8
+
+static void _scan_scalar(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits);
+#ifdef CHARCLASS_X86
+static void _scan_sse2(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits);
+static void _scan_avx2(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits);
+#endif
+static unsigned char _get_class(const unsigned char ch);
+
+void charclass_scan(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits){
+    charclass_scan_with_kernel(charclass_get_kernel(), buffer, length, delimiters, non_alnum, digits);
+}
+
+void charclass_scan_with_kernel(CharclassKernel kernel, char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits){
+    assert(buffer || length == 0);
+    assert(charclass_kernel_is_supported(kernel));
+    switch(kernel){
+#ifdef CHARCLASS_X86
+        case CHARCLASS_AVX2: _scan_avx2(buffer, length, delimiters, non_alnum, digits);
+            break;
+        case CHARCLASS_SSE2: _scan_sse2(buffer, length, delimiters, non_alnum, digits);
+            break;
+#endif
+        default: _scan_scalar(buffer, length, delimiters, non_alnum, digits);
+            break;
+    }
+}
+
+CharclassKernel charclass_get_kernel(){
+    if(charclass_kernel_is_supported(CHARCLASS_AVX2)){
+        return CHARCLASS_AVX2;
+    }
+    if(charclass_kernel_is_supported(CHARCLASS_SSE2)){
+        return CHARCLASS_SSE2;
+    }
+    return CHARCLASS_SCALAR;
+}
+
+bool charclass_kernel_is_supported(CharclassKernel kernel){
+    switch(kernel){
+        case CHARCLASS_SCALAR: return true;
+#ifdef CHARCLASS_X86
+        case CHARCLASS_SSE2: return __builtin_cpu_supports("sse2");
+        case CHARCLASS_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+/* Private Methods */
+
+static unsigned char _get_class(const unsigned char ch){
+    unsigned char delimiter = (ch == ' ') | ((unsigned char) (ch - '\t') <= '\r' - '\t');
+    unsigned char digit = (unsigned char) (ch - '0') <= 9;
+    unsigned char upper = (unsigned char) (ch - 'A') <= 'Z' - 'A';
+    unsigned char lower = (unsigned char) (ch - 'a') <= 'z' - 'a';
+    unsigned char non_alnum = !(delimiter | digit | upper | lower);
+    return delimiter * CLASS_DELIMITER | non_alnum * CLASS_NON_ALNUM | digit * CLASS_DIGIT | upper * CLASS_UPPER;
+}
+
+static void _scan_scalar(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits){
+    for(size_t word = 0; word * 64 < length; word++){
+        uint64_t d = 0, n = 0, g = 0;
+        size_t end = (length - word * 64 < 64) ? length - word * 64 : 64;
+        char *block = buffer + word * 64;
+        for(size_t i = 0; i < end; i++){
+            unsigned char class = _get_class(block[i]);
+            /* CLASS_UPPER << 2 == 'a' - 'A' */
+            block[i] |= (class & CLASS_UPPER) << 2;
+            d |= (uint64_t) (class & CLASS_DELIMITER) << i;
+            n |= (uint64_t) ((class & CLASS_NON_ALNUM) >> 1) << i;
+            g |= (uint64_t) ((class & CLASS_DIGIT) >> 2) << i;
+        }
+        delimiters[word] = d;
+        non_alnum[word] = n;
+        digits[word] = g;
+    }
+}
+
+#ifdef CHARCLASS_X86
+
+__attribute__((target("sse2")))
+static void _scan_sse2(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits){
+    const __m128i before_upper = _mm_set1_epi8('A' - 1), after_upper = _mm_set1_epi8('Z' + 1);
+    const __m128i before_lower = _mm_set1_epi8('a' - 1), after_lower = _mm_set1_epi8('z' + 1);
+    const __m128i before_digit = _mm_set1_epi8('0' - 1), after_digit = _mm_set1_epi8('9' + 1);
+    const __m128i before_control = _mm_set1_epi8('\t' - 1), after_control = _mm_set1_epi8('\r' + 1);
+    const __m128i space = _mm_set1_epi8(' '), case_bit = _mm_set1_epi8(0x20);
+    size_t word = 0;
+    for(; (word + 1) * 64 <= length; word++){
+        uint64_t d = 0, n = 0, g = 0;
+        for(int lane = 0; lane < 4; lane++){
+            __m128i *address = (__m128i *) (buffer + word * 64 + lane * 16);
+            __m128i c = _mm_loadu_si128(address);
+            __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, before_upper), _mm_cmplt_epi8(c, after_upper));
+            c = _mm_or_si128(c, _mm_and_si128(upper, case_bit));
+            _mm_storeu_si128(address, c);
+            __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, before_lower), _mm_cmplt_epi8(c, after_lower));
+            __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, before_digit), _mm_cmplt_epi8(c, after_digit));
+            __m128i delimiter = _mm_or_si128(_mm_cmpeq_epi8(c, space),
+                _mm_and_si128(_mm_cmpgt_epi8(c, before_control), _mm_cmplt_epi8(c, after_control)));
+            __m128i known = _mm_or_si128(_mm_or_si128(lower, digit), delimiter);
+            d |= (uint64_t) (uint16_t) _mm_movemask_epi8(delimiter) << (lane * 16);
+            n |= (uint64_t) (uint16_t) ~_mm_movemask_epi8(known) << (lane * 16);
+            g |= (uint64_t) (uint16_t) _mm_movemask_epi8(digit) << (lane * 16);
+        }
+        delimiters[word] = d;
+        non_alnum[word] = n;
+        digits[word] = g;
+    }
+    if(word * 64 < length){
+        _scan_scalar(buffer + word * 64, length - word * 64, delimiters + word, non_alnum + word, digits + word);
+    }
+}
+
+__attribute__((target("avx2")))
+static void _scan_avx2(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits){
+    const __m256i before_upper = _mm256_set1_epi8('A' - 1), after_upper = _mm256_set1_epi8('Z' + 1);
+    const __m256i before_lower = _mm256_set1_epi8('a' - 1), after_lower = _mm256_set1_epi8('z' + 1);
+    const __m256i before_digit = _mm256_set1_epi8('0' - 1), after_digit = _mm256_set1_epi8('9' + 1);
+    const __m256i before_control = _mm256_set1_epi8('\t' - 1), after_control = _mm256_set1_epi8('\r' + 1);
+    const __m256i space = _mm256_set1_epi8(' '), case_bit = _mm256_set1_epi8(0x20);
+    size_t word = 0;
+    for(; (word + 1) * 64 <= length; word++){
+        uint64_t d = 0, n = 0, g = 0;
+        for(int lane = 0; lane < 2; lane++){
+            __m256i *address = (__m256i *) (buffer + word * 64 + lane * 32);
+            __m256i c = _mm256_loadu_si256(address);
+            __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, before_upper), _mm256_cmpgt_epi8(after_upper, c));
+            c = _mm256_or_si256(c, _mm256_and_si256(upper, case_bit));
+            _mm256_storeu_si256(address, c);
+            __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, before_lower), _mm256_cmpgt_epi8(after_lower, c));
+            __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, before_digit), _mm256_cmpgt_epi8(after_digit, c));
+            __m256i delimiter = _mm256_or_si256(_mm256_cmpeq_epi8(c, space),
+                _mm256_and_si256(_mm256_cmpgt_epi8(c, before_control), _mm256_cmpgt_epi8(after_control, c)));
+            __m256i known = _mm256_or_si256(_mm256_or_si256(lower, digit), delimiter);
+            d |= (uint64_t) (uint32_t) _mm256_movemask_epi8(delimiter) << (lane * 32);
+            n |= (uint64_t) (uint32_t) ~_mm256_movemask_epi8(known) << (lane * 32);
+            g |= (uint64_t) (uint32_t) _mm256_movemask_epi8(digit) << (lane * 32);
+        }
+        delimiters[word] = d;
+        non_alnum[word] = n;
+        digits[word] = g;
+    }
+    if(word * 64 < length){
+        _scan_scalar(buffer + word * 64, length - word * 64, delimiters + word, non_alnum + word, digits + word);
+    }
+}
+
+#endif
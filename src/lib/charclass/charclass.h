@@ -0,0 +1,59 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Implementazioni disponibili di charclass_scan().
+ */
+typedef enum CharclassKernel {
+    CHARCLASS_SCALAR,
+    CHARCLASS_SSE2,
+    CHARCLASS_AVX2
+} CharclassKernel;
+
+/**
+ * @brief Esamina length byte del buffer in un'unica passata:
+ * converte in minuscolo le lettere ASCII e, per ogni byte,
+ * imposta un bit nelle maschere corrispondenti. Il bit i
+ * della parola i / 64 si riferisce al byte buffer[i].
+ * Ogni maschera deve contenere (length + 63) / 64 parole;
+ * i bit oltre length vengono azzerati.
+ * 
+ * @param buffer I byte da esaminare
+ * @param length Il numero di byte da esaminare
+ * @param delimiters Bit impostato per gli spazi (' ', '\t'...'\r')
+ * @param non_alnum Bit impostato per i byte che non sono né
+ * spazi né caratteri alfanumerici
+ * @param digits Bit impostato per le cifre
+ */
+void charclass_scan(char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits);
+
+/**
+ * @brief Come charclass_scan(), utilizzando l'implementazione
+ * specificata invece di quella scelta a runtime.
+ * L'implementazione deve essere supportata dalla CPU.
+ */
+void charclass_scan_with_kernel(CharclassKernel kernel, char *buffer, size_t length, uint64_t *delimiters, uint64_t *non_alnum, uint64_t *digits);
+
+/**
+ * @brief Restituisce l'implementazione più veloce supportata
+ * dalla CPU, utilizzata da charclass_scan()
+ * 
+ * @return CharclassKernel 
+ */
+CharclassKernel charclass_get_kernel();
+
+/**
+ * @brief Verifica se l'implementazione specificata
+ * è supportata dalla CPU
+ * 
+ * @param kernel 
+ * @return true 
+ * @return false 
+ */
+bool charclass_kernel_is_supported(CharclassKernel kernel);
+
+#endif
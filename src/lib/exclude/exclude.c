@@ -0,0 +1,301 @@
+#define _XOPEN_SOURCE 700
+
+#include "exclude.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define INITIAL_CAPACITY 64
+
+typedef struct _FileId _FileId;
+typedef struct _Path _Path;
+typedef struct _Pattern _Pattern;
+
+static uint64_t _hash_id(uint64_t device, uint64_t inode);
+static uint64_t _hash_path(const char *path, size_t length);
+static int _add_id(uint64_t device, uint64_t inode, ExcludeSet *set);
+static int _add_path(const char *path, ExcludeSet *set);
+static int _add_pattern(const char *pattern, ExcludeSet *set);
+static bool _contains_id(uint64_t device, uint64_t inode, const ExcludeSet *set);
+static bool _contains_path(const char *path, const ExcludeSet *set);
+static bool _matches_pattern(const char *path, const ExcludeSet *set);
+static bool _is_pattern(const char *text);
+
+/*
+ * I percorsi e le coppie (dispositivo, inode) sono in due tabelle
+ * hash a indirizzamento aperto, riempite al più per metà: la ricerca
+ * di un file costa O(1) indipendentemente dal numero di esclusioni.
+ * Solo i pattern vengono provati uno alla volta.
+ */
+typedef struct ExcludeSet {
+    _FileId *ids;
+    size_t ids_count;
+    size_t ids_capacity;
+    _Path *paths;
+    size_t paths_count;
+    size_t paths_capacity;
+    _Pattern *patterns;
+    size_t patterns_count;
+} ExcludeSet;
+
+typedef struct _FileId {
+    uint64_t device;
+    uint64_t inode;
+    bool used;
+} _FileId;
+
+typedef struct _Path {
+    char *path;
+    uint64_t hash;
+} _Path;
+
+typedef struct _Pattern {
+    char *pattern;
+    /* Il pattern non contiene '/' e vale per il solo nome del file */
+    bool basename;
+} _Pattern;
+
+ExcludeSet *exclude_set_new(){
+    ExcludeSet *set = calloc(1, sizeof(ExcludeSet));
+    if(!set){
+        return NULL;
+    }
+    set->ids = calloc(INITIAL_CAPACITY, sizeof(_FileId));
+    set->paths = calloc(INITIAL_CAPACITY, sizeof(_Path));
+    if(!set->ids || !set->paths){
+        exclude_set_destroy(set);
+        return NULL;
+    }
+    set->ids_capacity = INITIAL_CAPACITY;
+    set->paths_capacity = INITIAL_CAPACITY;
+    return set;
+}
+
+void exclude_set_destroy(ExcludeSet *set){
+    if(set){
+        for(size_t i = 0; i < set->paths_capacity; i++){
+            free(set->paths[i].path);
+        }
+        for(size_t i = 0; i < set->patterns_count; i++){
+            free(set->patterns[i].pattern);
+        }
+        free(set->ids);
+        free(set->paths);
+        free(set->patterns);
+        free(set);
+    }
+}
+
+int exclude_set_add(const char *pattern, ExcludeSet *set){
+    assert(pattern);
+    assert(set);
+    if(_is_pattern(pattern)){
+        return _add_pattern(pattern, set);
+    }
+    char *path = realpath(pattern, NULL);
+    if(!path){
+        return -1;
+    }
+    struct stat info;
+    int res = stat(path, &info);
+    if(res == 0){
+        res = _add_id(info.st_dev, info.st_ino, set);
+    }
+    if(res == 0){
+        res = _add_path(path, set);
+    }
+    free(path);
+    return res;
+}
+
+bool exclude_set_contains(const char *path, uint64_t device, uint64_t inode, const ExcludeSet *set){
+    assert(path);
+    assert(set);
+    return _contains_id(device, inode, set) || _contains_path(path, set) || _matches_pattern(path, set);
+}
+
+size_t exclude_set_get_count(const ExcludeSet *set){
+    assert(set);
+    return set->ids_count + set->patterns_count;
+}
+
+/* Private Methods */
+
+static uint64_t _hash_id(uint64_t device, uint64_t inode){
+    return device * 31 + inode * 0x9e3779b97f4a7c15u;
+}
+
+static uint64_t _hash_path(const char *path, size_t length){
+    uint64_t hash = 14695981039346656037u;
+    for(size_t i = 0; i < length; i++){
+        hash ^= (unsigned char) path[i];
+        hash *= 1099511628211u;
+    }
+    return hash;
+}
+
+static int _add_id(uint64_t device, uint64_t inode, ExcludeSet *set){
+    if(_contains_id(device, inode, set)){
+        return 0;
+    }
+    if(2 * (set->ids_count + 1) > set->ids_capacity){
+        size_t capacity = set->ids_capacity * 2;
+        _FileId *ids = calloc(capacity, sizeof(_FileId));
+        if(!ids){
+            return -1;
+        }
+        for(size_t i = 0; i < set->ids_capacity; i++){
+            if(set->ids[i].used){
+                size_t slot = _hash_id(set->ids[i].device, set->ids[i].inode) & (capacity - 1);
+                while(ids[slot].used){
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                ids[slot] = set->ids[i];
+            }
+        }
+        free(set->ids);
+        set->ids = ids;
+        set->ids_capacity = capacity;
+    }
+    size_t mask = set->ids_capacity - 1;
+    size_t slot = _hash_id(device, inode) & mask;
+    while(set->ids[slot].used){
+        slot = (slot + 1) & mask;
+    }
+    set->ids[slot] = (_FileId) { device, inode, true };
+    set->ids_count++;
+    return 0;
+}
+
+static int _add_path(const char *path, ExcludeSet *set){
+    if(_contains_path(path, set)){
+        return 0;
+    }
+    if(2 * (set->paths_count + 1) > set->paths_capacity){
+        size_t capacity = set->paths_capacity * 2;
+        _Path *paths = calloc(capacity, sizeof(_Path));
+        if(!paths){
+            return -1;
+        }
+        for(size_t i = 0; i < set->paths_capacity; i++){
+            if(set->paths[i].path){
+                size_t slot = set->paths[i].hash & (capacity - 1);
+                while(paths[slot].path){
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                paths[slot] = set->paths[i];
+            }
+        }
+        free(set->paths);
+        set->paths = paths;
+        set->paths_capacity = capacity;
+    }
+    size_t length = strlen(path);
+    char *copy = malloc(length + 1);
+    if(!copy){
+        return -1;
+    }
+    memcpy(copy, path, length + 1);
+    uint64_t hash = _hash_path(path, length);
+    size_t mask = set->paths_capacity - 1;
+    size_t slot = hash & mask;
+    while(set->paths[slot].path){
+        slot = (slot + 1) & mask;
+    }
+    set->paths[slot] = (_Path) { copy, hash };
+    set->paths_count++;
+    return 0;
+}
+
+static int _add_pattern(const char *pattern, ExcludeSet *set){
+    _Pattern *patterns = realloc(set->patterns, (set->patterns_count + 1) * sizeof(_Pattern));
+    if(!patterns){
+        return -1;
+    }
+    set->patterns = patterns;
+    bool basename = strchr(pattern, '/') == NULL;
+    char cwd[PATH_MAX];
+    const char *prefix = "";
+    if(!basename && pattern[0] != '/'){
+        /* I percorsi visitati sono assoluti, quindi anche il pattern deve esserlo */
+        if(!getcwd(cwd, sizeof(cwd))){
+            return -1;
+        }
+        prefix = cwd;
+    }
+    size_t prefix_length = strlen(prefix);
+    size_t length = strlen(pattern);
+    char *copy = malloc(prefix_length + length + 2);
+    if(!copy){
+        return -1;
+    }
+    memcpy(copy, prefix, prefix_length);
+    if(prefix_length > 0 && prefix[prefix_length - 1] != '/'){
+        copy[prefix_length++] = '/';
+    }
+    memcpy(copy + prefix_length, pattern, length + 1);
+    set->patterns[set->patterns_count++] = (_Pattern) { copy, basename };
+    return 0;
+}
+
+static bool _contains_id(uint64_t device, uint64_t inode, const ExcludeSet *set){
+    if(set->ids_count == 0){
+        return false;
+    }
+    size_t mask = set->ids_capacity - 1;
+    size_t slot = _hash_id(device, inode) & mask;
+    while(set->ids[slot].used){
+        if(set->ids[slot].device == device && set->ids[slot].inode == inode){
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+static bool _contains_path(const char *path, const ExcludeSet *set){
+    if(set->paths_count == 0){
+        return false;
+    }
+    uint64_t hash = _hash_path(path, strlen(path));
+    size_t mask = set->paths_capacity - 1;
+    size_t slot = hash & mask;
+    while(set->paths[slot].path){
+        if(set->paths[slot].hash == hash && strcmp(set->paths[slot].path, path) == 0){
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+static bool _matches_pattern(const char *path, const ExcludeSet *set){
+    if(set->patterns_count == 0){
+        return false;
+    }
+    const char *name = strrchr(path, '/');
+    name = (name) ? name + 1 : path;
+    for(size_t i = 0; i < set->patterns_count; i++){
+        const _Pattern *pattern = &set->patterns[i];
+        if(pattern->basename){
+            if(fnmatch(pattern->pattern, name, 0) == 0){
+                return true;
+            }
+        } else if(fnmatch(pattern->pattern, path, FNM_PATHNAME) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _is_pattern(const char *text){
+    return strpbrk(text, "*?[") != NULL;
+}
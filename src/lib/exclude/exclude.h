@@ -0,0 +1,61 @@
+#ifndef EXCLUDE_H
+#define EXCLUDE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ExcludeSet ExcludeSet;
+
+/**
+ * @brief Crea un insieme di esclusioni vuoto
+ *
+ * @return ExcludeSet* Il puntatore all'insieme creato
+ * @return NULL Failure
+ */
+ExcludeSet *exclude_set_new();
+
+/**
+ * @brief Libera la memoria riservata all'insieme
+ *
+ * @param set L'insieme da distruggere
+ */
+void exclude_set_destroy(ExcludeSet *set);
+
+/**
+ * @brief Aggiunge un'esclusione. Un percorso viene registrato
+ * sia con il suo percorso canonico sia con la coppia
+ * (dispositivo, inode), così da riconoscerlo anche se raggiunto
+ * attraverso un link. Un pattern con '*', '?' o '[' viene
+ * confrontato con fnmatch(): se non contiene '/' vale per il
+ * nome del file, altrimenti per il percorso assoluto.
+ *
+ * @param pattern Il percorso o il pattern da escludere
+ * @param set L'insieme a cui aggiungere l'esclusione
+ * @return 0 Success
+ * @return -1 Failure, errno indica se il percorso non esiste
+ */
+int exclude_set_add(const char *pattern, ExcludeSet *set);
+
+/**
+ * @brief Verifica se un file è escluso. Può essere invocata
+ * in contemporanea da più thread.
+ *
+ * @param path Il percorso assoluto del file
+ * @param device Il dispositivo del file
+ * @param inode L'inode del file
+ * @param set L'insieme in cui cercare
+ * @return true Il file è escluso
+ * @return false Il file non è escluso
+ */
+bool exclude_set_contains(const char *path, uint64_t device, uint64_t inode, const ExcludeSet *set);
+
+/**
+ * @brief Restituisce il numero di esclusioni registrate
+ *
+ * @param set L'insieme
+ * @return size_t Il numero di esclusioni
+ */
+size_t exclude_set_get_count(const ExcludeSet *set);
+
+#endif
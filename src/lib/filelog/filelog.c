@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "filelog.h"
+#include "../writer/writer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define LOG_BUFFER_SIZE (256 * 1024)
+#define LOG_HEADER "file;words;ignored;seconds;bytes;tokens;tokens_per_second;mb_per_second;read_seconds;wait_seconds\n"
+#define NUMBERS_SIZE 256
+
+/*
+ * Le righe vengono formattate fuori dal lock e accodate a un solo
+ * writer: il file viene scritto solo quando il buffer è pieno,
+ * invece di essere aperto e chiuso a ogni riga.
+ */
+typedef struct FileLog {
+    int fd;
+    Writer *writer;
+    pthread_mutex_t mutex;
+} FileLog;
+
+FileLog *filelog_open(const char *path){
+    assert(path);
+    FileLog *log = malloc(sizeof(FileLog));
+    if(!log){
+        return NULL;
+    }
+    log->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if(log->fd < 0){
+        free(log);
+        return NULL;
+    }
+    log->writer = writer_new(log->fd, LOG_BUFFER_SIZE);
+    if(!log->writer || writer_write(LOG_HEADER, strlen(LOG_HEADER), log->writer) < 0){
+        writer_destroy(log->writer);
+        close(log->fd);
+        free(log);
+        return NULL;
+    }
+    pthread_mutex_init(&log->mutex, NULL);
+    return log;
+}
+
+int filelog_close(FileLog *log){
+    if(!log){
+        return 0;
+    }
+    int res = writer_flush(log->writer);
+    writer_destroy(log->writer);
+    if(close(log->fd) < 0){
+        res = -1;
+    }
+    pthread_mutex_destroy(&log->mutex);
+    free(log);
+    return res;
+}
+
+int filelog_write(const FileLogEntry *entry, FileLog *log){
+    assert(entry);
+    assert(log);
+    int tokens = entry->words + entry->ignored;
+    double tokens_per_second = 0, mb_per_second = 0;
+    if(entry->seconds > 0){
+        tokens_per_second = tokens / entry->seconds;
+        mb_per_second = entry->bytes / 1e6 / entry->seconds;
+    }
+    char numbers[NUMBERS_SIZE];
+    int length = snprintf(numbers, sizeof(numbers), ";%d;%d;%.6f;%zu;%d;%.0f;%.3f;%.6f;%.6f\n",
+        entry->words, entry->ignored, entry->seconds, entry->bytes, tokens,
+        tokens_per_second, mb_per_second, entry->read_seconds, entry->wait_seconds);
+    if(length < 0 || length >= NUMBERS_SIZE){
+        return -1;
+    }
+    pthread_mutex_lock(&log->mutex);
+    int res = writer_write(entry->path, strlen(entry->path), log->writer);
+    if(res == 0){
+        res = writer_write(numbers, length, log->writer);
+    }
+    pthread_mutex_unlock(&log->mutex);
+    return res;
+}
+
+int filelog_write_comment(const char *text, FileLog *log){
+    assert(text);
+    assert(log);
+    pthread_mutex_lock(&log->mutex);
+    int res = writer_write("# ", 2, log->writer);
+    if(res == 0){
+        res = writer_write(text, strlen(text), log->writer);
+    }
+    if(res == 0){
+        res = writer_write_char('\n', log->writer);
+    }
+    pthread_mutex_unlock(&log->mutex);
+    return res;
+}
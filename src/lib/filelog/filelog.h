@@ -0,0 +1,68 @@
+#ifndef FILELOG_H
+#define FILELOG_H
+
+#include <stddef.h>
+
+typedef struct FileLog FileLog;
+
+/* Le misure di un file elaborato */
+typedef struct FileLogEntry {
+    const char *path;
+    /* Le parole conteggiate */
+    int words;
+    /* Le parole scartate */
+    int ignored;
+    /* I byte letti */
+    size_t bytes;
+    /* Il tempo reale di elaborazione */
+    double seconds;
+    /* Il tempo di lettura anticipata, 0 se il file non è stato letto in anticipo */
+    double read_seconds;
+    /* Il tempo atteso prima che il file fosse letto, 0 se non è stato letto in anticipo */
+    double wait_seconds;
+} FileLogEntry;
+
+/**
+ * @brief Crea il file di log, sovrascrivendolo se esiste,
+ * e ne scrive l'intestazione. Le righe vengono accumulate in
+ * un buffer e scritte a blocchi.
+ *
+ * @param path Il percorso del file di log
+ * @return FileLog* Il puntatore al log creato
+ * @return NULL Failure
+ */
+FileLog *filelog_open(const char *path);
+
+/**
+ * @brief Scrive le righe rimaste nel buffer, chiude il file
+ * e libera la memoria riservata al log
+ *
+ * @param log Il log da chiudere
+ * @return 0 Success
+ * @return -1 Failure, alcune righe potrebbero non essere state scritte
+ */
+int filelog_close(FileLog *log);
+
+/**
+ * @brief Aggiunge la riga di un file, con le parole al secondo
+ * e i MB al secondo. Può essere invocata da più thread.
+ *
+ * @param entry Le misure del file
+ * @param log Il log su cui scrivere
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int filelog_write(const FileLogEntry *entry, FileLog *log);
+
+/**
+ * @brief Aggiunge una riga di commento, preceduta da '#'.
+ * Può essere invocata da più thread.
+ *
+ * @param text Il testo del commento, senza a capo
+ * @param log Il log su cui scrivere
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int filelog_write_comment(const char *text, FileLog *log);
+
+#endif
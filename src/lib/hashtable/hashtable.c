@@ -0,0 +1,437 @@
+#include "hashtable.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+
+#define INITIAL_CAPACITY 1024
+/* La tabella viene raddoppiata quando è piena per tre quarti */
+#define MAX_LOAD_NUMERATOR 3
+#define MAX_LOAD_DENOMINATOR 4
+/* Le parole fino a INLINE_LENGTH caratteri sono contenute nel posto */
+#define INLINE_LENGTH 20
+#define INITIAL_POOL_CAPACITY 4096
+/* Oltre questa profondità i gruppi di parole con lo stesso prefisso sono ordinati per inserimento */
+#define MAX_RADIX_DEPTH 64
+
+typedef struct _Slot _Slot;
+typedef struct _SortItem _SortItem;
+
+static uint64_t _hash(const char *word, size_t length);
+static uint32_t _get_tag(uint64_t hash);
+static const char *_get_word(const _Slot *slot, const HashTable *table);
+static _Slot *_find(const char *word, size_t length, uint64_t hash, const HashTable *table);
+static int _store(const char *word, size_t length, _Slot *slot, HashTable *table);
+static int _grow(HashTable *table);
+static _SortItem *_get_sorted_words(const HashTable *table, size_t *count);
+static void _sort_words(_SortItem *items, _SortItem *buffer, size_t count, size_t depth, const HashTable *table);
+static void _sort_by_prefix(_SortItem *items, size_t count, size_t depth, const HashTable *table);
+static void _radix_sort(_SortItem *items, _SortItem *buffer, size_t count, int bytes);
+static uint64_t _get_chunk(const char *word, size_t length, size_t depth);
+static int _visit_items(const _SortItem *items, size_t count, HashTableVisitor visitor, void *context, const HashTable *table);
+
+/*
+ * tag contiene i 32 bit alti dell'hash con il bit più basso
+ * impostato: 0 indica un posto vuoto. Le parole più lunghe di
+ * INLINE_LENGTH sono nel pool, terminate da '\0', e word
+ * contiene la loro posizione nel pool.
+ */
+typedef struct _Slot {
+    uint32_t tag;
+    int occurrences;
+    uint32_t length;
+    char word[INLINE_LENGTH];
+} _Slot;
+
+_Static_assert(sizeof(_Slot) == 32, "a slot must fill half a cache line");
+
+typedef struct HashTable {
+    _Slot *slots;
+    size_t capacity;
+    size_t count;
+    char *pool;
+    size_t pool_length;
+    size_t pool_capacity;
+} HashTable;
+
+/* key è la chiave dell'ordinamento in corso, slot l'indice del posto della parola */
+typedef struct _SortItem {
+    uint64_t key;
+    size_t slot;
+} _SortItem;
+
+HashTable *hashtable_new(){
+    HashTable *table = calloc(1, sizeof(HashTable));
+    if(!table){
+        return NULL;
+    }
+    table->slots = calloc(INITIAL_CAPACITY, sizeof(_Slot));
+    if(!table->slots){
+        free(table);
+        return NULL;
+    }
+    table->capacity = INITIAL_CAPACITY;
+    return table;
+}
+
+void hashtable_destroy(HashTable *table){
+    if(!table){
+        return;
+    }
+    free(table->slots);
+    free(table->pool);
+    free(table);
+}
+
+int hashtable_insert_n(const char *word, size_t length, int occurrences, HashTable *table){
+    assert(word);
+    assert(table);
+    if(length == 0 || length > UINT32_MAX || occurrences < 0){
+        errno = EINVAL;
+        return -1;
+    }
+    if((table->count + 1) * MAX_LOAD_DENOMINATOR > table->capacity * MAX_LOAD_NUMERATOR && _grow(table) < 0){
+        return -1;
+    }
+    uint64_t hash = _hash(word, length);
+    _Slot *slot = _find(word, length, hash, table);
+    if(slot->tag == 0){
+        if(_store(word, length, slot, table) < 0){
+            return -1;
+        }
+        slot->tag = _get_tag(hash);
+        slot->occurrences = 0;
+        table->count++;
+    }
+    if(slot->occurrences > INT_MAX - occurrences){
+        errno = EOVERFLOW;
+        return -1;
+    }
+    slot->occurrences += occurrences;
+    return slot->occurrences;
+}
+
+int hashtable_subtract_n(const char *word, size_t length, int occurrences, HashTable *table){
+    assert(word);
+    assert(table);
+    if(length == 0 || occurrences < 1){
+        errno = EINVAL;
+        return -1;
+    }
+    _Slot *slot = _find(word, length, _hash(word, length), table);
+    if(slot->tag == 0){
+        return 0;
+    }
+    slot->occurrences -= occurrences;
+    if(slot->occurrences < 0){
+        slot->occurrences = 0;
+    }
+    return slot->occurrences;
+}
+
+int hashtable_get_occurrences_n(const char *word, size_t length, const HashTable *table){
+    assert(word);
+    assert(table);
+    _Slot *slot = _find(word, length, _hash(word, length), table);
+    return (slot->tag == 0) ? 0 : slot->occurrences;
+}
+
+int hashtable_merge(const HashTable *source, HashTable *destination){
+    assert(source);
+    assert(destination);
+    for(size_t i = 0; i < source->capacity; i++){
+        const _Slot *slot = &source->slots[i];
+        if(slot->tag != 0 && slot->occurrences > 0){
+            if(hashtable_insert_n(_get_word(slot, source), slot->length, slot->occurrences, destination) < 0){
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+size_t hashtable_get_slots_count(const HashTable *table){
+    assert(table);
+    return table->capacity;
+}
+
+size_t hashtable_get_words_count(const HashTable *table){
+    assert(table);
+    return table->count;
+}
+
+size_t hashtable_get_memory_usage(const HashTable *table){
+    assert(table);
+    return sizeof(HashTable) + table->capacity * sizeof(_Slot) + table->pool_capacity;
+}
+
+int hashtable_visit(const HashTable *table, HashTableVisitor visitor, void *context){
+    assert(table);
+    assert(visitor);
+    size_t count;
+    _SortItem *items = _get_sorted_words(table, &count);
+    if(!items){
+        return -1;
+    }
+    int res = _visit_items(items, count, visitor, context, table);
+    free(items);
+    return res;
+}
+
+int hashtable_visit_by_occurrences(const HashTable *table, HashTableVisitor visitor, void *context){
+    assert(table);
+    assert(visitor);
+    size_t count;
+    _SortItem *items = _get_sorted_words(table, &count);
+    _SortItem *buffer = (items) ? malloc((count + 1) * sizeof(_SortItem)) : NULL;
+    if(!buffer){
+        free(items);
+        return -1;
+    }
+    /* L'ordinamento è stabile: a parità di occorrenze resta l'ordine alfabetico */
+    for(size_t i = 0; i < count; i++){
+        items[i].key = UINT32_MAX - (uint32_t) table->slots[items[i].slot].occurrences;
+    }
+    _radix_sort(items, buffer, count, 4);
+    free(buffer);
+    int res = _visit_items(items, count, visitor, context, table);
+    free(items);
+    return res;
+}
+
+/* Private Methods */
+
+/* Legge la parola a blocchi di 8 byte, con il finalizzatore di MurmurHash3 */
+static uint64_t _hash(const char *word, size_t length){
+    uint64_t hash = 0x9e3779b97f4a7c15u ^ (length * 0xff51afd7ed558ccdu);
+    size_t i = 0;
+    for(; i + 8 <= length; i += 8){
+        uint64_t chunk;
+        memcpy(&chunk, word + i, 8);
+        hash = (hash ^ chunk) * 0xc4ceb9fe1a85ec53u;
+        hash ^= hash >> 29;
+    }
+    if(i < length){
+        uint64_t chunk = 0;
+        memcpy(&chunk, word + i, length - i);
+        hash = (hash ^ chunk) * 0xc4ceb9fe1a85ec53u;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53u;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint32_t _get_tag(uint64_t hash){
+    return (uint32_t) (hash >> 32) | 1;
+}
+
+/* Le parole corte non sono terminate da '\0' */
+static const char *_get_word(const _Slot *slot, const HashTable *table){
+    if(slot->length <= INLINE_LENGTH){
+        return slot->word;
+    }
+    size_t offset;
+    memcpy(&offset, slot->word, sizeof(size_t));
+    return table->pool + offset;
+}
+
+/* Restituisce il posto della parola oppure il posto vuoto in cui inserirla */
+static _Slot *_find(const char *word, size_t length, uint64_t hash, const HashTable *table){
+    size_t mask = table->capacity - 1;
+    uint32_t tag = _get_tag(hash);
+    for(size_t index = hash & mask;; index = (index + 1) & mask){
+        _Slot *slot = &table->slots[index];
+        if(slot->tag == 0){
+            return slot;
+        }
+        if(slot->tag == tag && slot->length == length && memcmp(_get_word(slot, table), word, length) == 0){
+            return slot;
+        }
+    }
+}
+
+static int _store(const char *word, size_t length, _Slot *slot, HashTable *table){
+    slot->length = length;
+    if(length <= INLINE_LENGTH){
+        memcpy(slot->word, word, length);
+        return 0;
+    }
+    if(table->pool_length + length + 1 > table->pool_capacity){
+        size_t capacity = (table->pool_capacity == 0) ? INITIAL_POOL_CAPACITY : table->pool_capacity * 2;
+        while(table->pool_length + length + 1 > capacity){
+            capacity *= 2;
+        }
+        char *pool = realloc(table->pool, capacity);
+        if(!pool){
+            return -1;
+        }
+        table->pool = pool;
+        table->pool_capacity = capacity;
+    }
+    memcpy(table->pool + table->pool_length, word, length);
+    table->pool[table->pool_length + length] = '\0';
+    memcpy(slot->word, &table->pool_length, sizeof(size_t));
+    table->pool_length += length + 1;
+    return 0;
+}
+
+static int _grow(HashTable *table){
+    size_t capacity = table->capacity * 2, mask = capacity - 1;
+    _Slot *slots = calloc(capacity, sizeof(_Slot));
+    if(!slots){
+        return -1;
+    }
+    for(size_t i = 0; i < table->capacity; i++){
+        const _Slot *slot = &table->slots[i];
+        if(slot->tag == 0){
+            continue;
+        }
+        size_t index = _hash(_get_word(slot, table), slot->length) & mask;
+        while(slots[index].tag != 0){
+            index = (index + 1) & mask;
+        }
+        slots[index] = *slot;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+/* Le parole con almeno un'occorrenza, in ordine alfabetico */
+static _SortItem *_get_sorted_words(const HashTable *table, size_t *count){
+    _SortItem *items = malloc((table->count + 1) * sizeof(_SortItem));
+    _SortItem *buffer = malloc((table->count + 1) * sizeof(_SortItem));
+    if(!items || !buffer){
+        free(items);
+        free(buffer);
+        return NULL;
+    }
+    size_t words = 0;
+    for(size_t i = 0; i < table->capacity; i++){
+        const _Slot *slot = &table->slots[i];
+        if(slot->tag != 0 && slot->occurrences > 0){
+            items[words++].slot = i;
+        }
+    }
+    _sort_words(items, buffer, words, 0, table);
+    free(buffer);
+    *count = words;
+    return items;
+}
+
+/*
+ * Ordina le parole, che hanno in comune i primi depth caratteri,
+ * con un radix sort sugli 8 caratteri successivi; i gruppi che
+ * hanno in comune anche questi vengono ordinati sui successivi.
+ * I caratteri mancanti valgono 0, quindi una parola precede
+ * quelle di cui è prefisso.
+ */
+static void _sort_words(_SortItem *items, _SortItem *buffer, size_t count, size_t depth, const HashTable *table){
+    if(count < 2){
+        return;
+    }
+    if(depth >= MAX_RADIX_DEPTH){
+        _sort_by_prefix(items, count, depth, table);
+        return;
+    }
+    for(size_t i = 0; i < count; i++){
+        const _Slot *slot = &table->slots[items[i].slot];
+        items[i].key = _get_chunk(_get_word(slot, table), slot->length, depth);
+    }
+    _radix_sort(items, buffer, count, 8);
+    /* Due parole distinte con la stessa chiave proseguono entrambe oltre depth + 8 */
+    for(size_t begin = 0, end; begin < count; begin = end){
+        for(end = begin + 1; end < count && items[end].key == items[begin].key; end++);
+        _sort_words(items + begin, buffer + begin, end - begin, depth + 8, table);
+    }
+}
+
+/* Ordinamento per inserimento dei caratteri oltre depth, per i rari gruppi di parole molto lunghe */
+static void _sort_by_prefix(_SortItem *items, size_t count, size_t depth, const HashTable *table){
+    for(size_t i = 1; i < count; i++){
+        _SortItem item = items[i];
+        const _Slot *slot = &table->slots[item.slot];
+        const char *word = _get_word(slot, table) + depth;
+        size_t j = i;
+        for(; j > 0; j--){
+            const _Slot *other = &table->slots[items[j - 1].slot];
+            size_t length = (other->length < slot->length) ? other->length : slot->length;
+            int cmp = memcmp(_get_word(other, table) + depth, word, length - depth);
+            if(cmp < 0 || (cmp == 0 && other->length < slot->length)){
+                break;
+            }
+            items[j] = items[j - 1];
+        }
+        items[j] = item;
+    }
+}
+
+/* Radix sort stabile sui primi bytes byte meno significativi delle chiavi */
+static void _radix_sort(_SortItem *items, _SortItem *buffer, size_t count, int bytes){
+    if(count < 2){
+        return;
+    }
+    _SortItem *source = items, *destination = buffer;
+    for(int shift = 0; shift < bytes * 8; shift += 8){
+        size_t buckets[256] = {0};
+        for(size_t i = 0; i < count; i++){
+            buckets[(source[i].key >> shift) & 0xFF]++;
+        }
+        if(buckets[(source[0].key >> shift) & 0xFF] == count){
+            continue;
+        }
+        size_t position = 0;
+        for(int b = 0; b < 256; b++){
+            size_t bucket = buckets[b];
+            buckets[b] = position;
+            position += bucket;
+        }
+        for(size_t i = 0; i < count; i++){
+            destination[buckets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+        _SortItem *swap = source;
+        source = destination;
+        destination = swap;
+    }
+    if(source != items){
+        memcpy(items, source, count * sizeof(_SortItem));
+    }
+}
+
+/* Gli 8 caratteri da depth in poi, il primo nel byte più significativo */
+static uint64_t _get_chunk(const char *word, size_t length, size_t depth){
+    uint64_t chunk = 0;
+    for(size_t i = 0; i < 8; i++){
+        chunk <<= 8;
+        if(depth + i < length){
+            chunk |= (unsigned char) word[depth + i];
+        }
+    }
+    return chunk;
+}
+
+static int _visit_items(const _SortItem *items, size_t count, HashTableVisitor visitor, void *context, const HashTable *table){
+    char word[INLINE_LENGTH + 1];
+    for(size_t i = 0; i < count; i++){
+        const _Slot *slot = &table->slots[items[i].slot];
+        const char *visited = _get_word(slot, table);
+        if(slot->length <= INLINE_LENGTH){
+            memcpy(word, visited, slot->length);
+            word[slot->length] = '\0';
+            visited = word;
+        }
+        int res = visitor(visited, slot->occurrences, context);
+        if(res != 0){
+            return res;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <stddef.h>
+
+typedef struct HashTable HashTable;
+
+/**
+ * @brief Funzione invocata dalle visite per ogni parola della tabella.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*HashTableVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Crea una tabella vuota delle occorrenze delle parole,
+ * a indirizzamento aperto. Le parole corte sono contenute nei
+ * posti della tabella, le altre in un'area a parte: un inserimento
+ * legge di solito una sola linea di cache.
+ * Le parole non sono ordinate: l'ordine viene calcolato, con un
+ * radix sort, solo dalle visite.
+ *
+ * @return HashTable* Il puntatore alla tabella creata
+ * @return NULL Failure
+ */
+HashTable *hashtable_new();
+
+/**
+ * @brief Libera la memoria riservata alla tabella
+ *
+ * @param table La tabella da distruggere
+ */
+void hashtable_destroy(HashTable *table);
+
+/**
+ * @brief Aggiunge le occorrenze specificate ai primi length
+ * caratteri di word, inserendo la parola se non è contenuta
+ * nella tabella. La parola non deve essere terminata da '\0'.
+ *
+ * @param word La parola da inserire
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da aggiungere
+ * @param table La tabella a cui aggiungere la parola
+ * @return int Il numero di occorrenze della parola dopo l'inserimento
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int hashtable_insert_n(const char *word, size_t length, int occurrences, HashTable *table);
+
+/**
+ * @brief Sottrae le occorrenze specificate ai primi length
+ * caratteri di word. Una parola con zero occorrenze non viene
+ * più visitata; se non è contenuta nella tabella non viene
+ * eseguita nessuna azione.
+ *
+ * @param word La parola da cui sottrarre le occorrenze
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da sottrarre
+ * @param table La tabella da cui sottrarre le occorrenze
+ * @return int Il numero di occorrenze rimaste
+ * @return -1 Failure
+ */
+int hashtable_subtract_n(const char *word, size_t length, int occurrences, HashTable *table);
+
+/**
+ * @brief Restituisce le occorrenze dei primi length caratteri di word
+ *
+ * @param word La parola da cercare
+ * @param length La lunghezza della parola
+ * @param table La tabella in cui cercare
+ * @return int Le occorrenze, 0 se la parola non è contenuta
+ */
+int hashtable_get_occurrences_n(const char *word, size_t length, const HashTable *table);
+
+/**
+ * @brief Aggiunge a destination le parole e le occorrenze di source.
+ * La tabella source non viene modificata.
+ *
+ * @param source La tabella da cui leggere le parole
+ * @param destination La tabella in cui inserire le parole
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int hashtable_merge(const HashTable *source, HashTable *destination);
+
+/**
+ * @brief Restituisce il numero dei posti della tabella
+ *
+ * @param table La tabella
+ * @return size_t Il numero dei posti
+ */
+size_t hashtable_get_slots_count(const HashTable *table);
+
+/**
+ * @brief Restituisce il numero delle parole inserite nella tabella
+ *
+ * @param table La tabella
+ * @return size_t Il numero delle parole
+ */
+size_t hashtable_get_words_count(const HashTable *table);
+
+/**
+ * @brief Restituisce i byte occupati dai posti e dalle parole lunghe
+ *
+ * @param table La tabella
+ * @return size_t I byte occupati
+ */
+size_t hashtable_get_memory_usage(const HashTable *table);
+
+/**
+ * @brief Visita le parole in ordine alfabetico, come trie_visit()
+ *
+ * @param table La tabella da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int hashtable_visit(const HashTable *table, HashTableVisitor visitor, void *context);
+
+/**
+ * @brief Visita le parole in ordine decrescente di occorrenze e,
+ * a parità di occorrenze, in ordine alfabetico, come
+ * trie_visit_by_occurrences()
+ *
+ * @param table La tabella da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int hashtable_visit_by_occurrences(const HashTable *table, HashTableVisitor visitor, void *context);
+
+#endif
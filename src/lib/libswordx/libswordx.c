@@ -0,0 +1,407 @@
+#define _GNU_SOURCE
+
+#include "libswordx.h"
+#include "../trie/trie.h"
+#include "../tokenizer/tokenizer.h"
+#include "../walker/walker.h"
+#include "../exclude/exclude.h"
+#include "../wordfilter/wordfilter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct _Counter _Counter;
+typedef struct _Job _Job;
+
+static int _count_tokens(Tokenizer *tokenizer, const swordx_ctx *ctx, _Counter *counter);
+static int _count_file(const char *path, const swordx_ctx *ctx, _Counter *counter);
+static int _count_walked_files(_Job *job, _Counter *counter);
+static int _ignore_tokens(Tokenizer *tokenizer, swordx_ctx *ctx);
+static int _insert_word(const Token *token, void *counter);
+static ssize_t _memory_read(void *reader, char *buffer, size_t size);
+static bool _is_excluded(const char *path, uint64_t device, uint64_t inode, void *ctx);
+static void *_worker_run(void *worker);
+static int _counter_init(_Counter *counter, const SwordxOptions *options);
+static int _counter_merge(const _Counter *source, _Counter *destination);
+static int _visit_word(const char *word, int occurrences, void *visit);
+static int _get_read_error();
+
+/* Le parole conteggiate e le quantità lette, per il contesto o per un thread */
+typedef struct _Counter {
+    Trie *words;
+    SwordxCounts counts;
+} _Counter;
+
+typedef struct swordx_ctx {
+    SwordxOptions options;
+    WordFilter *filter;
+    ExcludeSet *excludes;
+    _Counter counter;
+} swordx_ctx;
+
+typedef struct _MemoryReader {
+    const char *buffer;
+    size_t size;
+    size_t position;
+} _MemoryReader;
+
+/* Una visita di swordx_count_path(), condivisa dai thread che leggono i file */
+typedef struct _Job {
+    Walker *walker;
+    const swordx_ctx *ctx;
+    atomic_int status;
+} _Job;
+
+typedef struct _Worker {
+    pthread_t thread;
+    _Job *job;
+    _Counter counter;
+    int result;
+} _Worker;
+
+typedef struct _Visit {
+    SwordxVisitor visitor;
+    void *context;
+    int result;
+} _Visit;
+
+void swordx_options_init(SwordxOptions *options){
+    assert(options);
+    options->recursive = false;
+    options->follow = false;
+    options->alpha = false;
+    options->minimum_word_length = 0;
+    options->threads = 1;
+    options->huge_pages = false;
+}
+
+swordx_ctx *swordx_new(const SwordxOptions *options){
+    swordx_ctx *ctx = calloc(1, sizeof(swordx_ctx));
+    if(!ctx){
+        return NULL;
+    }
+    if(options){
+        ctx->options = *options;
+    } else {
+        swordx_options_init(&ctx->options);
+    }
+    if(ctx->options.threads == 0){
+        ctx->options.threads = 1;
+    }
+    ctx->filter = wordfilter_new();
+    ctx->excludes = exclude_set_new();
+    if(!ctx->filter || !ctx->excludes || _counter_init(&ctx->counter, &ctx->options) < 0){
+        swordx_destroy(ctx);
+        return NULL;
+    }
+    wordfilter_set_minimum_length(ctx->options.minimum_word_length, ctx->filter);
+    wordfilter_set_alpha(ctx->options.alpha, ctx->filter);
+    return ctx;
+}
+
+void swordx_destroy(swordx_ctx *ctx){
+    if(ctx){
+        wordfilter_destroy(ctx->filter);
+        exclude_set_destroy(ctx->excludes);
+        trie_destroy(ctx->counter.words);
+        free(ctx);
+    }
+}
+
+int swordx_ignore_word(const char *word, swordx_ctx *ctx){
+    if(!word || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    _MemoryReader reader = {word, strlen(word), 0};
+    Tokenizer *tokenizer = tokenizer_new_reader(_memory_read, &reader);
+    if(!tokenizer){
+        return SWORDX_ERROR_MEMORY;
+    }
+    int res = _ignore_tokens(tokenizer, ctx);
+    tokenizer_destroy(tokenizer);
+    return res;
+}
+
+int swordx_ignore_file(const char *path, swordx_ctx *ctx){
+    if(!path || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return SWORDX_ERROR_IO;
+    }
+    Tokenizer *tokenizer = tokenizer_new(fd);
+    int res = (tokenizer) ? _ignore_tokens(tokenizer, ctx) : SWORDX_ERROR_MEMORY;
+    tokenizer_destroy(tokenizer);
+    close(fd);
+    return res;
+}
+
+int swordx_exclude(const char *pattern, swordx_ctx *ctx){
+    if(!pattern || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    if(exclude_set_add(pattern, ctx->excludes) < 0){
+        return (errno == ENOMEM) ? SWORDX_ERROR_MEMORY : SWORDX_ERROR_IO;
+    }
+    return SWORDX_OK;
+}
+
+int swordx_count_buffer(const char *buffer, size_t size, swordx_ctx *ctx){
+    if((!buffer && size > 0) || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    _MemoryReader reader = {buffer, size, 0};
+    Tokenizer *tokenizer = tokenizer_new_reader(_memory_read, &reader);
+    if(!tokenizer){
+        return SWORDX_ERROR_MEMORY;
+    }
+    int res = _count_tokens(tokenizer, ctx, &ctx->counter);
+    tokenizer_destroy(tokenizer);
+    return res;
+}
+
+int swordx_count_fd(int fd, swordx_ctx *ctx){
+    if(fd < 0 || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    Tokenizer *tokenizer = tokenizer_new(fd);
+    if(!tokenizer){
+        return SWORDX_ERROR_MEMORY;
+    }
+    int res = _count_tokens(tokenizer, ctx, &ctx->counter);
+    tokenizer_destroy(tokenizer);
+    if(res == SWORDX_OK){
+        ctx->counter.counts.files++;
+    }
+    return res;
+}
+
+/*
+ * Come in swordx, i file trovati dal walker vengono letti da
+ * options.threads thread, ognuno con il proprio Trie, uniti alla
+ * fine a quello del contesto.
+ */
+int swordx_count_path(const char *path, swordx_ctx *ctx){
+    if(!path || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    char absolute[PATH_MAX];
+    if(!realpath(path, absolute)){
+        return SWORDX_ERROR_IO;
+    }
+    WalkerOptions options = {ctx->options.recursive, ctx->options.follow, ctx->options.threads, _is_excluded, ctx};
+    _Job job = {walker_new(&options), ctx, SWORDX_OK};
+    if(!job.walker){
+        return SWORDX_ERROR_MEMORY;
+    }
+    if(walker_add_root(absolute, job.walker) < 0){
+        walker_destroy(job.walker);
+        return SWORDX_ERROR_MEMORY;
+    }
+    if(walker_start(job.walker) < 0){
+        int res = _get_read_error();
+        walker_destroy(job.walker);
+        return res;
+    }
+    int res = SWORDX_OK;
+    if(ctx->options.threads == 1){
+        res = _count_walked_files(&job, &ctx->counter);
+    } else {
+        _Worker *workers = calloc(ctx->options.threads, sizeof(_Worker));
+        unsigned int started = 0;
+        res = (workers) ? SWORDX_OK : SWORDX_ERROR_MEMORY;
+        for(; res == SWORDX_OK && started < ctx->options.threads; started++){
+            _Worker *worker = &workers[started];
+            worker->job = &job;
+            if(_counter_init(&worker->counter, &ctx->options) < 0){
+                res = SWORDX_ERROR_MEMORY;
+                break;
+            }
+            if(pthread_create(&worker->thread, NULL, _worker_run, worker) != 0){
+                trie_destroy(worker->counter.words);
+                res = SWORDX_ERROR_MEMORY;
+                break;
+            }
+        }
+        if(res != SWORDX_OK){
+            atomic_store(&job.status, res);
+        }
+        for(unsigned int i = 0; i < started; i++){
+            pthread_join(workers[i].thread, NULL);
+            if(workers[i].result != SWORDX_OK && res == SWORDX_OK){
+                res = workers[i].result;
+            }
+            if(_counter_merge(&workers[i].counter, &ctx->counter) < 0 && res == SWORDX_OK){
+                res = SWORDX_ERROR_MEMORY;
+            }
+            trie_destroy(workers[i].counter.words);
+        }
+        free(workers);
+    }
+    if(walker_wait(job.walker) < 0 && res == SWORDX_OK){
+        res = _get_read_error();
+    }
+    walker_destroy(job.walker);
+    return res;
+}
+
+int swordx_visit(SwordxVisitor visitor, void *context, const swordx_ctx *ctx){
+    if(!visitor || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    _Visit visit = {visitor, context, 0};
+    if(trie_visit(ctx->counter.words, _visit_word, &visit) != 0){
+        return (visit.result != 0) ? SWORDX_ERROR_ABORTED : SWORDX_ERROR_MEMORY;
+    }
+    return SWORDX_OK;
+}
+
+int swordx_visit_by_occurrences(SwordxVisitor visitor, void *context, const swordx_ctx *ctx){
+    if(!visitor || !ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    _Visit visit = {visitor, context, 0};
+    if(trie_visit_by_occurrences(ctx->counter.words, _visit_word, &visit) != 0){
+        return (visit.result != 0) ? SWORDX_ERROR_ABORTED : SWORDX_ERROR_MEMORY;
+    }
+    return SWORDX_OK;
+}
+
+void swordx_get_counts(SwordxCounts *counts, const swordx_ctx *ctx){
+    assert(counts);
+    assert(ctx);
+    *counts = ctx->counter.counts;
+}
+
+int swordx_reset(swordx_ctx *ctx){
+    if(!ctx){
+        errno = EINVAL;
+        return SWORDX_ERROR_INVALID;
+    }
+    trie_destroy(ctx->counter.words);
+    return (_counter_init(&ctx->counter, &ctx->options) < 0) ? SWORDX_ERROR_MEMORY : SWORDX_OK;
+}
+
+const char *swordx_strerror(int status){
+    switch(status){
+        case SWORDX_OK: return "Success";
+        case SWORDX_ERROR_MEMORY: return "Out of memory";
+        case SWORDX_ERROR_IO: return "A file or folder cannot be read";
+        case SWORDX_ERROR_INVALID: return "Invalid argument";
+        case SWORDX_ERROR_ABORTED: return "The visit was stopped by the visitor";
+    }
+    return "Unknown error";
+}
+
+/* Private Methods */
+
+static int _count_tokens(Tokenizer *tokenizer, const swordx_ctx *ctx, _Counter *counter){
+    WordFilterCounts counts;
+    int res = wordfilter_count_tokens(tokenizer, ctx->filter, _insert_word, counter, &counts);
+    counter->counts.bytes += tokenizer_get_bytes(tokenizer);
+    counter->counts.tokens += counts.tokens;
+    counter->counts.counted_tokens += counts.counted_tokens;
+    return (res < 0) ? _get_read_error() : SWORDX_OK;
+}
+
+static int _count_file(const char *path, const swordx_ctx *ctx, _Counter *counter){
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return SWORDX_ERROR_IO;
+    }
+    Tokenizer *tokenizer = tokenizer_new(fd);
+    int res = (tokenizer) ? _count_tokens(tokenizer, ctx, counter) : SWORDX_ERROR_MEMORY;
+    tokenizer_destroy(tokenizer);
+    close(fd);
+    if(res == SWORDX_OK){
+        counter->counts.files++;
+    }
+    return res;
+}
+
+/* Legge i file finché il walker ne trova, fermandosi se un altro thread ha fallito */
+static int _count_walked_files(_Job *job, _Counter *counter){
+    const char *path;
+    while(atomic_load(&job->status) == SWORDX_OK && (path = walker_next(job->walker)) != NULL){
+        int res = _count_file(path, job->ctx, counter);
+        if(res != SWORDX_OK){
+            atomic_store(&job->status, res);
+            return res;
+        }
+    }
+    return atomic_load(&job->status);
+}
+
+static int _ignore_tokens(Tokenizer *tokenizer, swordx_ctx *ctx){
+    return (wordfilter_ignore_tokens(tokenizer, ctx->filter) < 0) ? _get_read_error() : SWORDX_OK;
+}
+
+static int _insert_word(const Token *token, void *counter){
+    if(trie_insert_n(token->word, token->length, 1, ((_Counter *) counter)->words) < 0){
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static ssize_t _memory_read(void *reader, char *buffer, size_t size){
+    _MemoryReader *memory = reader;
+    size_t available = memory->size - memory->position;
+    if(size > available){
+        size = available;
+    }
+    memcpy(buffer, memory->buffer + memory->position, size);
+    memory->position += size;
+    return size;
+}
+
+static bool _is_excluded(const char *path, uint64_t device, uint64_t inode, void *ctx){
+    return exclude_set_contains(path, device, inode, ((const swordx_ctx *) ctx)->excludes);
+}
+
+static void *_worker_run(void *worker){
+    _Worker *self = worker;
+    self->result = _count_walked_files(self->job, &self->counter);
+    return NULL;
+}
+
+static int _counter_init(_Counter *counter, const SwordxOptions *options){
+    memset(&counter->counts, 0, sizeof(SwordxCounts));
+    counter->words = (options->huge_pages) ? trie_new_huge_pages() : trie_new();
+    return (counter->words) ? 0 : -1;
+}
+
+static int _counter_merge(const _Counter *source, _Counter *destination){
+    destination->counts.files += source->counts.files;
+    destination->counts.bytes += source->counts.bytes;
+    destination->counts.tokens += source->counts.tokens;
+    destination->counts.counted_tokens += source->counts.counted_tokens;
+    return trie_merge(source->words, destination->words);
+}
+
+static int _visit_word(const char *word, int occurrences, void *visit){
+    _Visit *current = visit;
+    current->result = current->visitor(word, occurrences, current->context);
+    return (current->result != 0) ? 1 : 0;
+}
+
+/* Gli errori di lettura sono di I/O, tranne la memoria esaurita */
+static int _get_read_error(){
+    return (errno == ENOMEM) ? SWORDX_ERROR_MEMORY : SWORDX_ERROR_IO;
+}
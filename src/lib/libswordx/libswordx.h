@@ -0,0 +1,210 @@
+#ifndef LIBSWORDX_H
+#define LIBSWORDX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Libreria per contare le parole di buffer, file e cartelle,
+ * con le stesse regole di swordx. Tutto lo stato è nel contesto:
+ * contesti diversi possono essere usati in contemporanea da thread
+ * diversi, mentre un contesto va usato da un thread alla volta.
+ * Le funzioni non terminano mai il processo; gli errori sono
+ * restituiti come SwordxStatus negativi, con errno impostato.
+ */
+
+#if defined(__GNUC__)
+#define SWORDX_API __attribute__((visibility("default")))
+#else
+#define SWORDX_API
+#endif
+
+typedef struct swordx_ctx swordx_ctx;
+
+typedef enum SwordxStatus {
+    SWORDX_OK = 0,
+    /* Memoria esaurita */
+    SWORDX_ERROR_MEMORY = -1,
+    /* Un file o una cartella non possono essere letti */
+    SWORDX_ERROR_IO = -2,
+    /* Un argomento non è valido */
+    SWORDX_ERROR_INVALID = -3,
+    /* Il visitor ha interrotto la visita */
+    SWORDX_ERROR_ABORTED = -4
+} SwordxStatus;
+
+typedef struct SwordxOptions {
+    /* Visita anche le sottocartelle */
+    bool recursive;
+    /* Segue i link simbolici */
+    bool follow;
+    /* Scarta le parole che contengono cifre */
+    bool alpha;
+    /* La lunghezza minima delle parole conteggiate */
+    unsigned int minimum_word_length;
+    /* Il numero di thread che visitano e leggono le cartelle */
+    unsigned int threads;
+    /* Il Trie delle parole è allocato su huge pages, se disponibili */
+    bool huge_pages;
+} SwordxOptions;
+
+typedef struct SwordxCounts {
+    /* I file letti */
+    size_t files;
+    /* I byte letti */
+    size_t bytes;
+    /* Le parole lette */
+    size_t tokens;
+    /* Le parole conteggiate, cioè non scartate */
+    size_t counted_tokens;
+} SwordxCounts;
+
+/**
+ * @brief Funzione invocata per ogni parola conteggiata.
+ * Un valore diverso da 0 interrompe la visita.
+ */
+typedef int (*SwordxVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Imposta le opzioni predefinite: nessuna sottocartella,
+ * nessun link seguito, tutte le parole alfanumeriche, un thread
+ *
+ * @param options Le opzioni da inizializzare
+ */
+SWORDX_API void swordx_options_init(SwordxOptions *options);
+
+/**
+ * @brief Crea un contesto vuoto
+ *
+ * @param options Le opzioni, NULL per quelle predefinite
+ * @return swordx_ctx* Il puntatore al contesto creato
+ * @return NULL Failure
+ */
+SWORDX_API swordx_ctx *swordx_new(const SwordxOptions *options);
+
+/**
+ * @brief Libera la memoria riservata al contesto
+ *
+ * @param ctx Il contesto da distruggere
+ */
+SWORDX_API void swordx_destroy(swordx_ctx *ctx);
+
+/**
+ * @brief Aggiunge una parola da non conteggiare. Come le esclusioni,
+ * le parole ignorate restano valide dopo swordx_reset().
+ *
+ * @param word La parola, senza spazi
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SWORDX_ERROR_MEMORY Failure
+ */
+SWORDX_API int swordx_ignore_word(const char *word, swordx_ctx *ctx);
+
+/**
+ * @brief Aggiunge le parole da non conteggiare contenute nel file,
+ * separate da spazi o a capo
+ *
+ * @param path Il percorso del file
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_ignore_file(const char *path, swordx_ctx *ctx);
+
+/**
+ * @brief Esclude un file o una cartella, con tutto il sottoalbero,
+ * da swordx_count_path(). pattern può essere un glob.
+ *
+ * @param pattern Il percorso o il glob da escludere
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_exclude(const char *pattern, swordx_ctx *ctx);
+
+/**
+ * @brief Conta le parole di un buffer in memoria
+ *
+ * @param buffer Il testo
+ * @param size La lunghezza del testo
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SWORDX_ERROR_MEMORY Failure
+ */
+SWORDX_API int swordx_count_buffer(const char *buffer, size_t size, swordx_ctx *ctx);
+
+/**
+ * @brief Conta le parole lette da un file descriptor, fino alla
+ * fine del file. Il file descriptor non viene chiuso.
+ *
+ * @param fd Il file descriptor
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_count_fd(int fd, swordx_ctx *ctx);
+
+/**
+ * @brief Conta le parole di un file oppure, se path è una cartella,
+ * dei file che contiene, secondo le opzioni e le esclusioni.
+ * Al primo errore la visita si interrompe; le parole dei file già
+ * letti restano conteggiate.
+ *
+ * @param path Il percorso del file o della cartella
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_count_path(const char *path, swordx_ctx *ctx);
+
+/**
+ * @brief Visita in ordine alfabetico le parole conteggiate
+ *
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_visit(SwordxVisitor visitor, void *context, const swordx_ctx *ctx);
+
+/**
+ * @brief Visita le parole conteggiate in ordine decrescente di
+ * occorrenze; a parità di occorrenze in ordine alfabetico
+ *
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SwordxStatus Failure
+ */
+SWORDX_API int swordx_visit_by_occurrences(SwordxVisitor visitor, void *context, const swordx_ctx *ctx);
+
+/**
+ * @brief Restituisce i conteggi dall'ultimo swordx_reset()
+ *
+ * @param counts I conteggi in cui salvare il risultato
+ * @param ctx Il contesto
+ */
+SWORDX_API void swordx_get_counts(SwordxCounts *counts, const swordx_ctx *ctx);
+
+/**
+ * @brief Azzera le parole conteggiate, mantenendo le opzioni,
+ * le parole ignorate e le esclusioni, così che il contesto possa
+ * essere riusato per un altro lavoro
+ *
+ * @param ctx Il contesto
+ * @return SWORDX_OK Success
+ * @return SWORDX_ERROR_MEMORY Failure, il contesto non contiene parole
+ */
+SWORDX_API int swordx_reset(swordx_ctx *ctx);
+
+/**
+ * @brief Restituisce la descrizione di uno stato
+ *
+ * @param status Lo stato
+ * @return const char* La descrizione, da non liberare
+ */
+SWORDX_API const char *swordx_strerror(int status);
+
+#endif
@@ -67,6 +67,7 @@ bool list_contains(const char *value, const List *list){
     while(list_iterator_has_next(iterator)){
         list_iterator_advance(iterator);
         if(strcmp(list_iterator_get_element(iterator), value) == 0){
+            list_iterator_destroy(iterator);
             return true;
         }
     }
@@ -0,0 +1,613 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manifest.h"
+#include "../writer/writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MANIFEST_MAGIC "SWXMANF1"
+#define MAGIC_LENGTH 8
+#define WRITER_BUFFER_SIZE (1024 * 1024)
+#define HASH_BLOCK_SIZE (256 * 1024)
+#define TEMP_SUFFIX ".tmp"
+#define RECORD_ALIGNMENT 8
+
+typedef struct _Header _Header;
+typedef struct _RecordHeader _RecordHeader;
+typedef struct _WordHeader _WordHeader;
+typedef struct _PathTable _PathTable;
+
+static int _visit_words(const char *words, size_t words_count, size_t words_bytes, ManifestVisitor visitor, void *context);
+static bool _words_are_valid(const char *words, uint64_t words_count, uint64_t words_bytes);
+static const _RecordHeader *_get_record(size_t index, const Manifest *manifest);
+static int _end_record(ManifestWriter *writer);
+static int _record_append(const void *data, size_t length, ManifestWriter *writer);
+static int _write(const void *data, size_t length, ManifestWriter *writer);
+static uint64_t _hash_path(const char *path);
+static int _table_init(size_t capacity, _PathTable *table);
+static size_t _table_slot(const char *key, const _PathTable *table);
+static int _table_insert(const char *key, size_t value, _PathTable *table);
+
+typedef struct _Header {
+    char magic[MAGIC_LENGTH];
+    uint64_t settings;
+    uint64_t files_count;
+    uint64_t totals_offset;
+} _Header;
+
+/* Seguito dal percorso terminato da '\0' e da words_bytes byte di parole */
+typedef struct _RecordHeader {
+    uint64_t device;
+    uint64_t inode;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t size;
+    uint64_t hash;
+    uint64_t words_bytes;
+    uint32_t words_count;
+    uint32_t path_length;
+} _RecordHeader;
+
+/* Seguito dai length caratteri della parola, senza allineamento */
+typedef struct _WordHeader {
+    uint32_t occurrences;
+    uint32_t length;
+} _WordHeader;
+
+/* Tabella a indirizzamento aperto da percorso a posizione; le chiavi NULL sono libere */
+typedef struct _PathTable {
+    const char **keys;
+    size_t *values;
+    size_t capacity;
+    size_t count;
+} _PathTable;
+
+typedef struct Manifest {
+    const char *data;
+    size_t size;
+    uint64_t *records;
+    size_t files_count;
+    uint64_t totals_offset;
+    _PathTable paths;
+} Manifest;
+
+typedef struct ManifestWriter {
+    char *path;
+    char *temp_path;
+    int fd;
+    Writer *output;
+    uint64_t settings;
+    uint64_t position;
+    uint64_t files_count;
+    uint64_t totals_offset;
+    uint64_t totals_count;
+    bool in_totals;
+    char *record;
+    size_t record_length;
+    size_t record_capacity;
+    _PathTable claimed;
+} ManifestWriter;
+
+Manifest *manifest_open(const char *path, uint64_t settings){
+    assert(path);
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) < 0 || (size_t) info.st_size < sizeof(_Header) + sizeof(uint64_t)){
+        close(fd);
+        return NULL;
+    }
+    Manifest *manifest = calloc(1, sizeof(Manifest));
+    void *data = (manifest) ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(data == MAP_FAILED){
+        free(manifest);
+        return NULL;
+    }
+    manifest->data = data;
+    manifest->size = info.st_size;
+    _Header header;
+    memcpy(&header, data, sizeof(_Header));
+    if(memcmp(header.magic, MANIFEST_MAGIC, MAGIC_LENGTH) != 0 || header.settings != settings
+        || header.totals_offset < sizeof(_Header) || header.totals_offset > manifest->size - sizeof(uint64_t)
+        || header.files_count > header.totals_offset / sizeof(_RecordHeader)){
+        manifest_close(manifest);
+        return NULL;
+    }
+    manifest->totals_offset = header.totals_offset;
+    manifest->records = malloc((header.files_count + 1) * sizeof(uint64_t));
+    if(!manifest->records || _table_init(header.files_count, &manifest->paths) < 0){
+        manifest_close(manifest);
+        return NULL;
+    }
+    /* Verifica i limiti di ogni record, così che le letture successive non escano dal file */
+    uint64_t offset = sizeof(_Header);
+    for(size_t i = 0; i < header.files_count; i++){
+        _RecordHeader record;
+        if(offset + sizeof(_RecordHeader) > manifest->totals_offset){
+            manifest_close(manifest);
+            return NULL;
+        }
+        memcpy(&record, manifest->data + offset, sizeof(_RecordHeader));
+        uint64_t available = manifest->totals_offset - offset - sizeof(_RecordHeader);
+        if(record.path_length >= available || record.words_bytes > available - record.path_length - 1
+            || manifest->data[offset + sizeof(_RecordHeader) + record.path_length] != '\0'
+            || !_words_are_valid(manifest->data + offset + sizeof(_RecordHeader) + record.path_length + 1,
+                record.words_count, record.words_bytes)){
+            manifest_close(manifest);
+            return NULL;
+        }
+        manifest->records[i] = offset;
+        const char *record_path = manifest->data + offset + sizeof(_RecordHeader);
+        if(_table_insert(record_path, i, &manifest->paths) < 0){
+            manifest_close(manifest);
+            return NULL;
+        }
+        manifest->files_count++;
+        offset += sizeof(_RecordHeader) + record.path_length + 1 + record.words_bytes;
+        offset += (RECORD_ALIGNMENT - offset % RECORD_ALIGNMENT) % RECORD_ALIGNMENT;
+    }
+    /* I totali occupano il resto del file: un file troncato non è valido */
+    uint64_t totals_count;
+    memcpy(&totals_count, manifest->data + manifest->totals_offset, sizeof(uint64_t));
+    if(!_words_are_valid(manifest->data + manifest->totals_offset + sizeof(uint64_t), totals_count,
+        manifest->size - manifest->totals_offset - sizeof(uint64_t))){
+        manifest_close(manifest);
+        return NULL;
+    }
+    return manifest;
+}
+
+void manifest_close(Manifest *manifest){
+    if(manifest){
+        if(manifest->data){
+            munmap((void *) manifest->data, manifest->size);
+        }
+        free(manifest->records);
+        free(manifest->paths.keys);
+        free(manifest->paths.values);
+        free(manifest);
+    }
+}
+
+size_t manifest_get_files_count(const Manifest *manifest){
+    assert(manifest);
+    return manifest->files_count;
+}
+
+long manifest_find(const char *path, const Manifest *manifest){
+    assert(path);
+    assert(manifest);
+    size_t slot = _table_slot(path, &manifest->paths);
+    return (manifest->paths.keys[slot]) ? (long) manifest->paths.values[slot] : -1;
+}
+
+void manifest_get_file(size_t index, ManifestFile *file, const Manifest *manifest){
+    assert(file);
+    const _RecordHeader *pointer = _get_record(index, manifest);
+    _RecordHeader record;
+    memcpy(&record, pointer, sizeof(_RecordHeader));
+    file->path = (const char *) pointer + sizeof(_RecordHeader);
+    file->device = record.device;
+    file->inode = record.inode;
+    file->mtime_sec = record.mtime_sec;
+    file->mtime_nsec = record.mtime_nsec;
+    file->size = record.size;
+    file->hash = record.hash;
+}
+
+int manifest_visit_file_words(size_t index, ManifestVisitor visitor, void *context, const Manifest *manifest){
+    assert(visitor);
+    const _RecordHeader *pointer = _get_record(index, manifest);
+    _RecordHeader record;
+    memcpy(&record, pointer, sizeof(_RecordHeader));
+    const char *words = (const char *) pointer + sizeof(_RecordHeader) + record.path_length + 1;
+    return _visit_words(words, record.words_count, record.words_bytes, visitor, context);
+}
+
+int manifest_visit_totals(ManifestVisitor visitor, void *context, const Manifest *manifest){
+    assert(visitor);
+    assert(manifest);
+    uint64_t words_count;
+    memcpy(&words_count, manifest->data + manifest->totals_offset, sizeof(uint64_t));
+    const char *words = manifest->data + manifest->totals_offset + sizeof(uint64_t);
+    size_t words_bytes = manifest->size - manifest->totals_offset - sizeof(uint64_t);
+    return _visit_words(words, words_count, words_bytes, visitor, context);
+}
+
+int manifest_hash_fd(int fd, uint64_t *hash){
+    assert(hash);
+    char *buffer = malloc(HASH_BLOCK_SIZE);
+    if(!buffer){
+        return -1;
+    }
+    uint64_t state = 0xcbf29ce484222325u;
+    uint64_t total = 0;
+    bool eof = false;
+    while(!eof){
+        /* Solo l'ultimo blocco può non essere pieno, quindi le parole a 64 bit restano allineate */
+        size_t length = 0;
+        while(length < HASH_BLOCK_SIZE){
+            ssize_t bytes = read(fd, buffer + length, HASH_BLOCK_SIZE - length);
+            if(bytes < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                free(buffer);
+                return -1;
+            }
+            if(bytes == 0){
+                eof = true;
+                break;
+            }
+            length += bytes;
+        }
+        size_t i = 0;
+        for(; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)){
+            uint64_t word;
+            memcpy(&word, buffer + i, sizeof(uint64_t));
+            state = (state ^ word) * 0x9e3779b97f4a7c15u;
+            state ^= state >> 32;
+        }
+        for(; i < length; i++){
+            state = (state ^ (unsigned char) buffer[i]) * 0x100000001b3u;
+        }
+        total += length;
+    }
+    free(buffer);
+    state = (state ^ total) * 0x9e3779b97f4a7c15u;
+    *hash = state ^ (state >> 29);
+    return 0;
+}
+
+ManifestWriter *manifest_writer_new(const char *path, uint64_t settings){
+    assert(path);
+    ManifestWriter *writer = calloc(1, sizeof(ManifestWriter));
+    if(!writer){
+        return NULL;
+    }
+    writer->fd = -1;
+    writer->settings = settings;
+    writer->path = malloc(strlen(path) + 1);
+    writer->temp_path = malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+    if(!writer->path || !writer->temp_path || _table_init(1024, &writer->claimed) < 0){
+        manifest_writer_destroy(writer);
+        return NULL;
+    }
+    strcpy(writer->path, path);
+    sprintf(writer->temp_path, "%s%s", path, TEMP_SUFFIX);
+    writer->fd = open(writer->temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(writer->fd < 0){
+        manifest_writer_destroy(writer);
+        return NULL;
+    }
+    writer->output = writer_new(writer->fd, WRITER_BUFFER_SIZE);
+    /* L'intestazione viene riscritta alla chiusura */
+    _Header header = {{0}, 0, 0, 0};
+    if(!writer->output || _write(&header, sizeof(_Header), writer) < 0){
+        manifest_writer_destroy(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+int manifest_writer_claim(const char *path, ManifestWriter *writer){
+    assert(path);
+    assert(writer);
+    if(writer->claimed.keys[_table_slot(path, &writer->claimed)]){
+        return 0;
+    }
+    char *key = malloc(strlen(path) + 1);
+    if(!key){
+        return -1;
+    }
+    strcpy(key, path);
+    if(_table_insert(key, 0, &writer->claimed) < 0){
+        free(key);
+        return -1;
+    }
+    return 1;
+}
+
+int manifest_writer_begin_file(const ManifestFile *file, ManifestWriter *writer){
+    assert(file);
+    assert(writer);
+    assert(!writer->in_totals);
+    if(_end_record(writer) < 0){
+        return -1;
+    }
+    _RecordHeader record = {0};
+    record.device = file->device;
+    record.inode = file->inode;
+    record.mtime_sec = file->mtime_sec;
+    record.mtime_nsec = file->mtime_nsec;
+    record.size = file->size;
+    record.hash = file->hash;
+    record.path_length = strlen(file->path);
+    if(_record_append(&record, sizeof(_RecordHeader), writer) < 0){
+        return -1;
+    }
+    return _record_append(file->path, record.path_length + 1, writer);
+}
+
+int manifest_writer_copy_file(const ManifestFile *file, size_t index, const Manifest *source, ManifestWriter *writer){
+    assert(source);
+    if(manifest_writer_begin_file(file, writer) < 0){
+        return -1;
+    }
+    const _RecordHeader *pointer = _get_record(index, source);
+    _RecordHeader record;
+    memcpy(&record, pointer, sizeof(_RecordHeader));
+    const char *words = (const char *) pointer + sizeof(_RecordHeader) + record.path_length + 1;
+    if(_record_append(words, record.words_bytes, writer) < 0){
+        return -1;
+    }
+    /* Le parole copiate vengono contate da _end_record() tramite l'intestazione */
+    _RecordHeader *copy = (_RecordHeader *) writer->record;
+    copy->words_count = record.words_count;
+    return 0;
+}
+
+int manifest_writer_begin_totals(ManifestWriter *writer){
+    assert(writer);
+    assert(!writer->in_totals);
+    if(_end_record(writer) < 0){
+        return -1;
+    }
+    uint64_t words_count = 0;
+    writer->totals_offset = writer->position;
+    writer->in_totals = true;
+    return _write(&words_count, sizeof(uint64_t), writer);
+}
+
+int manifest_writer_add_word(const char *word, int occurrences, void *context){
+    ManifestWriter *writer = context;
+    assert(word);
+    assert(writer);
+    _WordHeader entry = { (uint32_t) occurrences, (uint32_t) strlen(word) };
+    if(writer->in_totals){
+        writer->totals_count++;
+        if(_write(&entry, sizeof(_WordHeader), writer) < 0){
+            return -1;
+        }
+        return _write(word, entry.length, writer);
+    }
+    assert(writer->record_length > 0);
+    if(_record_append(&entry, sizeof(_WordHeader), writer) < 0){
+        return -1;
+    }
+    ((_RecordHeader *) writer->record)->words_count++;
+    return _record_append(word, entry.length, writer);
+}
+
+int manifest_writer_close(ManifestWriter *writer){
+    assert(writer);
+    int res = 0;
+    if(!writer->in_totals){
+        res = manifest_writer_begin_totals(writer);
+    }
+    if(res == 0){
+        res = writer_flush(writer->output);
+    }
+    if(res == 0){
+        _Header header;
+        memcpy(header.magic, MANIFEST_MAGIC, MAGIC_LENGTH);
+        header.settings = writer->settings;
+        header.files_count = writer->files_count;
+        header.totals_offset = writer->totals_offset;
+        bool written = pwrite(writer->fd, &header, sizeof(_Header), 0) == sizeof(_Header)
+            && pwrite(writer->fd, &writer->totals_count, sizeof(uint64_t), writer->totals_offset) == sizeof(uint64_t);
+        res = (written) ? 0 : -1;
+    }
+    if(close(writer->fd) != 0){
+        res = -1;
+    }
+    writer->fd = -1;
+    if(res == 0){
+        res = rename(writer->temp_path, writer->path);
+    }
+    manifest_writer_destroy(writer);
+    return (res == 0) ? 0 : -1;
+}
+
+void manifest_writer_destroy(ManifestWriter *writer){
+    if(writer){
+        if(writer->fd >= 0){
+            close(writer->fd);
+        }
+        if(writer->temp_path){
+            unlink(writer->temp_path);
+        }
+        if(writer->claimed.keys){
+            for(size_t i = 0; i < writer->claimed.capacity; i++){
+                free((char *) writer->claimed.keys[i]);
+            }
+        }
+        free(writer->claimed.keys);
+        free(writer->claimed.values);
+        writer_destroy(writer->output);
+        free(writer->record);
+        free(writer->path);
+        free(writer->temp_path);
+        free(writer);
+    }
+}
+
+/* Private Methods */
+
+static int _visit_words(const char *words, size_t words_count, size_t words_bytes, ManifestVisitor visitor, void *context){
+    char *word = NULL;
+    size_t capacity = 0;
+    size_t offset = 0;
+    int res = 0;
+    for(size_t i = 0; res == 0 && i < words_count; i++){
+        _WordHeader entry;
+        if(offset + sizeof(_WordHeader) > words_bytes){
+            errno = EINVAL;
+            res = -1;
+            break;
+        }
+        memcpy(&entry, words + offset, sizeof(_WordHeader));
+        offset += sizeof(_WordHeader);
+        if(entry.length > words_bytes - offset){
+            errno = EINVAL;
+            res = -1;
+            break;
+        }
+        if(entry.length + 1 > capacity){
+            char *buffer = realloc(word, entry.length + 1);
+            if(!buffer){
+                res = -1;
+                break;
+            }
+            word = buffer;
+            capacity = entry.length + 1;
+        }
+        memcpy(word, words + offset, entry.length);
+        word[entry.length] = '\0';
+        offset += entry.length;
+        res = visitor(word, entry.occurrences, context);
+    }
+    free(word);
+    return res;
+}
+
+/* Le words_count parole devono occupare esattamente words_bytes byte */
+static bool _words_are_valid(const char *words, uint64_t words_count, uint64_t words_bytes){
+    uint64_t offset = 0;
+    for(uint64_t i = 0; i < words_count; i++){
+        _WordHeader entry;
+        if(words_bytes - offset < sizeof(_WordHeader)){
+            return false;
+        }
+        memcpy(&entry, words + offset, sizeof(_WordHeader));
+        offset += sizeof(_WordHeader);
+        if(entry.length > words_bytes - offset){
+            return false;
+        }
+        offset += entry.length;
+    }
+    return offset == words_bytes;
+}
+
+static const _RecordHeader *_get_record(size_t index, const Manifest *manifest){
+    assert(manifest);
+    assert(index < manifest->files_count);
+    return (const _RecordHeader *) (manifest->data + manifest->records[index]);
+}
+
+/* Scrive il record in costruzione, con il numero di byte delle parole e l'allineamento */
+static int _end_record(ManifestWriter *writer){
+    if(writer->record_length == 0){
+        return 0;
+    }
+    _RecordHeader *record = (_RecordHeader *) writer->record;
+    record->words_bytes = writer->record_length - sizeof(_RecordHeader) - record->path_length - 1;
+    static const char zeros[RECORD_ALIGNMENT] = {0};
+    size_t padding = (RECORD_ALIGNMENT - writer->record_length % RECORD_ALIGNMENT) % RECORD_ALIGNMENT;
+    if(_record_append(zeros, padding, writer) < 0){
+        return -1;
+    }
+    if(_write(writer->record, writer->record_length, writer) < 0){
+        return -1;
+    }
+    writer->record_length = 0;
+    writer->files_count++;
+    return 0;
+}
+
+static int _record_append(const void *data, size_t length, ManifestWriter *writer){
+    if(writer->record_length + length > writer->record_capacity){
+        size_t capacity = (writer->record_capacity == 0) ? 4096 : writer->record_capacity;
+        while(writer->record_length + length > capacity){
+            capacity *= 2;
+        }
+        char *record = realloc(writer->record, capacity);
+        if(!record){
+            return -1;
+        }
+        writer->record = record;
+        writer->record_capacity = capacity;
+    }
+    memcpy(writer->record + writer->record_length, data, length);
+    writer->record_length += length;
+    return 0;
+}
+
+static int _write(const void *data, size_t length, ManifestWriter *writer){
+    if(writer_write(data, length, writer->output) < 0){
+        return -1;
+    }
+    writer->position += length;
+    return 0;
+}
+
+static uint64_t _hash_path(const char *path){
+    uint64_t hash = 0xcbf29ce484222325u;
+    for(; *path; path++){
+        hash = (hash ^ (unsigned char) *path) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+static int _table_init(size_t capacity, _PathTable *table){
+    table->capacity = 16;
+    while(table->capacity < 2 * capacity){
+        table->capacity *= 2;
+    }
+    table->count = 0;
+    table->keys = calloc(table->capacity, sizeof(char *));
+    table->values = malloc(table->capacity * sizeof(size_t));
+    return (table->keys && table->values) ? 0 : -1;
+}
+
+static size_t _table_slot(const char *key, const _PathTable *table){
+    size_t mask = table->capacity - 1;
+    size_t slot = _hash_path(key) & mask;
+    while(table->keys[slot] && strcmp(table->keys[slot], key) != 0){
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* Le chiavi già presenti non vengono sostituite */
+static int _table_insert(const char *key, size_t value, _PathTable *table){
+    if(2 * (table->count + 1) > table->capacity){
+        _PathTable grown;
+        if(_table_init(table->capacity, &grown) < 0){
+            free(grown.keys);
+            free(grown.values);
+            return -1;
+        }
+        for(size_t i = 0; i < table->capacity; i++){
+            if(table->keys[i]){
+                size_t slot = _table_slot(table->keys[i], &grown);
+                grown.keys[slot] = table->keys[i];
+                grown.values[slot] = table->values[i];
+                grown.count++;
+            }
+        }
+        free(table->keys);
+        free(table->values);
+        *table = grown;
+    }
+    size_t slot = _table_slot(key, table);
+    if(!table->keys[slot]){
+        table->keys[slot] = key;
+        table->values[slot] = value;
+        table->count++;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Il manifest registra, per ogni file elaborato, i metadati usati
+ * per riconoscerne le modifiche e le occorrenze che il file ha
+ * aggiunto ai totali, seguiti dai totali stessi.
+ * Gli interi sono nell'ordine dei byte della macchina che scrive il file.
+ */
+
+typedef struct Manifest Manifest;
+typedef struct ManifestWriter ManifestWriter;
+
+typedef struct ManifestFile {
+    const char *path;
+    uint64_t device;
+    uint64_t inode;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t size;
+    uint64_t hash;
+} ManifestFile;
+
+/**
+ * @brief Funzione invocata per ogni parola di un elenco di occorrenze.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*ManifestVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Apre un manifest mappandolo in memoria
+ * 
+ * @param path Il percorso del manifest
+ * @param settings L'impronta delle opzioni che influenzano i conteggi
+ * @return Manifest* Il puntatore al manifest aperto
+ * @return NULL Failure, file non valido, troncato o scritto con opzioni diverse
+ */
+Manifest *manifest_open(const char *path, uint64_t settings);
+
+/**
+ * @brief Rilascia la memoria mappata e il manifest
+ * 
+ * @param manifest Il manifest da chiudere
+ */
+void manifest_close(Manifest *manifest);
+
+/**
+ * @brief Restituisce il numero di file registrati
+ * 
+ * @param manifest 
+ * @return size_t 
+ */
+size_t manifest_get_files_count(const Manifest *manifest);
+
+/**
+ * @brief Cerca un file per percorso
+ * 
+ * @param path Il percorso del file
+ * @param manifest Il manifest in cui cercare
+ * @return long La posizione del file nel manifest
+ * @return -1 Il file non è registrato
+ */
+long manifest_find(const char *path, const Manifest *manifest);
+
+/**
+ * @brief Legge i metadati del file in posizione index.
+ * Il percorso resta valido fino alla chiusura del manifest.
+ * 
+ * @param index La posizione del file
+ * @param file La struttura da riempire
+ * @param manifest Il manifest da cui leggere
+ */
+void manifest_get_file(size_t index, ManifestFile *file, const Manifest *manifest);
+
+/**
+ * @brief Visita le occorrenze aggiunte ai totali dal file
+ * in posizione index
+ * 
+ * @param index La posizione del file
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @param manifest Il manifest da cui leggere
+ * @return 0 Success
+ * @return -1 Failure, EINVAL se le parole sono troncate
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int manifest_visit_file_words(size_t index, ManifestVisitor visitor, void *context, const Manifest *manifest);
+
+/**
+ * @brief Visita i totali registrati nel manifest
+ * 
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @param manifest Il manifest da cui leggere
+ * @return 0 Success
+ * @return -1 Failure, EINVAL se le parole sono troncate
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int manifest_visit_totals(ManifestVisitor visitor, void *context, const Manifest *manifest);
+
+/**
+ * @brief Calcola l'impronta del contenuto di un file, leggendolo
+ * dalla posizione corrente fino alla fine
+ * 
+ * @param fd Il file descriptor del file
+ * @param hash L'impronta calcolata
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int manifest_hash_fd(int fd, uint64_t *hash);
+
+/**
+ * @brief Inizia la scrittura di un manifest. Il file viene
+ * scritto accanto a path e lo sostituisce solo alla chiusura.
+ * 
+ * @param path Il percorso del manifest
+ * @param settings L'impronta delle opzioni che influenzano i conteggi
+ * @return ManifestWriter* Il puntatore al writer creato
+ * @return NULL Failure
+ */
+ManifestWriter *manifest_writer_new(const char *path, uint64_t settings);
+
+/**
+ * @brief Riserva un percorso, così che ogni file
+ * venga registrato una sola volta
+ * 
+ * @param path Il percorso da riservare
+ * @param writer Il writer del manifest
+ * @return 1 Il percorso è stato riservato
+ * @return 0 Il percorso era già riservato
+ * @return -1 Failure
+ */
+int manifest_writer_claim(const char *path, ManifestWriter *writer);
+
+/**
+ * @brief Inizia la registrazione di un file: le parole aggiunte
+ * con manifest_writer_add_word() fino alla successiva chiamata
+ * sono le occorrenze del file
+ * 
+ * @param file I metadati del file
+ * @param writer Il writer del manifest
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int manifest_writer_begin_file(const ManifestFile *file, ManifestWriter *writer);
+
+/**
+ * @brief Registra un file con i metadati specificati e le
+ * occorrenze che lo stesso file ha in un manifest precedente
+ * 
+ * @param file I metadati del file
+ * @param index La posizione del file in source
+ * @param source Il manifest da cui copiare le occorrenze
+ * @param writer Il writer del manifest
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int manifest_writer_copy_file(const ManifestFile *file, size_t index, const Manifest *source, ManifestWriter *writer);
+
+/**
+ * @brief Inizia la registrazione dei totali; dopo questa
+ * chiamata non possono essere registrati altri file
+ * 
+ * @param writer Il writer del manifest
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int manifest_writer_begin_totals(ManifestWriter *writer);
+
+/**
+ * @brief Aggiunge una parola al file o ai totali in registrazione.
+ * Ha la firma di un visitor per poter essere passata a trie_visit().
+ * 
+ * @param word La parola
+ * @param occurrences Le occorrenze della parola
+ * @param writer Il writer del manifest
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int manifest_writer_add_word(const char *word, int occurrences, void *writer);
+
+/**
+ * @brief Completa il manifest e libera il writer
+ * 
+ * @param writer Il writer da chiudere
+ * @return 0 Success
+ * @return -1 Failure, il manifest precedente resta invariato
+ */
+int manifest_writer_close(ManifestWriter *writer);
+
+/**
+ * @brief Libera il writer scartando il manifest in scrittura
+ * 
+ * @param writer Il writer da distruggere
+ */
+void manifest_writer_destroy(ManifestWriter *writer);
+
+#endif
@@ -0,0 +1,503 @@
+#define _GNU_SOURCE
+
+#include "readahead.h"
+#include "../uring/uring.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define MAX_URING_ENTRIES 4096
+
+/* Operazioni io_uring, nei due bit bassi del valore associato */
+#define OP_OPEN 0
+#define OP_STAT 1
+#define OP_READ 2
+#define OP_CLOSE 3
+
+typedef struct _Slot _Slot;
+
+static void *_read_files(void *args);
+static void _read_files_uring(Uring *ring, ReadAhead *readahead);
+static _Slot *_acquire(ReadAhead *readahead, bool wait);
+static void _release_slot(_Slot *slot, ReadAhead *readahead);
+static void _enqueue(_Slot *slot, double read_seconds, ReadAhead *readahead);
+static void _fill(const char *path, _Slot *slot, size_t buffer_size);
+static int _start_uring(const char *path, _Slot *slot, Uring *ring);
+static bool _advance_uring(unsigned int op, int32_t result, _Slot *slot, Uring *ring, size_t buffer_size);
+static double _now();
+
+/*
+ * Ogni buffer contiene l'inizio di un solo file: un file più grande
+ * del buffer viene lasciato aperto e il consumatore prosegue la
+ * lettura, aiutato da POSIX_FADV_WILLNEED. Così un consumatore non
+ * attende mai un lettore a metà di un file e i lettori attendono
+ * solo i buffer liberi, senza possibilità di stallo.
+ * I buffer liberi formano una pila, quelli pronti una coda circolare.
+ */
+typedef struct ReadAhead {
+    ReadAheadOptions options;
+    ReadAheadSource source;
+    void *context;
+    _Slot *slots;
+    size_t *free_slots;
+    size_t free_count;
+    size_t *ready_slots;
+    size_t ready_head;
+    size_t ready_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t slot_free;
+    pthread_cond_t file_ready;
+    pthread_t *threads;
+    unsigned int started;
+    unsigned int running;
+    bool stopping;
+    ReadAheadStats stats;
+} ReadAhead;
+
+/*
+ * file deve essere il primo campo, per risalire al buffer da ReadAheadFile*.
+ * Gli ultimi campi descrivono le operazioni io_uring in corso.
+ */
+typedef struct _Slot {
+    ReadAheadFile file;
+    char *buffer;
+    size_t length;
+    size_t position;
+    int fd;
+    size_t index;
+    Uring *ring;
+    unsigned int pending;
+    size_t size;
+    bool eof;
+    double begin;
+#ifdef HAVE_IO_URING
+    struct statx stat;
+#endif
+} _Slot;
+
+ReadAhead *readahead_new(const ReadAheadOptions *options, ReadAheadSource source, void *context){
+    assert(options);
+    assert(options->readers > 0 && options->depth > 0 && options->buffer_size > 0);
+    assert(source);
+    ReadAhead *readahead = calloc(1, sizeof(ReadAhead));
+    if(!readahead){
+        return NULL;
+    }
+    readahead->options = *options;
+    readahead->source = source;
+    readahead->context = context;
+    pthread_mutex_init(&readahead->mutex, NULL);
+    pthread_cond_init(&readahead->slot_free, NULL);
+    pthread_cond_init(&readahead->file_ready, NULL);
+    readahead->slots = calloc(options->depth, sizeof(_Slot));
+    readahead->free_slots = malloc(options->depth * sizeof(size_t));
+    readahead->ready_slots = malloc(options->depth * sizeof(size_t));
+    readahead->threads = malloc(options->readers * sizeof(pthread_t));
+    if(!readahead->slots || !readahead->free_slots || !readahead->ready_slots || !readahead->threads){
+        readahead_destroy(readahead);
+        return NULL;
+    }
+    for(size_t i = 0; i < options->depth; i++){
+        _Slot *slot = &readahead->slots[i];
+        slot->fd = -1;
+        slot->index = i;
+        /* Le pagine dei buffer vengono occupate solo quando servono */
+        slot->buffer = malloc(options->buffer_size);
+        if(!slot->buffer){
+            readahead_destroy(readahead);
+            return NULL;
+        }
+        readahead->free_slots[readahead->free_count++] = options->depth - 1 - i;
+    }
+    return readahead;
+}
+
+void readahead_destroy(ReadAhead *readahead){
+    if(readahead){
+        pthread_mutex_lock(&readahead->mutex);
+        readahead->stopping = true;
+        pthread_cond_broadcast(&readahead->slot_free);
+        pthread_mutex_unlock(&readahead->mutex);
+        for(unsigned int i = 0; i < readahead->started; i++){
+            pthread_join(readahead->threads[i], NULL);
+        }
+        if(readahead->slots){
+            for(size_t i = 0; i < readahead->options.depth; i++){
+                if(readahead->slots[i].fd >= 0){
+                    close(readahead->slots[i].fd);
+                }
+                free(readahead->slots[i].buffer);
+            }
+        }
+        pthread_cond_destroy(&readahead->file_ready);
+        pthread_cond_destroy(&readahead->slot_free);
+        pthread_mutex_destroy(&readahead->mutex);
+        free(readahead->slots);
+        free(readahead->free_slots);
+        free(readahead->ready_slots);
+        free(readahead->threads);
+        free(readahead);
+    }
+}
+
+int readahead_start(ReadAhead *readahead){
+    assert(readahead);
+    pthread_mutex_lock(&readahead->mutex);
+    readahead->running = readahead->options.readers;
+    pthread_mutex_unlock(&readahead->mutex);
+    for(; readahead->started < readahead->options.readers; readahead->started++){
+        if(pthread_create(&readahead->threads[readahead->started], NULL, _read_files, readahead) != 0){
+            break;
+        }
+    }
+    pthread_mutex_lock(&readahead->mutex);
+    readahead->running -= readahead->options.readers - readahead->started;
+    pthread_cond_broadcast(&readahead->file_ready);
+    pthread_mutex_unlock(&readahead->mutex);
+    return (readahead->started > 0) ? 0 : -1;
+}
+
+ReadAheadFile *readahead_next(ReadAhead *readahead){
+    assert(readahead);
+    ReadAheadFile *file = NULL;
+    double begin = _now();
+    pthread_mutex_lock(&readahead->mutex);
+    while(readahead->ready_count == 0 && readahead->running > 0){
+        pthread_cond_wait(&readahead->file_ready, &readahead->mutex);
+    }
+    double wait = _now() - begin;
+    readahead->stats.wait_seconds += wait;
+    if(readahead->ready_count > 0){
+        size_t index = readahead->ready_slots[readahead->ready_head];
+        readahead->ready_head = (readahead->ready_head + 1) % readahead->options.depth;
+        readahead->ready_count--;
+        file = &readahead->slots[index].file;
+        file->wait_seconds = wait;
+    }
+    pthread_mutex_unlock(&readahead->mutex);
+    return file;
+}
+
+ssize_t readahead_read(void *file, char *buffer, size_t size){
+    assert(file);
+    assert(buffer);
+    _Slot *slot = file;
+    ssize_t res = 0;
+    if(slot->position < slot->length){
+        res = slot->length - slot->position;
+        if((size_t) res > size){
+            res = size;
+        }
+        memcpy(buffer, slot->buffer + slot->position, res);
+        slot->position += res;
+    } else if(slot->fd >= 0){
+        do{
+            res = read(slot->fd, buffer, size);
+        }while(res < 0 && errno == EINTR);
+    }
+    if(res > 0){
+        slot->file.bytes += res;
+    }
+    return res;
+}
+
+int readahead_get_fd(const ReadAheadFile *file){
+    assert(file);
+    return ((const _Slot *) file)->fd;
+}
+
+void readahead_release(ReadAheadFile *file, ReadAhead *readahead){
+    assert(file);
+    assert(readahead);
+    _Slot *slot = (_Slot *) file;
+    if(slot->fd >= 0){
+        close(slot->fd);
+        slot->fd = -1;
+    }
+    _release_slot(slot, readahead);
+}
+
+void readahead_get_stats(ReadAhead *readahead, ReadAheadStats *stats){
+    assert(readahead);
+    assert(stats);
+    pthread_mutex_lock(&readahead->mutex);
+    *stats = readahead->stats;
+    pthread_mutex_unlock(&readahead->mutex);
+}
+
+/* Private Methods */
+
+static void *_read_files(void *args){
+    ReadAhead *readahead = args;
+    Uring *ring = NULL;
+    if(readahead->options.io_uring){
+        /* Senza io_uring nel kernel si ripiega su read() */
+        unsigned int entries = (2 * readahead->options.depth < MAX_URING_ENTRIES) ? 2 * readahead->options.depth : MAX_URING_ENTRIES;
+        ring = uring_new(entries);
+    }
+    if(ring){
+        pthread_mutex_lock(&readahead->mutex);
+        readahead->stats.io_uring = true;
+        pthread_mutex_unlock(&readahead->mutex);
+        _read_files_uring(ring, readahead);
+        uring_destroy(ring);
+    } else {
+        _Slot *slot;
+        while( (slot = _acquire(readahead, true)) != NULL){
+            const char *path = readahead->source(readahead->context);
+            if(!path){
+                _release_slot(slot, readahead);
+                break;
+            }
+            _fill(path, slot, readahead->options.buffer_size);
+            _enqueue(slot, slot->file.read_seconds, readahead);
+        }
+    }
+    pthread_mutex_lock(&readahead->mutex);
+    readahead->running--;
+    if(readahead->running == 0){
+        pthread_cond_broadcast(&readahead->file_ready);
+    }
+    pthread_mutex_unlock(&readahead->mutex);
+    return NULL;
+}
+
+/*
+ * Con io_uring un thread tiene in lettura tutti i buffer che riesce
+ * a occupare: apertura e statx di un file vengono sottomesse insieme,
+ * poi la lettura della dimensione nota e la chiusura, e ogni chiamata
+ * al kernel fa avanzare tutti i file in corso. Si attende un buffer
+ * libero solo quando non ci sono file in corso.
+ */
+static void _read_files_uring(Uring *ring, ReadAhead *readahead){
+    size_t in_flight = 0, max_in_flight = MAX_URING_ENTRIES / 2;
+    bool exhausted = false;
+    for(;;){
+        _Slot *slot;
+        while(!exhausted && in_flight < max_in_flight && (slot = _acquire(readahead, in_flight == 0)) != NULL){
+            const char *path = readahead->source(readahead->context);
+            if(!path){
+                exhausted = true;
+                _release_slot(slot, readahead);
+                break;
+            }
+            if(_start_uring(path, slot, ring) < 0){
+                _enqueue(slot, 0, readahead);
+            } else {
+                in_flight++;
+            }
+        }
+        if(in_flight == 0){
+            break;
+        }
+        double begin = _now();
+        if(uring_submit(1, ring) < 0 && errno != EAGAIN && errno != EBUSY){
+            /* La coda non è più utilizzabile: i file in corso vengono consegnati con l'errore */
+            int error = errno;
+            for(size_t i = 0; i < readahead->options.depth; i++){
+                _Slot *failed = &readahead->slots[i];
+                if(failed->ring == ring && failed->pending > 0){
+                    failed->pending = 0;
+                    failed->file.error = error;
+                    _enqueue(failed, 0, readahead);
+                }
+            }
+            break;
+        }
+        UringCompletion completion;
+        while(uring_next_completion(&completion, ring)){
+            slot = &readahead->slots[completion.data >> 2];
+            if(_advance_uring(completion.data & 3, completion.result, slot, ring, readahead->options.buffer_size)){
+                in_flight--;
+                _enqueue(slot, 0, readahead);
+            }
+        }
+        pthread_mutex_lock(&readahead->mutex);
+        readahead->stats.read_seconds += _now() - begin;
+        pthread_mutex_unlock(&readahead->mutex);
+    }
+}
+
+/* Restituisce un buffer libero, NULL se la pipeline si ferma o se non si deve attendere */
+static _Slot *_acquire(ReadAhead *readahead, bool wait){
+    _Slot *slot = NULL;
+    double begin = _now();
+    pthread_mutex_lock(&readahead->mutex);
+    while(wait && readahead->free_count == 0 && !readahead->stopping){
+        pthread_cond_wait(&readahead->slot_free, &readahead->mutex);
+    }
+    readahead->stats.stall_seconds += _now() - begin;
+    if(!readahead->stopping && readahead->free_count > 0){
+        slot = &readahead->slots[readahead->free_slots[--readahead->free_count]];
+    }
+    pthread_mutex_unlock(&readahead->mutex);
+    return slot;
+}
+
+static void _release_slot(_Slot *slot, ReadAhead *readahead){
+    pthread_mutex_lock(&readahead->mutex);
+    readahead->free_slots[readahead->free_count++] = slot->index;
+    pthread_cond_signal(&readahead->slot_free);
+    pthread_mutex_unlock(&readahead->mutex);
+}
+
+static void _enqueue(_Slot *slot, double read_seconds, ReadAhead *readahead){
+    pthread_mutex_lock(&readahead->mutex);
+    size_t tail = (readahead->ready_head + readahead->ready_count) % readahead->options.depth;
+    readahead->ready_slots[tail] = slot->index;
+    readahead->ready_count++;
+    readahead->stats.files++;
+    readahead->stats.bytes += slot->length;
+    readahead->stats.read_seconds += read_seconds;
+    pthread_cond_signal(&readahead->file_ready);
+    pthread_mutex_unlock(&readahead->mutex);
+}
+
+/* Apre il file e ne legge l'inizio; gli errori vengono consegnati al consumatore */
+static void _fill(const char *path, _Slot *slot, size_t buffer_size){
+    double begin = _now();
+    slot->file = (ReadAheadFile) {path, 0, 0, 0, 0};
+    slot->length = 0;
+    slot->position = 0;
+    slot->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(slot->fd < 0){
+        slot->file.error = errno;
+        slot->file.read_seconds = _now() - begin;
+        return;
+    }
+    posix_fadvise(slot->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    bool eof = false;
+    while(slot->length < buffer_size){
+        ssize_t res = read(slot->fd, slot->buffer + slot->length, buffer_size - slot->length);
+        if(res < 0 && errno == EINTR){
+            continue;
+        }
+        if(res < 0){
+            slot->file.error = errno;
+            break;
+        }
+        if(res == 0){
+            eof = true;
+            break;
+        }
+        slot->length += res;
+    }
+    if(eof || slot->file.error){
+        close(slot->fd);
+        slot->fd = -1;
+    } else {
+        /* Il resto del file viene letto dal kernel mentre il file è in coda */
+        posix_fadvise(slot->fd, slot->length, 0, POSIX_FADV_WILLNEED);
+    }
+    slot->file.read_seconds = _now() - begin;
+}
+
+#ifdef HAVE_IO_URING
+
+static int _start_uring(const char *path, _Slot *slot, Uring *ring){
+    slot->file = (ReadAheadFile) {path, 0, 0, 0, 0};
+    slot->length = 0;
+    slot->position = 0;
+    slot->fd = -1;
+    slot->ring = ring;
+    slot->size = SIZE_MAX;
+    slot->eof = false;
+    slot->begin = _now();
+    uint64_t data = (uint64_t) slot->index << 2;
+    if(uring_openat(path, O_RDONLY | O_CLOEXEC, data | OP_OPEN, ring) < 0){
+        slot->file.error = EBUSY;
+        return -1;
+    }
+    slot->pending = 1;
+    /* Senza la dimensione il file viene letto finché il buffer non è pieno */
+    if(uring_statx(path, STATX_SIZE, &slot->stat, data | OP_STAT, ring) == 0){
+        slot->pending++;
+    }
+    return 0;
+}
+
+/* Registra il completamento e accoda l'operazione successiva; true se il file è pronto */
+static bool _advance_uring(unsigned int op, int32_t result, _Slot *slot, Uring *ring, size_t buffer_size){
+    slot->pending--;
+    switch(op){
+        case OP_OPEN:
+            if(result < 0){
+                slot->file.error = -result;
+            } else {
+                slot->fd = result;
+            }
+            break;
+        case OP_STAT:
+            if(result == 0){
+                slot->size = slot->stat.stx_size;
+            }
+            break;
+        case OP_READ:
+            if(result < 0){
+                slot->file.error = -result;
+            } else if(result == 0){
+                slot->eof = true;
+            } else {
+                slot->length += result;
+            }
+            break;
+    }
+    if(slot->pending > 0){
+        return false;
+    }
+    uint64_t data = (uint64_t) slot->index << 2;
+    size_t limit = (slot->size < buffer_size) ? slot->size : buffer_size;
+    if(slot->fd >= 0 && !slot->file.error && !slot->eof && slot->length < limit){
+        if(uring_read(slot->fd, slot->buffer + slot->length, limit - slot->length, slot->length, data | OP_READ, ring) == 0){
+            slot->pending++;
+            return false;
+        }
+        slot->file.error = EBUSY;
+    }
+    if(slot->fd >= 0 && (slot->file.error || slot->eof || slot->length >= slot->size)){
+        int fd = slot->fd;
+        slot->fd = -1;
+        if(uring_close(fd, data | OP_CLOSE, ring) == 0){
+            slot->pending++;
+            return false;
+        }
+        close(fd);
+    }
+    if(slot->fd >= 0){
+        /* Le letture di io_uring non spostano la posizione, da cui proseguirà il consumatore */
+        if(lseek(slot->fd, slot->length, SEEK_SET) < 0){
+            slot->file.error = errno;
+        }
+        posix_fadvise(slot->fd, slot->length, 0, POSIX_FADV_WILLNEED);
+    }
+    slot->file.read_seconds = _now() - slot->begin;
+    return true;
+}
+
+#else
+
+static int _start_uring(const char *path, _Slot *slot, Uring *ring){
+    slot->file = (ReadAheadFile) {path, ENOSYS, 0, 0, 0};
+    return -1;
+}
+
+static bool _advance_uring(unsigned int op, int32_t result, _Slot *slot, Uring *ring, size_t buffer_size){
+    return true;
+}
+
+#endif
+
+static double _now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
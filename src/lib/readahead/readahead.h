@@ -0,0 +1,143 @@
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+typedef struct ReadAhead ReadAhead;
+
+/**
+ * @brief Funzione da cui i lettori ottengono il prossimo file
+ * da leggere, NULL quando i file sono terminati. Il percorso
+ * deve restare valido fino alla distruzione della pipeline.
+ * Viene invocata in contemporanea da più thread.
+ */
+typedef const char *(*ReadAheadSource)(void *context);
+
+typedef struct ReadAheadOptions {
+    /* Il numero di thread che leggono i file */
+    unsigned int readers;
+    /* Il numero di buffer, cioè di file letti in anticipo */
+    size_t depth;
+    /* La dimensione di ogni buffer */
+    size_t buffer_size;
+    /* I lettori usano io_uring, se disponibile, invece di read() */
+    bool io_uring;
+} ReadAheadOptions;
+
+/**
+ * Un file letto in anticipo. I primi buffer_size byte sono già
+ * in memoria, il resto viene letto da readahead_read().
+ */
+typedef struct ReadAheadFile {
+    /* Il percorso del file, restituito dalla funzione dei file */
+    const char *path;
+    /* 0, oppure l'errno dell'apertura o della lettura anticipata */
+    int error;
+    /* I byte restituiti finora da readahead_read() */
+    size_t bytes;
+    /* Il tempo impiegato dal lettore per aprire e leggere il file */
+    double read_seconds;
+    /* Il tempo atteso dal consumatore prima che il file fosse pronto */
+    double wait_seconds;
+} ReadAheadFile;
+
+typedef struct ReadAheadStats {
+    /* I file letti */
+    size_t files;
+    /* I byte letti in anticipo dai lettori */
+    size_t bytes;
+    /* La somma dei tempi in cui i lettori hanno aperto e letto i file */
+    double read_seconds;
+    /* La somma dei tempi in cui i lettori hanno atteso un buffer libero */
+    double stall_seconds;
+    /* La somma dei tempi in cui i consumatori hanno atteso un file */
+    double wait_seconds;
+    /* I file sono stati letti con io_uring */
+    bool io_uring;
+} ReadAheadStats;
+
+/**
+ * @brief Crea una pipeline in cui i lettori riempiono un insieme
+ * limitato di buffer con i file ottenuti da source, mentre i
+ * consumatori elaborano i file già letti. I lettori si fermano
+ * quando tutti i buffer sono occupati.
+ *
+ * @param options Le opzioni della pipeline
+ * @param source La funzione da cui ottenere i file
+ * @param context Il contesto passato a source
+ * @return ReadAhead* Il puntatore alla pipeline creata
+ * @return NULL Failure
+ */
+ReadAhead *readahead_new(const ReadAheadOptions *options, ReadAheadSource source, void *context);
+
+/**
+ * @brief Ferma i lettori e libera la memoria riservata alla
+ * pipeline. I file non ancora rilasciati non sono più validi.
+ *
+ * @param readahead La pipeline da distruggere
+ */
+void readahead_destroy(ReadAhead *readahead);
+
+/**
+ * @brief Avvia i thread lettori
+ *
+ * @param readahead La pipeline da avviare
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int readahead_start(ReadAhead *readahead);
+
+/**
+ * @brief Restituisce il prossimo file letto, attendendo se
+ * i lettori non hanno terminato. Può essere invocata da più
+ * thread; ogni file va rilasciato con readahead_release().
+ *
+ * @param readahead La pipeline da cui leggere
+ * @return ReadAheadFile* Il file letto
+ * @return NULL I file sono terminati
+ */
+ReadAheadFile *readahead_next(ReadAhead *readahead);
+
+/**
+ * @brief Legge il contenuto del file, prima dal buffer e poi
+ * dal file stesso. Ha la semantica di read() e la firma di
+ * TokenizerRead, con il file come contesto.
+ *
+ * @param file Il file da leggere, di tipo ReadAheadFile*
+ * @param buffer Il buffer in cui copiare i byte letti
+ * @param size La dimensione del buffer
+ * @return ssize_t Il numero di byte letti, 0 alla fine del file
+ * @return -1 Failure
+ */
+ssize_t readahead_read(void *file, char *buffer, size_t size);
+
+/**
+ * @brief Restituisce il file descriptor da cui readahead_read()
+ * leggerà il resto del file, valido fino a readahead_release()
+ *
+ * @param file Il file letto
+ * @return int Il file descriptor
+ * @return -1 Il file è già stato letto per intero
+ */
+int readahead_get_fd(const ReadAheadFile *file);
+
+/**
+ * @brief Chiude il file e rende di nuovo disponibile il suo
+ * buffer ai lettori
+ *
+ * @param file Il file da rilasciare
+ * @param readahead La pipeline da cui è stato ottenuto il file
+ */
+void readahead_release(ReadAheadFile *file, ReadAhead *readahead);
+
+/**
+ * @brief Restituisce le statistiche della pipeline
+ *
+ * @param readahead La pipeline
+ * @param stats Le statistiche in cui salvare il risultato
+ */
+void readahead_get_stats(ReadAhead *readahead, ReadAheadStats *stats);
+
+#endif
@@ -0,0 +1,450 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "runfile.h"
+#include "../writer/writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define RUNFILE_MAGIC "SWXRUN01"
+#define MAGIC_LENGTH 8
+#define WRITER_BUFFER_SIZE (256 * 1024)
+#define READER_BUFFER_SIZE (64 * 1024)
+#define TEMP_SUFFIX ".tmp"
+
+typedef struct _Header _Header;
+typedef struct _Entry _Entry;
+typedef struct _Cursor _Cursor;
+
+static int _compare(RunOrder order, const char *word, int occurrences, const char *other_word, int other_occurrences);
+static int _read_exactly(void *destination, size_t length, RunReader *reader);
+static int _cursor_advance(_Cursor *cursor);
+static void _heap_sift_down(_Cursor *heap, size_t count, size_t index, RunOrder order);
+static int _copy_word(const char *word, char **buffer, size_t *capacity);
+
+typedef struct _Header {
+    char magic[MAGIC_LENGTH];
+    uint32_t order;
+    uint32_t reserved;
+    uint64_t words_count;
+} _Header;
+
+/* Ogni parola è preceduta dalle occorrenze e dalla lunghezza, senza '\0' */
+typedef struct _Entry {
+    uint32_t occurrences;
+    uint32_t length;
+} _Entry;
+
+typedef struct RunWriter {
+    char *path;
+    char *temp_path;
+    int fd;
+    Writer *output;
+    RunOrder order;
+    uint64_t words_count;
+    char *last_word;
+    size_t last_capacity;
+    int last_occurrences;
+} RunWriter;
+
+typedef struct RunReader {
+    int fd;
+    RunOrder order;
+    uint64_t words_count;
+    uint64_t words_read;
+    char *buffer;
+    size_t position;
+    size_t length;
+    char *word;
+    size_t word_capacity;
+} RunReader;
+
+/* Parola corrente di un file durante runfile_merge() */
+typedef struct _Cursor {
+    RunReader *reader;
+    const char *word;
+    int occurrences;
+} _Cursor;
+
+/*
+ * I file sono in un heap ordinato per la loro parola corrente: la
+ * radice è la prossima parola da visitare. In ordine alfabetico le
+ * parole uguali vengono estratte una dopo l'altra e sommate.
+ */
+typedef struct RunMerge {
+    _Cursor *heap;
+    size_t count;
+    RunOrder order;
+    char *word;
+    size_t capacity;
+} RunMerge;
+
+RunWriter *runfile_writer_new(const char *path, RunOrder order){
+    assert(path);
+    RunWriter *writer = calloc(1, sizeof(RunWriter));
+    if(!writer){
+        return NULL;
+    }
+    writer->fd = -1;
+    writer->order = order;
+    writer->path = malloc(strlen(path) + 1);
+    writer->temp_path = malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+    if(!writer->path || !writer->temp_path){
+        runfile_writer_destroy(writer);
+        return NULL;
+    }
+    strcpy(writer->path, path);
+    sprintf(writer->temp_path, "%s%s", path, TEMP_SUFFIX);
+    writer->fd = open(writer->temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(writer->fd < 0){
+        runfile_writer_destroy(writer);
+        return NULL;
+    }
+    writer->output = writer_new(writer->fd, WRITER_BUFFER_SIZE);
+    /* L'intestazione viene riscritta alla chiusura */
+    _Header header = {{0}, 0, 0, 0};
+    if(!writer->output || writer_write((const char *) &header, sizeof(_Header), writer->output) < 0){
+        runfile_writer_destroy(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+int runfile_writer_add(const char *word, int occurrences, void *writer){
+    assert(word);
+    assert(writer);
+    RunWriter *run = writer;
+    size_t length = strlen(word);
+    if(run->words_count > 0 && _compare(run->order, run->last_word, run->last_occurrences, word, occurrences) >= 0){
+        errno = EINVAL;
+        return -1;
+    }
+    if(_copy_word(word, &run->last_word, &run->last_capacity) < 0){
+        return -1;
+    }
+    run->last_occurrences = occurrences;
+    _Entry entry = {(uint32_t) occurrences, (uint32_t) length};
+    if(writer_write((const char *) &entry, sizeof(_Entry), run->output) < 0 || writer_write(word, length, run->output) < 0){
+        return -1;
+    }
+    run->words_count++;
+    return 0;
+}
+
+int runfile_writer_close(RunWriter *writer){
+    assert(writer);
+    int res = writer_flush(writer->output);
+    if(res == 0){
+        _Header header;
+        memcpy(header.magic, RUNFILE_MAGIC, MAGIC_LENGTH);
+        header.order = writer->order;
+        header.reserved = 0;
+        header.words_count = writer->words_count;
+        res = (pwrite(writer->fd, &header, sizeof(_Header), 0) == sizeof(_Header)) ? 0 : -1;
+    }
+    if(close(writer->fd) != 0){
+        res = -1;
+    }
+    writer->fd = -1;
+    if(res == 0){
+        res = rename(writer->temp_path, writer->path);
+    }
+    runfile_writer_destroy(writer);
+    return (res == 0) ? 0 : -1;
+}
+
+void runfile_writer_destroy(RunWriter *writer){
+    if(writer){
+        if(writer->fd >= 0){
+            close(writer->fd);
+        }
+        if(writer->temp_path){
+            unlink(writer->temp_path);
+        }
+        writer_destroy(writer->output);
+        free(writer->last_word);
+        free(writer->path);
+        free(writer->temp_path);
+        free(writer);
+    }
+}
+
+RunReader *runfile_reader_open(const char *path){
+    assert(path);
+    RunReader *reader = calloc(1, sizeof(RunReader));
+    if(!reader){
+        return NULL;
+    }
+    reader->buffer = malloc(READER_BUFFER_SIZE);
+    reader->fd = open(path, O_RDONLY);
+    if(!reader->buffer || reader->fd < 0){
+        runfile_reader_close(reader);
+        return NULL;
+    }
+    _Header header;
+    if(_read_exactly(&header, sizeof(_Header), reader) < 0){
+        runfile_reader_close(reader);
+        return NULL;
+    }
+    if(memcmp(header.magic, RUNFILE_MAGIC, MAGIC_LENGTH) != 0 || header.order > RUNFILE_BY_OCCURRENCES){
+        runfile_reader_close(reader);
+        errno = EINVAL;
+        return NULL;
+    }
+    reader->order = header.order;
+    reader->words_count = header.words_count;
+    return reader;
+}
+
+void runfile_reader_close(RunReader *reader){
+    if(reader){
+        if(reader->fd >= 0){
+            close(reader->fd);
+        }
+        free(reader->buffer);
+        free(reader->word);
+        free(reader);
+    }
+}
+
+RunOrder runfile_reader_get_order(const RunReader *reader){
+    assert(reader);
+    return reader->order;
+}
+
+size_t runfile_reader_get_words_count(const RunReader *reader){
+    assert(reader);
+    return reader->words_count;
+}
+
+int runfile_reader_next(const char **word, int *occurrences, RunReader *reader){
+    assert(word);
+    assert(occurrences);
+    assert(reader);
+    if(reader->words_read == reader->words_count){
+        return 0;
+    }
+    _Entry entry;
+    if(_read_exactly(&entry, sizeof(_Entry), reader) < 0){
+        return -1;
+    }
+    if(entry.occurrences > INT_MAX){
+        errno = EINVAL;
+        return -1;
+    }
+    if((size_t) entry.length + 1 > reader->word_capacity){
+        size_t capacity = (reader->word_capacity) ? reader->word_capacity : 64;
+        while(capacity < (size_t) entry.length + 1){
+            capacity *= 2;
+        }
+        char *resized = realloc(reader->word, capacity);
+        if(!resized){
+            return -1;
+        }
+        reader->word = resized;
+        reader->word_capacity = capacity;
+    }
+    if(_read_exactly(reader->word, entry.length, reader) < 0){
+        return -1;
+    }
+    reader->word[entry.length] = '\0';
+    reader->words_read++;
+    *word = reader->word;
+    *occurrences = (int) entry.occurrences;
+    return 1;
+}
+
+int runfile_merge(const char *const paths[], size_t count, RunVisitor visitor, void *context){
+    assert(visitor);
+    RunMerge *merge = runfile_merge_open(paths, count);
+    if(!merge){
+        return -1;
+    }
+    const char *word;
+    int occurrences;
+    int next = 0;
+    int res = 0;
+    while(res == 0 && (next = runfile_merge_next(&word, &occurrences, merge)) > 0){
+        res = visitor(word, occurrences, context);
+    }
+    if(res == 0 && next < 0){
+        res = -1;
+    }
+    runfile_merge_close(merge);
+    return res;
+}
+
+RunMerge *runfile_merge_open(const char *const paths[], size_t count){
+    assert(paths || count == 0);
+    RunMerge *merge = calloc(1, sizeof(RunMerge));
+    if(!merge){
+        return NULL;
+    }
+    merge->heap = calloc(count + 1, sizeof(_Cursor));
+    if(!merge->heap){
+        free(merge);
+        return NULL;
+    }
+    merge->order = RUNFILE_BY_WORD;
+    for(size_t i = 0; i < count; i++){
+        RunReader *reader = runfile_reader_open(paths[i]);
+        if(!reader){
+            runfile_merge_close(merge);
+            return NULL;
+        }
+        if(i == 0){
+            merge->order = reader->order;
+        }
+        merge->heap[merge->count].reader = reader;
+        if(reader->order != merge->order){
+            merge->count++;
+            runfile_merge_close(merge);
+            errno = EINVAL;
+            return NULL;
+        }
+        int next = _cursor_advance(&merge->heap[merge->count]);
+        if(next < 0){
+            merge->count++;
+            runfile_merge_close(merge);
+            return NULL;
+        }
+        if(next == 0){
+            runfile_reader_close(reader);
+        } else {
+            merge->count++;
+        }
+    }
+    for(size_t i = merge->count; i-- > 0;){
+        _heap_sift_down(merge->heap, merge->count, i, merge->order);
+    }
+    return merge;
+}
+
+int runfile_merge_next(const char **word, int *occurrences, RunMerge *merge){
+    assert(word);
+    assert(occurrences);
+    assert(merge);
+    _Cursor *heap = merge->heap;
+    if(merge->count == 0){
+        return 0;
+    }
+    if(_copy_word(heap[0].word, &merge->word, &merge->capacity) < 0){
+        return -1;
+    }
+    int sum = 0;
+    do{
+        if(heap[0].occurrences > INT_MAX - sum){
+            errno = EOVERFLOW;
+            return -1;
+        }
+        sum += heap[0].occurrences;
+        int next = _cursor_advance(&heap[0]);
+        if(next < 0){
+            return -1;
+        }
+        if(next == 0){
+            runfile_reader_close(heap[0].reader);
+            heap[0] = heap[--merge->count];
+        }
+        _heap_sift_down(heap, merge->count, 0, merge->order);
+    }while(merge->order == RUNFILE_BY_WORD && merge->count > 0 && strcmp(heap[0].word, merge->word) == 0);
+    *word = merge->word;
+    *occurrences = sum;
+    return 1;
+}
+
+void runfile_merge_close(RunMerge *merge){
+    if(merge){
+        for(size_t i = 0; i < merge->count; i++){
+            runfile_reader_close(merge->heap[i].reader);
+        }
+        free(merge->heap);
+        free(merge->word);
+        free(merge);
+    }
+}
+
+/* Private Methods */
+
+/* Negativo se la prima parola viene prima della seconda nell'ordine indicato */
+static int _compare(RunOrder order, const char *word, int occurrences, const char *other_word, int other_occurrences){
+    if(order == RUNFILE_BY_OCCURRENCES && occurrences != other_occurrences){
+        return (occurrences > other_occurrences) ? -1 : 1;
+    }
+    return strcmp(word, other_word);
+}
+
+static int _read_exactly(void *destination, size_t length, RunReader *reader){
+    char *target = destination;
+    while(length > 0){
+        if(reader->position == reader->length){
+            ssize_t res = read(reader->fd, reader->buffer, READER_BUFFER_SIZE);
+            if(res < 0 && errno == EINTR){
+                continue;
+            }
+            if(res <= 0){
+                if(res == 0){
+                    errno = EINVAL;
+                }
+                return -1;
+            }
+            reader->position = 0;
+            reader->length = res;
+        }
+        size_t available = reader->length - reader->position;
+        size_t chunk = (available < length) ? available : length;
+        memcpy(target, reader->buffer + reader->position, chunk);
+        reader->position += chunk;
+        target += chunk;
+        length -= chunk;
+    }
+    return 0;
+}
+
+static int _cursor_advance(_Cursor *cursor){
+    return runfile_reader_next(&cursor->word, &cursor->occurrences, cursor->reader);
+}
+
+static void _heap_sift_down(_Cursor *heap, size_t count, size_t index, RunOrder order){
+    for(;;){
+        size_t smallest = index;
+        for(size_t child = 2 * index + 1; child <= 2 * index + 2 && child < count; child++){
+            if(_compare(order, heap[child].word, heap[child].occurrences, heap[smallest].word, heap[smallest].occurrences) < 0){
+                smallest = child;
+            }
+        }
+        if(smallest == index){
+            return;
+        }
+        _Cursor swap = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = swap;
+        index = smallest;
+    }
+}
+
+static int _copy_word(const char *word, char **buffer, size_t *capacity){
+    size_t length = strlen(word);
+    if(length + 1 > *capacity){
+        size_t resized_capacity = (*capacity) ? *capacity : 64;
+        while(resized_capacity < length + 1){
+            resized_capacity *= 2;
+        }
+        char *resized = realloc(*buffer, resized_capacity);
+        if(!resized){
+            return -1;
+        }
+        *buffer = resized;
+        *capacity = resized_capacity;
+    }
+    memcpy(*buffer, word, length + 1);
+    return 0;
+}
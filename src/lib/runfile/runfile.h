@@ -0,0 +1,166 @@
+#ifndef RUNFILE_H
+#define RUNFILE_H
+
+#include <stddef.h>
+
+/*
+ * File binario di parole con le loro occorrenze, letto e scritto
+ * sequenzialmente. Le parole sono ordinate, quindi più file si
+ * uniscono leggendoli insieme, con memoria indipendente dal
+ * numero delle parole.
+ */
+typedef struct RunReader RunReader;
+typedef struct RunWriter RunWriter;
+typedef struct RunMerge RunMerge;
+
+/**
+ * Ordinamenti possibili delle parole di un file.
+ */
+typedef enum RunOrder {
+    /* Ordine alfabetico, ogni parola compare una sola volta */
+    RUNFILE_BY_WORD,
+    /* Occorrenze decrescenti e, a parità di occorrenze, ordine alfabetico */
+    RUNFILE_BY_OCCURRENCES
+} RunOrder;
+
+/**
+ * @brief Funzione invocata da runfile_merge() per ogni parola.
+ * Un valore di ritorno diverso da 0 interrompe l'unione.
+ */
+typedef int (*RunVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Inizia la scrittura di un file. Il file viene
+ * scritto accanto a path e lo sostituisce solo alla chiusura.
+ *
+ * @param path Il percorso del file
+ * @param order L'ordine in cui verranno aggiunte le parole
+ * @return RunWriter* Il puntatore al writer creato
+ * @return NULL Failure
+ */
+RunWriter *runfile_writer_new(const char *path, RunOrder order);
+
+/**
+ * @brief Aggiunge una parola al file. Le parole devono arrivare
+ * nell'ordine del file, altrimenti l'aggiunta fallisce con EINVAL.
+ * La firma è quella di un visitor, così il writer può ricevere
+ * direttamente le parole di una visita o di runfile_merge().
+ *
+ * @param word La parola, terminata da '\0'
+ * @param occurrences Le occorrenze della parola
+ * @param writer Il writer del file
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int runfile_writer_add(const char *word, int occurrences, void *writer);
+
+/**
+ * @brief Completa il file e libera il writer
+ *
+ * @param writer Il writer da chiudere
+ * @return 0 Success
+ * @return -1 Failure, il file precedente resta invariato
+ */
+int runfile_writer_close(RunWriter *writer);
+
+/**
+ * @brief Libera il writer scartando il file in scrittura
+ *
+ * @param writer Il writer da distruggere
+ */
+void runfile_writer_destroy(RunWriter *writer);
+
+/**
+ * @brief Apre un file in lettura, verificandone l'intestazione
+ *
+ * @param path Il percorso del file
+ * @return RunReader* Il puntatore al reader creato
+ * @return NULL Failure, EINVAL se il file non è valido
+ */
+RunReader *runfile_reader_open(const char *path);
+
+/**
+ * @brief Chiude il file e libera il reader
+ *
+ * @param reader Il reader da chiudere
+ */
+void runfile_reader_close(RunReader *reader);
+
+/**
+ * @brief Restituisce l'ordine delle parole del file
+ *
+ * @param reader Il reader
+ * @return RunOrder L'ordine
+ */
+RunOrder runfile_reader_get_order(const RunReader *reader);
+
+/**
+ * @brief Restituisce il numero di parole del file
+ *
+ * @param reader Il reader
+ * @return size_t Il numero di parole
+ */
+size_t runfile_reader_get_words_count(const RunReader *reader);
+
+/**
+ * @brief Legge la parola successiva. La parola resta valida
+ * fino alla lettura successiva.
+ *
+ * @param word Riceve la parola, terminata da '\0'
+ * @param occurrences Riceve le occorrenze della parola
+ * @param reader Il reader
+ * @return 1 Una parola è stata letta
+ * @return 0 Il file è terminato
+ * @return -1 Failure, EINVAL se il file è troncato o non valido
+ */
+int runfile_reader_next(const char **word, int *occurrences, RunReader *reader);
+
+/**
+ * @brief Unisce i file indicati, che devono avere lo stesso ordine,
+ * visitando le parole in quell'ordine. In ordine alfabetico le
+ * occorrenze di una parola presente in più file vengono sommate.
+ * Ogni file viene letto una sola volta, un blocco alla volta.
+ *
+ * @param paths I percorsi dei file
+ * @param count Il numero dei file
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure, EINVAL se gli ordini dei file sono diversi
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int runfile_merge(const char *const paths[], size_t count, RunVisitor visitor, void *context);
+
+/**
+ * @brief Apre l'unione dei file indicati, che devono avere lo stesso
+ * ordine, per leggerne le parole una alla volta con runfile_merge_next()
+ *
+ * @param paths I percorsi dei file
+ * @param count Il numero dei file
+ * @return RunMerge* Il puntatore all'unione aperta
+ * @return NULL Failure, EINVAL se gli ordini dei file sono diversi
+ */
+RunMerge *runfile_merge_open(const char *const paths[], size_t count);
+
+/**
+ * @brief Legge la parola successiva dell'unione, con le occorrenze
+ * sommate come in runfile_merge(). La parola resta valida fino
+ * alla lettura successiva.
+ *
+ * @param word Riceve la parola, terminata da '\0'
+ * @param occurrences Riceve le occorrenze della parola
+ * @param merge L'unione
+ * @return 1 Una parola è stata letta
+ * @return 0 I file sono terminati
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int runfile_merge_next(const char **word, int *occurrences, RunMerge *merge);
+
+/**
+ * @brief Chiude i file dell'unione e libera la memoria
+ *
+ * @param merge L'unione da chiudere
+ */
+void runfile_merge_close(RunMerge *merge);
+
+#endif
@@ -0,0 +1,330 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "snapshot.h"
+#include "../writer/writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SNAPSHOT_MAGIC "SWXSNAP1"
+#define MAGIC_LENGTH 8
+#define WRITER_BUFFER_SIZE (1024 * 1024)
+#define TEMP_SUFFIX ".tmp"
+
+typedef struct _Header _Header;
+typedef struct _Entry _Entry;
+
+static const _Entry *_find(const char *word, size_t length, const Snapshot *snapshot);
+static const _Entry *_get_entry(uint64_t offset, const Snapshot *snapshot);
+static int _compare_word(const char *word, size_t length, const _Entry *entry);
+static int _compare_offsets(const void *a, const void *b);
+static int _sort_index(SnapshotWriter *writer);
+static int _write_padding(size_t alignment, SnapshotWriter *writer);
+
+typedef struct _Header {
+    char magic[MAGIC_LENGTH];
+    uint64_t words_count;
+    uint64_t index_offset;
+} _Header;
+
+typedef struct _Entry {
+    uint32_t occurrences;
+    uint32_t length;
+    char word[];
+} _Entry;
+
+typedef struct Snapshot {
+    const char *data;
+    size_t size;
+    const uint64_t *index;
+    size_t words_count;
+} Snapshot;
+
+typedef struct SnapshotWriter {
+    char *path;
+    char *temp_path;
+    int fd;
+    Writer *output;
+    uint64_t *offsets;
+    size_t words_count;
+    size_t capacity;
+    uint64_t position;
+    char *last_word;
+    size_t last_capacity;
+    bool sorted;
+} SnapshotWriter;
+
+/* Tabella mappata usata dal comparatore di qsort() durante _sort_index() */
+static const char *_sort_table;
+
+Snapshot *snapshot_open(const char *path){
+    assert(path);
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) < 0 || (size_t) info.st_size < sizeof(_Header)){
+        close(fd);
+        return NULL;
+    }
+    size_t size = info.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED){
+        return NULL;
+    }
+    const _Header *header = data;
+    bool valid = memcmp(header->magic, SNAPSHOT_MAGIC, MAGIC_LENGTH) == 0
+        && header->index_offset % sizeof(uint64_t) == 0
+        && header->index_offset >= sizeof(_Header)
+        && header->index_offset <= size
+        && header->words_count <= (size - header->index_offset) / sizeof(uint64_t);
+    Snapshot *snapshot = (valid) ? malloc(sizeof(Snapshot)) : NULL;
+    if(!snapshot){
+        munmap(data, size);
+        return NULL;
+    }
+    snapshot->data = data;
+    snapshot->size = size;
+    snapshot->index = (const uint64_t *) (snapshot->data + header->index_offset);
+    snapshot->words_count = header->words_count;
+    return snapshot;
+}
+
+void snapshot_close(Snapshot *snapshot){
+    if(snapshot){
+        munmap((void *) snapshot->data, snapshot->size);
+        free(snapshot);
+    }
+}
+
+bool snapshot_contains_n(const char *word, size_t length, const Snapshot *snapshot){
+    return _find(word, length, snapshot) != NULL;
+}
+
+int snapshot_get_word_occurrences_n(const char *word, size_t length, const Snapshot *snapshot){
+    const _Entry *entry = _find(word, length, snapshot);
+    return (entry) ? (int) entry->occurrences : 0;
+}
+
+size_t snapshot_get_words_count(const Snapshot *snapshot){
+    assert(snapshot);
+    return snapshot->words_count;
+}
+
+SnapshotWriter *snapshot_writer_new(const char *path){
+    assert(path);
+    SnapshotWriter *writer = calloc(1, sizeof(SnapshotWriter));
+    if(!writer){
+        return NULL;
+    }
+    writer->fd = -1;
+    writer->sorted = true;
+    writer->path = malloc(strlen(path) + 1);
+    writer->temp_path = malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+    if(!writer->path || !writer->temp_path){
+        snapshot_writer_destroy(writer);
+        return NULL;
+    }
+    strcpy(writer->path, path);
+    sprintf(writer->temp_path, "%s%s", path, TEMP_SUFFIX);
+    writer->fd = open(writer->temp_path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if(writer->fd < 0){
+        snapshot_writer_destroy(writer);
+        return NULL;
+    }
+    writer->output = writer_new(writer->fd, WRITER_BUFFER_SIZE);
+    /* L'intestazione viene riscritta alla chiusura */
+    _Header header = {0};
+    if(!writer->output || writer_write((const char *) &header, sizeof(_Header), writer->output) < 0){
+        snapshot_writer_destroy(writer);
+        return NULL;
+    }
+    writer->position = sizeof(_Header);
+    return writer;
+}
+
+int snapshot_writer_add(const char *word, int occurrences, SnapshotWriter *writer){
+    assert(word);
+    assert(writer);
+    size_t length = strlen(word);
+    if(writer->words_count == writer->capacity){
+        size_t capacity = (writer->capacity == 0) ? 1024 : writer->capacity * 2;
+        uint64_t *offsets = realloc(writer->offsets, capacity * sizeof(uint64_t));
+        if(!offsets){
+            return -1;
+        }
+        writer->offsets = offsets;
+        writer->capacity = capacity;
+    }
+    if(writer->sorted){
+        if(writer->words_count > 0 && strcmp(writer->last_word, word) >= 0){
+            writer->sorted = false;
+        } else {
+            if(length + 1 > writer->last_capacity){
+                char *last_word = realloc(writer->last_word, length + 1);
+                if(!last_word){
+                    return -1;
+                }
+                writer->last_word = last_word;
+                writer->last_capacity = length + 1;
+            }
+            memcpy(writer->last_word, word, length + 1);
+        }
+    }
+    _Entry entry = { (uint32_t) occurrences, (uint32_t) length };
+    if(writer_write((const char *) &entry, sizeof(_Entry), writer->output) < 0){
+        return -1;
+    }
+    if(writer_write(word, length, writer->output) < 0){
+        return -1;
+    }
+    writer->offsets[writer->words_count++] = writer->position;
+    writer->position += sizeof(_Entry) + length;
+    return _write_padding(sizeof(uint32_t), writer);
+}
+
+int snapshot_writer_close(SnapshotWriter *writer){
+    assert(writer);
+    int res = _write_padding(sizeof(uint64_t), writer);
+    uint64_t index_offset = writer->position;
+    if(res == 0 && !writer->sorted){
+        res = _sort_index(writer);
+    }
+    if(res == 0 && writer->words_count > 0){
+        res = writer_write((const char *) writer->offsets, writer->words_count * sizeof(uint64_t), writer->output);
+    }
+    if(res == 0){
+        res = writer_flush(writer->output);
+    }
+    if(res == 0){
+        _Header header;
+        memcpy(header.magic, SNAPSHOT_MAGIC, MAGIC_LENGTH);
+        header.words_count = writer->words_count;
+        header.index_offset = index_offset;
+        res = (pwrite(writer->fd, &header, sizeof(_Header), 0) == sizeof(_Header)) ? 0 : -1;
+    }
+    if(close(writer->fd) != 0){
+        res = -1;
+    }
+    writer->fd = -1;
+    if(res == 0){
+        res = rename(writer->temp_path, writer->path);
+    }
+    snapshot_writer_destroy(writer);
+    return (res == 0) ? 0 : -1;
+}
+
+void snapshot_writer_destroy(SnapshotWriter *writer){
+    if(writer){
+        if(writer->fd >= 0){
+            close(writer->fd);
+        }
+        if(writer->temp_path){
+            unlink(writer->temp_path);
+        }
+        writer_destroy(writer->output);
+        free(writer->offsets);
+        free(writer->last_word);
+        free(writer->path);
+        free(writer->temp_path);
+        free(writer);
+    }
+}
+
+/* Private Methods */
+
+static const _Entry *_find(const char *word, size_t length, const Snapshot *snapshot){
+    assert(word);
+    assert(snapshot);
+    size_t low = 0, high = snapshot->words_count;
+    while(low < high){
+        size_t middle = low + (high - low) / 2;
+        const _Entry *entry = _get_entry(snapshot->index[middle], snapshot);
+        if(!entry){
+            return NULL;
+        }
+        int comparison = _compare_word(word, length, entry);
+        if(comparison == 0){
+            return entry;
+        }
+        if(comparison < 0){
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return NULL;
+}
+
+/* Restituisce NULL se l'offset esce dalla tabella delle stringhe */
+static const _Entry *_get_entry(uint64_t offset, const Snapshot *snapshot){
+    uint64_t table_end = (const char *) snapshot->index - snapshot->data;
+    if(offset < sizeof(_Header) || offset % sizeof(uint32_t) != 0 || offset + sizeof(_Entry) > table_end){
+        return NULL;
+    }
+    const _Entry *entry = (const _Entry *) (snapshot->data + offset);
+    if(entry->length > table_end - offset - sizeof(_Entry)){
+        return NULL;
+    }
+    return entry;
+}
+
+static int _compare_word(const char *word, size_t length, const _Entry *entry){
+    size_t common = (length < entry->length) ? length : entry->length;
+    for(size_t i = 0; i < common; i++){
+        unsigned char ch = word[i];
+        if(ch >= 'A' && ch <= 'Z'){
+            ch += 'a' - 'A';
+        }
+        unsigned char stored = entry->word[i];
+        if(ch != stored){
+            return (ch < stored) ? -1 : 1;
+        }
+    }
+    if(length == entry->length){
+        return 0;
+    }
+    return (length < entry->length) ? -1 : 1;
+}
+
+static int _compare_offsets(const void *a, const void *b){
+    const _Entry *first = (const _Entry *) (_sort_table + *(const uint64_t *) a);
+    const _Entry *second = (const _Entry *) (_sort_table + *(const uint64_t *) b);
+    return _compare_word(first->word, first->length, second);
+}
+
+/* Ordina l'indice leggendo le parole dalla tabella già scritta sul file */
+static int _sort_index(SnapshotWriter *writer){
+    if(writer_flush(writer->output) < 0){
+        return -1;
+    }
+    void *table = mmap(NULL, writer->position, PROT_READ, MAP_SHARED, writer->fd, 0);
+    if(table == MAP_FAILED){
+        return -1;
+    }
+    _sort_table = table;
+    qsort(writer->offsets, writer->words_count, sizeof(uint64_t), _compare_offsets);
+    _sort_table = NULL;
+    munmap(table, writer->position);
+    return 0;
+}
+
+static int _write_padding(size_t alignment, SnapshotWriter *writer){
+    static const char zeros[sizeof(uint64_t)] = {0};
+    size_t padding = (alignment - writer->position % alignment) % alignment;
+    if(padding > 0 && writer_write(zeros, padding, writer->output) < 0){
+        return -1;
+    }
+    writer->position += padding;
+    return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Formato del file:
+ *  - intestazione: magic "SWXSNAP1", numero di parole e offset dell'indice (uint64)
+ *  - tabella delle stringhe: per ogni parola occorrenze e lunghezza (uint32)
+ *    seguite dai caratteri, allineate a 4 byte
+ *  - indice: offset (uint64) delle parole in ordine alfabetico
+ * Gli interi sono nell'ordine dei byte della macchina che scrive il file.
+ */
+
+typedef struct Snapshot Snapshot;
+typedef struct SnapshotWriter SnapshotWriter;
+
+/**
+ * @brief Apre uno snapshot mappandolo in memoria.
+ * Il file non viene letto né convertito: le ricerche
+ * avvengono direttamente sulla memoria mappata.
+ * 
+ * @param path Il percorso dello snapshot
+ * @return Snapshot* Il puntatore allo snapshot aperto
+ * @return NULL Failure o file non valido
+ */
+Snapshot *snapshot_open(const char *path);
+
+/**
+ * @brief Rilascia la memoria mappata e lo snapshot
+ * 
+ * @param snapshot Lo snapshot da chiudere
+ */
+void snapshot_close(Snapshot *snapshot);
+
+/**
+ * @brief Verifica se lo snapshot contiene i primi length
+ * caratteri di word, senza distinzione tra maiuscole e minuscole
+ * 
+ * @param word La parola da cercare
+ * @param length La lunghezza della parola
+ * @param snapshot Lo snapshot in cui cercare
+ * @return true La parola è contenuta nello snapshot
+ * @return false La parola non è contenuta nello snapshot
+ */
+bool snapshot_contains_n(const char *word, size_t length, const Snapshot *snapshot);
+
+/**
+ * @brief Come snapshot_contains_n(), ma restituisce
+ * le occorrenze della parola
+ * 
+ * @return int Le occorrenze della parola, 0 se non è contenuta
+ */
+int snapshot_get_word_occurrences_n(const char *word, size_t length, const Snapshot *snapshot);
+
+/**
+ * @brief Restituisce il numero di parole dello snapshot
+ * 
+ * @param snapshot 
+ * @return size_t 
+ */
+size_t snapshot_get_words_count(const Snapshot *snapshot);
+
+/**
+ * @brief Inizia la scrittura di uno snapshot. Il file viene
+ * scritto accanto a path e lo sostituisce solo alla chiusura.
+ * 
+ * @param path Il percorso dello snapshot
+ * @return SnapshotWriter* Il puntatore al writer creato
+ * @return NULL Failure
+ */
+SnapshotWriter *snapshot_writer_new(const char *path);
+
+/**
+ * @brief Aggiunge una parola allo snapshot. Le parole possono
+ * essere aggiunte in qualsiasi ordine, ma se arrivano in ordine
+ * alfabetico la chiusura non deve ordinarle.
+ * Ogni parola deve essere aggiunta una sola volta.
+ * 
+ * @param word La parola, in minuscolo
+ * @param occurrences Le occorrenze della parola
+ * @param writer Il writer dello snapshot
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int snapshot_writer_add(const char *word, int occurrences, SnapshotWriter *writer);
+
+/**
+ * @brief Completa lo snapshot scrivendone l'indice e
+ * l'intestazione, e libera il writer.
+ * 
+ * @param writer Il writer da chiudere
+ * @return 0 Success
+ * @return -1 Failure, lo snapshot precedente resta invariato
+ */
+int snapshot_writer_close(SnapshotWriter *writer);
+
+/**
+ * @brief Libera il writer scartando lo snapshot in scrittura
+ * 
+ * @param writer Il writer da distruggere
+ */
+void snapshot_writer_destroy(SnapshotWriter *writer);
+
+#endif
@@ -0,0 +1,364 @@
+#include "spacesaving.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+
+#define EMPTY_SLOT 0
+
+typedef struct _Counter _Counter;
+
+static uint32_t _hash(const char *word, size_t length);
+static uint32_t *_find_slot(const char *word, size_t length, uint32_t hash, const SpaceSaving *sketch);
+static void _table_insert(uint32_t counter, SpaceSaving *sketch);
+static void _table_remove(uint32_t counter, SpaceSaving *sketch);
+static int _counter_new(const char *word, size_t length, uint32_t hash, int count, int error, SpaceSaving *sketch);
+static int _set_word(_Counter *counter, const char *word, size_t length, uint32_t hash);
+static int _get_minimum(const SpaceSaving *sketch);
+static void _sift_up(size_t position, SpaceSaving *sketch);
+static void _sift_down(size_t position, SpaceSaving *sketch);
+static void _swap(size_t a, size_t b, SpaceSaving *sketch);
+static int _compare_counters(const void *a, const void *b);
+static bool _add_count(int *count, int added);
+
+/*
+ * I contatori sono indicizzati da una tabella hash a indirizzamento
+ * aperto, per trovare la parola, e da un min-heap sui conteggi,
+ * per trovare il contatore da sostituire. La tabella ha almeno
+ * il doppio delle posizioni dei contatori.
+ */
+typedef struct SpaceSaving {
+    _Counter *counters;
+    uint32_t *heap;
+    uint32_t *table;
+    size_t table_mask;
+    size_t count;
+    size_t k;
+} SpaceSaving;
+
+typedef struct _Counter {
+    char *word;
+    size_t length;
+    size_t capacity;
+    uint32_t hash;
+    int count;
+    int error;
+    size_t heap_position;
+} _Counter;
+
+SpaceSaving *spacesaving_new(size_t k){
+    assert(k > 0 && k < UINT32_MAX / 2);
+    SpaceSaving *sketch = calloc(1, sizeof(SpaceSaving));
+    if(!sketch){
+        return NULL;
+    }
+    size_t table_size = 8;
+    while(table_size < 2 * k){
+        table_size *= 2;
+    }
+    sketch->counters = calloc(k, sizeof(_Counter));
+    sketch->heap = calloc(k, sizeof(uint32_t));
+    sketch->table = calloc(table_size, sizeof(uint32_t));
+    if(!sketch->counters || !sketch->heap || !sketch->table){
+        spacesaving_destroy(sketch);
+        return NULL;
+    }
+    sketch->table_mask = table_size - 1;
+    sketch->k = k;
+    return sketch;
+}
+
+void spacesaving_destroy(SpaceSaving *sketch){
+    if(sketch){
+        if(sketch->counters){
+            for(size_t i = 0; i < sketch->count; i++){
+                free(sketch->counters[i].word);
+            }
+        }
+        free(sketch->counters);
+        free(sketch->heap);
+        free(sketch->table);
+        free(sketch);
+    }
+}
+
+int spacesaving_offer(const char *word, size_t length, int occurrences, SpaceSaving *sketch){
+    assert(word);
+    assert(sketch);
+    uint32_t hash = _hash(word, length);
+    uint32_t *slot = _find_slot(word, length, hash, sketch);
+    if(*slot != EMPTY_SLOT){
+        _Counter *counter = &sketch->counters[*slot - 1];
+        if(!_add_count(&counter->count, occurrences)){
+            return -1;
+        }
+        _sift_down(counter->heap_position, sketch);
+        return 0;
+    }
+    if(sketch->count < sketch->k){
+        return _counter_new(word, length, hash, occurrences, 0, sketch);
+    }
+    /* La parola eredita il contatore minimo, che diventa il suo errore */
+    uint32_t index = sketch->heap[0];
+    _Counter *counter = &sketch->counters[index];
+    if(counter->count > INT_MAX - occurrences){
+        errno = EOVERFLOW;
+        return -1;
+    }
+    _table_remove(index, sketch);
+    if(_set_word(counter, word, length, hash) < 0){
+        return -1;
+    }
+    counter->error = counter->count;
+    counter->count += occurrences;
+    _table_insert(index, sketch);
+    _sift_down(0, sketch);
+    return 0;
+}
+
+int spacesaving_merge(const SpaceSaving *source, SpaceSaving *destination){
+    assert(source);
+    assert(destination);
+    /*
+     * Una parola non monitorata da uno sketch pieno può avere al più
+     * tante occorrenze quante il suo contatore minimo: la stima
+     * aggiunge il minimo al conteggio e all'errore. Dei contatori
+     * risultanti si tengono i k maggiori.
+     */
+    int source_minimum = _get_minimum(source);
+    int destination_minimum = _get_minimum(destination);
+    size_t total = destination->count + source->count;
+    if(total == 0){
+        return 0;
+    }
+    _Counter *merged = malloc(total * sizeof(_Counter));
+    if(!merged){
+        return -1;
+    }
+    size_t merged_count = 0;
+    for(size_t i = 0; i < destination->count; i++){
+        _Counter counter = destination->counters[i];
+        uint32_t *slot = _find_slot(counter.word, counter.length, counter.hash, source);
+        bool added;
+        if(*slot != EMPTY_SLOT){
+            added = _add_count(&counter.count, source->counters[*slot - 1].count)
+                && _add_count(&counter.error, source->counters[*slot - 1].error);
+        } else {
+            added = _add_count(&counter.count, source_minimum) && _add_count(&counter.error, source_minimum);
+        }
+        if(!added){
+            free(merged);
+            return -1;
+        }
+        merged[merged_count++] = counter;
+    }
+    for(size_t i = 0; i < source->count; i++){
+        _Counter counter = source->counters[i];
+        if(*_find_slot(counter.word, counter.length, counter.hash, destination) == EMPTY_SLOT){
+            if(!_add_count(&counter.count, destination_minimum) || !_add_count(&counter.error, destination_minimum)){
+                free(merged);
+                return -1;
+            }
+            merged[merged_count++] = counter;
+        }
+    }
+    qsort(merged, merged_count, sizeof(_Counter), _compare_counters);
+    if(merged_count > destination->k){
+        merged_count = destination->k;
+    }
+
+    SpaceSaving *result = spacesaving_new(destination->k);
+    int res = (result) ? 0 : -1;
+    for(size_t i = 0; res == 0 && i < merged_count; i++){
+        _Counter *counter = &merged[i];
+        res = _counter_new(counter->word, counter->length, counter->hash, counter->count, counter->error, result);
+    }
+    free(merged);
+    if(res < 0){
+        spacesaving_destroy(result);
+        return -1;
+    }
+    SpaceSaving swap = *destination;
+    *destination = *result;
+    *result = swap;
+    spacesaving_destroy(result);
+    return 0;
+}
+
+int spacesaving_visit(const SpaceSaving *sketch, SpaceSavingVisitor visitor, void *context){
+    assert(sketch);
+    assert(visitor);
+    if(sketch->count == 0){
+        return 0;
+    }
+    _Counter *sorted = malloc(sketch->count * sizeof(_Counter));
+    if(!sorted){
+        return -1;
+    }
+    memcpy(sorted, sketch->counters, sketch->count * sizeof(_Counter));
+    qsort(sorted, sketch->count, sizeof(_Counter), _compare_counters);
+    int res = 0;
+    for(size_t i = 0; res == 0 && i < sketch->count; i++){
+        res = visitor(sorted[i].word, sorted[i].count, sorted[i].error, context);
+    }
+    free(sorted);
+    return res;
+}
+
+/* Private Methods */
+
+static uint32_t _hash(const char *word, size_t length){
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < length; i++){
+        hash ^= (unsigned char) word[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t *_find_slot(const char *word, size_t length, uint32_t hash, const SpaceSaving *sketch){
+    size_t position = hash & sketch->table_mask;
+    for(;;){
+        uint32_t *slot = &sketch->table[position];
+        if(*slot == EMPTY_SLOT){
+            return slot;
+        }
+        const _Counter *counter = &sketch->counters[*slot - 1];
+        if(counter->hash == hash && counter->length == length && memcmp(counter->word, word, length) == 0){
+            return slot;
+        }
+        position = (position + 1) & sketch->table_mask;
+    }
+}
+
+static void _table_insert(uint32_t counter, SpaceSaving *sketch){
+    size_t position = sketch->counters[counter].hash & sketch->table_mask;
+    while(sketch->table[position] != EMPTY_SLOT){
+        position = (position + 1) & sketch->table_mask;
+    }
+    sketch->table[position] = counter + 1;
+}
+
+static void _table_remove(uint32_t counter, SpaceSaving *sketch){
+    size_t hole = sketch->counters[counter].hash & sketch->table_mask;
+    while(sketch->table[hole] != counter + 1){
+        hole = (hole + 1) & sketch->table_mask;
+    }
+    /* Le posizioni successive vengono spostate indietro per non interrompere le sequenze di scansione */
+    size_t position = hole;
+    for(;;){
+        position = (position + 1) & sketch->table_mask;
+        uint32_t slot = sketch->table[position];
+        if(slot == EMPTY_SLOT){
+            break;
+        }
+        size_t home = sketch->counters[slot - 1].hash & sketch->table_mask;
+        bool reachable = (hole <= position) ? (hole < home && home <= position) : (hole < home || home <= position);
+        if(!reachable){
+            sketch->table[hole] = slot;
+            hole = position;
+        }
+    }
+    sketch->table[hole] = EMPTY_SLOT;
+}
+
+static int _counter_new(const char *word, size_t length, uint32_t hash, int count, int error, SpaceSaving *sketch){
+    assert(sketch->count < sketch->k);
+    uint32_t index = sketch->count;
+    _Counter *counter = &sketch->counters[index];
+    if(_set_word(counter, word, length, hash) < 0){
+        return -1;
+    }
+    counter->count = count;
+    counter->error = error;
+    counter->heap_position = index;
+    sketch->heap[index] = index;
+    sketch->count++;
+    _table_insert(index, sketch);
+    _sift_up(index, sketch);
+    return 0;
+}
+
+static int _set_word(_Counter *counter, const char *word, size_t length, uint32_t hash){
+    if(length + 1 > counter->capacity){
+        char *buffer = realloc(counter->word, length + 1);
+        if(!buffer){
+            return -1;
+        }
+        counter->word = buffer;
+        counter->capacity = length + 1;
+    }
+    memcpy(counter->word, word, length);
+    counter->word[length] = '\0';
+    counter->length = length;
+    counter->hash = hash;
+    return 0;
+}
+
+static int _get_minimum(const SpaceSaving *sketch){
+    if(sketch->count < sketch->k){
+        return 0;
+    }
+    return sketch->counters[sketch->heap[0]].count;
+}
+
+static void _sift_up(size_t position, SpaceSaving *sketch){
+    while(position > 0){
+        size_t parent = (position - 1) / 2;
+        if(sketch->counters[sketch->heap[parent]].count <= sketch->counters[sketch->heap[position]].count){
+            break;
+        }
+        _swap(position, parent, sketch);
+        position = parent;
+    }
+}
+
+static void _sift_down(size_t position, SpaceSaving *sketch){
+    for(;;){
+        size_t lowest = position;
+        size_t left = 2 * position + 1, right = left + 1;
+        if(left < sketch->count && sketch->counters[sketch->heap[left]].count < sketch->counters[sketch->heap[lowest]].count){
+            lowest = left;
+        }
+        if(right < sketch->count && sketch->counters[sketch->heap[right]].count < sketch->counters[sketch->heap[lowest]].count){
+            lowest = right;
+        }
+        if(lowest == position){
+            return;
+        }
+        _swap(position, lowest, sketch);
+        position = lowest;
+    }
+}
+
+static void _swap(size_t a, size_t b, SpaceSaving *sketch){
+    uint32_t counter = sketch->heap[a];
+    sketch->heap[a] = sketch->heap[b];
+    sketch->heap[b] = counter;
+    sketch->counters[sketch->heap[a]].heap_position = a;
+    sketch->counters[sketch->heap[b]].heap_position = b;
+}
+
+static int _compare_counters(const void *a, const void *b){
+    const _Counter *first = a;
+    const _Counter *second = b;
+    if(first->count != second->count){
+        return (first->count > second->count) ? -1 : 1;
+    }
+    return strcmp(first->word, second->word);
+}
+
+/* Somma added a count, fallendo con EOVERFLOW se il risultato supererebbe INT_MAX */
+static bool _add_count(int *count, int added){
+    if(*count > INT_MAX - added){
+        errno = EOVERFLOW;
+        return false;
+    }
+    *count += added;
+    return true;
+}
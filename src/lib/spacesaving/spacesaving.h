@@ -0,0 +1,77 @@
+#ifndef SPACESAVING_H
+#define SPACESAVING_H
+
+#include <stddef.h>
+
+typedef struct SpaceSaving SpaceSaving;
+
+/**
+ * @brief Funzione invocata da spacesaving_visit() per ogni parola
+ * monitorata. Le occorrenze reali della parola sono comprese
+ * tra count - error e count.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*SpaceSavingVisitor)(const char *word, int count, int error, void *context);
+
+/**
+ * @brief Crea uno sketch Space-Saving che stima le parole più
+ * frequenti di un flusso usando al più k contatori.
+ * La memoria occupata è O(k) qualunque sia il numero di parole
+ * distinte del flusso; ogni parola con più di N/k occorrenze,
+ * dove N è il totale delle occorrenze, resta monitorata.
+ * 
+ * @param k Il numero di contatori
+ * @return SpaceSaving* Il puntatore allo sketch creato
+ * @return NULL Failure
+ */
+SpaceSaving *spacesaving_new(size_t k);
+
+/**
+ * @brief Libera la memoria riservata allo sketch
+ * 
+ * @param sketch Lo sketch da distruggere
+ */
+void spacesaving_destroy(SpaceSaving *sketch);
+
+/**
+ * @brief Aggiunge le occorrenze specificate ai primi length
+ * caratteri di word. Se la parola non è monitorata e i contatori
+ * sono esauriti, la parola prende il posto di quella con il
+ * contatore minimo, ereditandone il valore come errore.
+ * 
+ * @param word La parola da aggiungere
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da aggiungere
+ * @param sketch Lo sketch a cui aggiungere la parola
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int spacesaving_offer(const char *word, size_t length, int occurrences, SpaceSaving *sketch);
+
+/**
+ * @brief Unisce a destination lo sketch source, come se i due
+ * flussi fossero stati offerti allo stesso sketch. I limiti
+ * di errore restano validi. Lo sketch source non viene modificato.
+ * 
+ * @param source Lo sketch da cui leggere i contatori
+ * @param destination Lo sketch in cui unire i contatori
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int spacesaving_merge(const SpaceSaving *source, SpaceSaving *destination);
+
+/**
+ * @brief Visita le parole monitorate in ordine decrescente
+ * di occorrenze stimate; le parole con la stessa stima
+ * vengono visitate in ordine alfabetico.
+ * 
+ * @param sketch Lo sketch da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int spacesaving_visit(const SpaceSaving *sketch, SpaceSavingVisitor visitor, void *context);
+
+#endif
@@ -0,0 +1,421 @@
+#define _GNU_SOURCE
+
+#include "spill.h"
+#include "../runfile/runfile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DIRECTORY_TEMPLATE "swordx-XXXXXX"
+/* File uniti insieme al massimo: ognuno ha il suo buffer di lettura */
+#define MAX_MERGE_WAYS 64
+#define RUN_NAME_LENGTH 32
+
+typedef struct _Runs _Runs;
+typedef struct _Block _Block;
+typedef struct _BlockEntry _BlockEntry;
+typedef struct _WordsMerge _WordsMerge;
+
+static char *_new_run_path(Spill *spill);
+static int _runs_append(char *path, bool owned, _Runs *runs);
+static int _runs_reduce(_Runs *runs, RunOrder order, Spill *spill);
+static void _runs_clear(_Runs *runs);
+static int _add_run(char *path, bool owned, Spill *spill);
+static int _block_add(const char *word, int occurrences, void *block);
+static int _block_flush(_Block *block);
+static void _block_sort(_Block *block);
+static int _compare_entries(const void *a, const void *b, void *text);
+static int _merge_word(const char *word, int occurrences, void *merge);
+static int _merge_runs_before(const char *word, _WordsMerge *merge);
+
+/* Percorsi di file, in ordine di scrittura; i file non posseduti non vengono rimossi */
+typedef struct _Runs {
+    char **paths;
+    bool *owned;
+    size_t count;
+    size_t capacity;
+} _Runs;
+
+/*
+ * Unione delle parole in memoria, visitate in ordine alfabetico,
+ * con quelle degli scarichi: next è l'esito dell'ultima lettura
+ * degli scarichi, la cui parola non è ancora stata visitata.
+ */
+typedef struct _WordsMerge {
+    RunMerge *runs;
+    const char *run_word;
+    int run_occurrences;
+    int next;
+    WordCountVisitor visitor;
+    void *context;
+} _WordsMerge;
+
+typedef struct Spill {
+    char *directory;
+    pthread_mutex_t mutex;
+    _Runs runs;
+    size_t next_run;
+    size_t runs_added;
+    size_t bytes;
+} Spill;
+
+typedef struct _BlockEntry {
+    size_t offset;
+    int occurrences;
+} _BlockEntry;
+
+/*
+ * Blocco di parole ordinate per occorrenze da spill_visit_by_occurrences():
+ * le parole sono una di seguito all'altra in text, terminate da '\0'
+ */
+typedef struct _Block {
+    Spill *spill;
+    size_t memory_limit;
+    char *text;
+    size_t length;
+    size_t text_capacity;
+    _BlockEntry *entries;
+    size_t count;
+    size_t capacity;
+    _Runs runs;
+} _Block;
+
+Spill *spill_new(const char *directory){
+    assert(directory);
+    Spill *spill = calloc(1, sizeof(Spill));
+    if(!spill){
+        return NULL;
+    }
+    spill->directory = malloc(strlen(directory) + strlen(DIRECTORY_TEMPLATE) + 2);
+    if(!spill->directory){
+        free(spill);
+        return NULL;
+    }
+    sprintf(spill->directory, "%s/%s", directory, DIRECTORY_TEMPLATE);
+    if(!mkdtemp(spill->directory) || pthread_mutex_init(&spill->mutex, NULL) != 0){
+        rmdir(spill->directory);
+        free(spill->directory);
+        free(spill);
+        return NULL;
+    }
+    return spill;
+}
+
+void spill_destroy(Spill *spill){
+    if(spill){
+        _runs_clear(&spill->runs);
+        rmdir(spill->directory);
+        pthread_mutex_destroy(&spill->mutex);
+        free(spill->directory);
+        free(spill);
+    }
+}
+
+int spill_write(const WordCount *words, Spill *spill){
+    assert(words);
+    assert(spill);
+    char *path = _new_run_path(spill);
+    RunWriter *writer = (path) ? runfile_writer_new(path, RUNFILE_BY_WORD) : NULL;
+    if(!writer){
+        free(path);
+        return -1;
+    }
+    if(wordcount_visit(words, runfile_writer_add, writer) != 0){
+        runfile_writer_destroy(writer);
+        free(path);
+        return -1;
+    }
+    if(runfile_writer_close(writer) < 0 || _add_run(path, true, spill) < 0){
+        unlink(path);
+        free(path);
+        return -1;
+    }
+    return 0;
+}
+
+int spill_add_run(const char *path, Spill *spill){
+    assert(path);
+    assert(spill);
+    char *copy = malloc(strlen(path) + 1);
+    if(!copy){
+        return -1;
+    }
+    strcpy(copy, path);
+    if(_add_run(copy, false, spill) < 0){
+        free(copy);
+        return -1;
+    }
+    return 0;
+}
+
+size_t spill_get_runs_count(const Spill *spill){
+    assert(spill);
+    return spill->runs_added;
+}
+
+size_t spill_get_bytes(const Spill *spill){
+    assert(spill);
+    return spill->bytes;
+}
+
+int spill_visit(Spill *spill, const WordCount *words, WordCountVisitor visitor, void *context){
+    assert(spill);
+    if(_runs_reduce(&spill->runs, RUNFILE_BY_WORD, spill) < 0){
+        return -1;
+    }
+    if(!words){
+        return runfile_merge((const char *const *) spill->runs.paths, spill->runs.count, visitor, context);
+    }
+    _WordsMerge merge = {runfile_merge_open((const char *const *) spill->runs.paths, spill->runs.count), NULL, 0, 0, visitor, context};
+    if(!merge.runs){
+        return -1;
+    }
+    merge.next = runfile_merge_next(&merge.run_word, &merge.run_occurrences, merge.runs);
+    int res = wordcount_visit(words, _merge_word, &merge);
+    /* Le parole degli scarichi che seguono l'ultima in memoria */
+    if(res == 0){
+        res = _merge_runs_before(NULL, &merge);
+    }
+    runfile_merge_close(merge.runs);
+    return res;
+}
+
+/*
+ * Le parole arrivano in ordine alfabetico da spill_visit() e vengono
+ * raccolte in un blocco; quando il blocco supera memory_limit viene
+ * ordinato per occorrenze e scaricato. Se tutte le parole entrano in
+ * un blocco solo, il blocco viene visitato senza scaricarlo.
+ */
+int spill_visit_by_occurrences(Spill *spill, const WordCount *words, size_t memory_limit, WordCountVisitor visitor, void *context){
+    assert(spill);
+    _Block block = {spill, memory_limit, NULL, 0, 0, NULL, 0, 0, {NULL, NULL, 0, 0}};
+    int res = spill_visit(spill, words, _block_add, &block);
+    if(res == 0 && block.runs.count == 0){
+        _block_sort(&block);
+        for(size_t i = 0; res == 0 && i < block.count; i++){
+            res = visitor(block.text + block.entries[i].offset, block.entries[i].occurrences, context);
+        }
+    } else if(res == 0){
+        res = _block_flush(&block);
+        if(res == 0){
+            res = _runs_reduce(&block.runs, RUNFILE_BY_OCCURRENCES, spill);
+        }
+        if(res == 0){
+            res = runfile_merge((const char *const *) block.runs.paths, block.runs.count, visitor, context);
+        }
+    }
+    _runs_clear(&block.runs);
+    free(block.text);
+    free(block.entries);
+    return res;
+}
+
+/* Private Methods */
+
+static char *_new_run_path(Spill *spill){
+    pthread_mutex_lock(&spill->mutex);
+    size_t run = spill->next_run++;
+    pthread_mutex_unlock(&spill->mutex);
+    char *path = malloc(strlen(spill->directory) + RUN_NAME_LENGTH);
+    if(path){
+        sprintf(path, "%s/run-%zu", spill->directory, run);
+    }
+    return path;
+}
+
+static int _runs_append(char *path, bool owned, _Runs *runs){
+    if(runs->count == runs->capacity){
+        size_t capacity = (runs->capacity) ? runs->capacity * 2 : 16;
+        char **paths = realloc(runs->paths, capacity * sizeof(char *));
+        if(paths){
+            runs->paths = paths;
+        }
+        bool *owned_runs = realloc(runs->owned, capacity * sizeof(bool));
+        if(owned_runs){
+            runs->owned = owned_runs;
+        }
+        if(!paths || !owned_runs){
+            return -1;
+        }
+        runs->capacity = capacity;
+    }
+    runs->paths[runs->count] = path;
+    runs->owned[runs->count++] = owned;
+    return 0;
+}
+
+/* Unisce i primi MAX_MERGE_WAYS file in uno nuovo, in coda, finché non ne restano al più MAX_MERGE_WAYS */
+static int _runs_reduce(_Runs *runs, RunOrder order, Spill *spill){
+    while(runs->count > MAX_MERGE_WAYS){
+        char *path = _new_run_path(spill);
+        RunWriter *writer = (path) ? runfile_writer_new(path, order) : NULL;
+        if(!writer){
+            free(path);
+            return -1;
+        }
+        if(runfile_merge((const char *const *) runs->paths, MAX_MERGE_WAYS, runfile_writer_add, writer) != 0){
+            runfile_writer_destroy(writer);
+            free(path);
+            return -1;
+        }
+        if(runfile_writer_close(writer) < 0 || _runs_append(path, true, runs) < 0){
+            unlink(path);
+            free(path);
+            return -1;
+        }
+        for(size_t i = 0; i < MAX_MERGE_WAYS; i++){
+            if(runs->owned[i]){
+                unlink(runs->paths[i]);
+            }
+            free(runs->paths[i]);
+        }
+        runs->count -= MAX_MERGE_WAYS;
+        memmove(runs->paths, runs->paths + MAX_MERGE_WAYS, runs->count * sizeof(char *));
+        memmove(runs->owned, runs->owned + MAX_MERGE_WAYS, runs->count * sizeof(bool));
+    }
+    return 0;
+}
+
+static void _runs_clear(_Runs *runs){
+    for(size_t i = 0; i < runs->count; i++){
+        if(runs->owned[i]){
+            unlink(runs->paths[i]);
+        }
+        free(runs->paths[i]);
+    }
+    free(runs->paths);
+    free(runs->owned);
+    runs->paths = NULL;
+    runs->owned = NULL;
+    runs->count = 0;
+    runs->capacity = 0;
+}
+
+static int _add_run(char *path, bool owned, Spill *spill){
+    struct stat info;
+    size_t size = (stat(path, &info) == 0) ? (size_t) info.st_size : 0;
+    pthread_mutex_lock(&spill->mutex);
+    int res = _runs_append(path, owned, &spill->runs);
+    if(res == 0){
+        spill->runs_added++;
+        spill->bytes += size;
+    }
+    pthread_mutex_unlock(&spill->mutex);
+    return res;
+}
+
+static int _merge_word(const char *word, int occurrences, void *merge){
+    _WordsMerge *words_merge = merge;
+    int res = _merge_runs_before(word, words_merge);
+    if(res != 0){
+        return res;
+    }
+    if(words_merge->next > 0 && strcmp(words_merge->run_word, word) == 0){
+        if(occurrences > INT_MAX - words_merge->run_occurrences){
+            errno = EOVERFLOW;
+            return -1;
+        }
+        occurrences += words_merge->run_occurrences;
+        words_merge->next = runfile_merge_next(&words_merge->run_word, &words_merge->run_occurrences, words_merge->runs);
+        if(words_merge->next < 0){
+            return -1;
+        }
+    }
+    return words_merge->visitor(word, occurrences, words_merge->context);
+}
+
+/* Visita le parole degli scarichi che precedono word, tutte se word è NULL */
+static int _merge_runs_before(const char *word, _WordsMerge *merge){
+    while(merge->next > 0 && (!word || strcmp(merge->run_word, word) < 0)){
+        int res = merge->visitor(merge->run_word, merge->run_occurrences, merge->context);
+        if(res != 0){
+            return res;
+        }
+        merge->next = runfile_merge_next(&merge->run_word, &merge->run_occurrences, merge->runs);
+    }
+    return (merge->next < 0) ? -1 : 0;
+}
+
+static int _block_add(const char *word, int occurrences, void *block){
+    _Block *collected = block;
+    size_t length = strlen(word) + 1;
+    size_t used = collected->length + collected->count * sizeof(_BlockEntry);
+    if(used >= collected->memory_limit && collected->count > 0 && _block_flush(collected) < 0){
+        return -1;
+    }
+    if(collected->length + length > collected->text_capacity){
+        size_t capacity = (collected->text_capacity) ? collected->text_capacity : 64 * 1024;
+        while(capacity < collected->length + length){
+            capacity *= 2;
+        }
+        char *text = realloc(collected->text, capacity);
+        if(!text){
+            return -1;
+        }
+        collected->text = text;
+        collected->text_capacity = capacity;
+    }
+    if(collected->count == collected->capacity){
+        size_t capacity = (collected->capacity) ? collected->capacity * 2 : 4096;
+        _BlockEntry *entries = realloc(collected->entries, capacity * sizeof(_BlockEntry));
+        if(!entries){
+            return -1;
+        }
+        collected->entries = entries;
+        collected->capacity = capacity;
+    }
+    memcpy(collected->text + collected->length, word, length);
+    collected->entries[collected->count].offset = collected->length;
+    collected->entries[collected->count].occurrences = occurrences;
+    collected->count++;
+    collected->length += length;
+    return 0;
+}
+
+/* Ordina il blocco e lo scarica su un nuovo file; il blocco resta allocato per le parole seguenti */
+static int _block_flush(_Block *block){
+    _block_sort(block);
+    char *path = _new_run_path(block->spill);
+    RunWriter *writer = (path) ? runfile_writer_new(path, RUNFILE_BY_OCCURRENCES) : NULL;
+    if(!writer){
+        free(path);
+        return -1;
+    }
+    for(size_t i = 0; i < block->count; i++){
+        if(runfile_writer_add(block->text + block->entries[i].offset, block->entries[i].occurrences, writer) < 0){
+            runfile_writer_destroy(writer);
+            free(path);
+            return -1;
+        }
+    }
+    if(runfile_writer_close(writer) < 0 || _runs_append(path, true, &block->runs) < 0){
+        unlink(path);
+        free(path);
+        return -1;
+    }
+    block->count = 0;
+    block->length = 0;
+    return 0;
+}
+
+static void _block_sort(_Block *block){
+    qsort_r(block->entries, block->count, sizeof(_BlockEntry), _compare_entries, block->text);
+}
+
+/* text è il testo del blocco, passato da qsort_r() per ogni confronto */
+static int _compare_entries(const void *a, const void *b, void *text){
+    const _BlockEntry *x = a, *y = b;
+    const char *words = text;
+    if(x->occurrences != y->occurrences){
+        return (x->occurrences > y->occurrences) ? -1 : 1;
+    }
+    return strcmp(words + x->offset, words + y->offset);
+}
@@ -0,0 +1,104 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+#include <stddef.h>
+
+#include "../wordcount/wordcount.h"
+
+/*
+ * Conteggi scaricati su disco quando non entrano in memoria: ogni
+ * scarico è un file di parole in ordine alfabetico in una directory
+ * temporanea. Le visite uniscono i file leggendoli insieme, quindi
+ * la memoria usata non dipende dal numero delle parole.
+ */
+typedef struct Spill Spill;
+
+/**
+ * @brief Crea una directory temporanea, vuota, per gli scarichi
+ *
+ * @param directory La directory in cui creare quella temporanea
+ * @return Spill* Il puntatore agli scarichi creati
+ * @return NULL Failure
+ */
+Spill *spill_new(const char *directory);
+
+/**
+ * @brief Rimuove i file scaricati e la directory temporanea
+ *
+ * @param spill Gli scarichi da distruggere
+ */
+void spill_destroy(Spill *spill);
+
+/**
+ * @brief Scarica le parole su un nuovo file. Può essere invocata
+ * da più thread insieme; il conteggio non viene modificato.
+ *
+ * @param words Il conteggio da scaricare
+ * @param spill Gli scarichi
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int spill_write(const WordCount *words, Spill *spill);
+
+/**
+ * @brief Aggiunge agli scarichi un file scritto altrove, in ordine
+ * alfabetico, che viene unito agli altri ma non viene mai rimosso
+ *
+ * @param path Il percorso del file
+ * @param spill Gli scarichi
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int spill_add_run(const char *path, Spill *spill);
+
+/**
+ * @brief Restituisce il numero dei file scaricati o aggiunti
+ *
+ * @param spill Gli scarichi
+ * @return size_t Il numero dei file
+ */
+size_t spill_get_runs_count(const Spill *spill);
+
+/**
+ * @brief Restituisce i byte dei file scaricati o aggiunti
+ *
+ * @param spill Gli scarichi
+ * @return size_t I byte dei file
+ */
+size_t spill_get_bytes(const Spill *spill);
+
+/**
+ * @brief Visita in ordine alfabetico le parole di tutti gli scarichi
+ * e quelle ancora in memoria, sommando le occorrenze di ogni parola.
+ * Le parole in memoria non vengono scaricate. Oltre un certo numero
+ * di file i primi vengono prima uniti in un file solo, quindi i file
+ * aperti insieme sono limitati.
+ *
+ * @param spill Gli scarichi da visitare
+ * @param words Le parole in memoria, o NULL
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int spill_visit(Spill *spill, const WordCount *words, WordCountVisitor visitor, void *context);
+
+/**
+ * @brief Visita le parole di tutti gli scarichi e quelle in memoria
+ * in ordine decrescente di occorrenze e, a parità di occorrenze, in
+ * ordine alfabetico. Le parole vengono ordinate a blocchi di al più
+ * memory_limit byte, scaricati a loro volta e poi uniti.
+ *
+ * @param spill Gli scarichi da visitare
+ * @param words Le parole in memoria, o NULL
+ * @param memory_limit I byte disponibili per ordinare un blocco
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int spill_visit_by_occurrences(Spill *spill, const WordCount *words, size_t memory_limit, WordCountVisitor visitor, void *context);
+
+#endif
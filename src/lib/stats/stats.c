@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include "../alloc/alloc.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define MAX_PHASES 16
+#define MAX_COUNTERS 32
+
+static double _get_clock(clockid_t clock);
+
+typedef struct _Phase {
+    const char *name;
+    double wall_seconds;
+    double cpu_seconds;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+} _Phase;
+
+typedef struct _Counter {
+    const char *name;
+    uint64_t value;
+} _Counter;
+
+typedef struct Stats {
+    _Phase phases[MAX_PHASES];
+    size_t phases_count;
+    /* La fase in corso, se c'è, è l'ultima e ha ancora i valori iniziali */
+    bool in_phase;
+    _Counter counters[MAX_COUNTERS];
+    size_t counters_count;
+    double begin;
+} Stats;
+
+Stats *stats_new(){
+    Stats *stats = calloc(1, sizeof(Stats));
+    if(!stats){
+        return NULL;
+    }
+    stats->begin = _get_clock(CLOCK_MONOTONIC);
+    return stats;
+}
+
+void stats_destroy(Stats *stats){
+    free(stats);
+}
+
+int stats_begin_phase(const char *name, Stats *stats){
+    assert(name);
+    assert(stats);
+    stats_end_phase(stats);
+    if(stats->phases_count == MAX_PHASES){
+        return -1;
+    }
+    AllocStats alloc_stats;
+    alloc_get_stats(&alloc_stats);
+    _Phase *phase = &stats->phases[stats->phases_count++];
+    phase->name = name;
+    phase->wall_seconds = _get_clock(CLOCK_MONOTONIC);
+    phase->cpu_seconds = _get_clock(CLOCK_PROCESS_CPUTIME_ID);
+    phase->allocations = alloc_stats.allocations + alloc_stats.reallocations;
+    phase->allocated_bytes = alloc_stats.allocated_bytes;
+    stats->in_phase = true;
+    return 0;
+}
+
+void stats_end_phase(Stats *stats){
+    assert(stats);
+    if(!stats->in_phase){
+        return;
+    }
+    AllocStats alloc_stats;
+    alloc_get_stats(&alloc_stats);
+    _Phase *phase = &stats->phases[stats->phases_count - 1];
+    phase->wall_seconds = _get_clock(CLOCK_MONOTONIC) - phase->wall_seconds;
+    phase->cpu_seconds = _get_clock(CLOCK_PROCESS_CPUTIME_ID) - phase->cpu_seconds;
+    phase->allocations = alloc_stats.allocations + alloc_stats.reallocations - phase->allocations;
+    phase->allocated_bytes = alloc_stats.allocated_bytes - phase->allocated_bytes;
+    stats->in_phase = false;
+}
+
+int stats_set_counter(const char *name, uint64_t value, Stats *stats){
+    assert(name);
+    assert(stats);
+    for(size_t i = 0; i < stats->counters_count; i++){
+        if(strcmp(stats->counters[i].name, name) == 0){
+            stats->counters[i].value = value;
+            return 0;
+        }
+    }
+    if(stats->counters_count == MAX_COUNTERS){
+        return -1;
+    }
+    stats->counters[stats->counters_count].name = name;
+    stats->counters[stats->counters_count].value = value;
+    stats->counters_count++;
+    return 0;
+}
+
+int stats_write(FILE *file, const Stats *stats){
+    assert(file);
+    assert(stats);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    AllocStats alloc_stats;
+    alloc_get_stats(&alloc_stats);
+
+    fprintf(file, "{\n  \"phases\": [\n");
+    for(size_t i = 0; i < stats->phases_count; i++){
+        const _Phase *phase = &stats->phases[i];
+        bool running = stats->in_phase && i == stats->phases_count - 1;
+        fprintf(file, "    {\"name\": \"%s\", \"wall_seconds\": %.6f, \"cpu_seconds\": %.6f, "
+            "\"allocations\": %llu, \"allocated_bytes\": %llu}%s\n",
+            phase->name, (running) ? 0 : phase->wall_seconds, (running) ? 0 : phase->cpu_seconds,
+            (unsigned long long) ((running) ? 0 : phase->allocations),
+            (unsigned long long) ((running) ? 0 : phase->allocated_bytes),
+            (i == stats->phases_count - 1) ? "" : ",");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"wall_seconds\": %.6f,\n", _get_clock(CLOCK_MONOTONIC) - stats->begin);
+    fprintf(file, "  \"cpu_seconds\": %.6f,\n", _get_clock(CLOCK_PROCESS_CPUTIME_ID));
+    fprintf(file, "  \"user_seconds\": %.6f,\n", usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6);
+    fprintf(file, "  \"system_seconds\": %.6f,\n", usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+    for(size_t i = 0; i < stats->counters_count; i++){
+        fprintf(file, "  \"%s\": %llu,\n", stats->counters[i].name, (unsigned long long) stats->counters[i].value);
+    }
+    fprintf(file, "  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+    fprintf(file, "  \"allocator\": {\"allocations\": %llu, \"reallocations\": %llu, \"frees\": %llu, "
+        "\"allocated_bytes\": %llu, \"peak_live_bytes\": %lld}\n",
+        (unsigned long long) alloc_stats.allocations, (unsigned long long) alloc_stats.reallocations,
+        (unsigned long long) alloc_stats.frees, (unsigned long long) alloc_stats.allocated_bytes,
+        (long long) alloc_stats.peak_live_bytes);
+    fprintf(file, "}\n");
+    return (ferror(file)) ? -1 : 0;
+}
+
+/* Private Methods */
+
+static double _get_clock(clockid_t clock){
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
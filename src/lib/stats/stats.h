@@ -0,0 +1,69 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Misure di un'esecuzione: il tempo reale e di CPU di ogni fase,
+ * le allocazioni fatte durante la fase (se il conteggio
+ * dell'allocatore è attivo) e dei contatori con nome.
+ */
+typedef struct Stats Stats;
+
+/**
+ * @brief Crea un insieme di misure vuoto
+ *
+ * @return Stats* Il puntatore alle misure create
+ * @return NULL Failure
+ */
+Stats *stats_new();
+
+/**
+ * @brief Libera la memoria riservata alle misure
+ *
+ * @param stats Le misure da distruggere
+ */
+void stats_destroy(Stats *stats);
+
+/**
+ * @brief Inizia una fase, terminando quella in corso
+ *
+ * @param name Il nome della fase, valido fino alla distruzione delle misure
+ * @param stats Le misure
+ * @return 0 Success
+ * @return -1 Sono già state misurate troppe fasi
+ */
+int stats_begin_phase(const char *name, Stats *stats);
+
+/**
+ * @brief Termina la fase in corso, se c'è
+ *
+ * @param stats Le misure
+ */
+void stats_end_phase(Stats *stats);
+
+/**
+ * @brief Imposta il valore di un contatore, aggiungendolo se non esiste.
+ * I contatori vengono scritti nell'ordine in cui sono stati aggiunti.
+ *
+ * @param name Il nome del contatore, valido fino alla distruzione delle misure
+ * @param value Il valore
+ * @param stats Le misure
+ * @return 0 Success
+ * @return -1 Sono già stati aggiunti troppi contatori
+ */
+int stats_set_counter(const char *name, uint64_t value, Stats *stats);
+
+/**
+ * @brief Scrive le misure in JSON: le fasi, i totali, i contatori,
+ * il picco della memoria residente e i conteggi dell'allocatore
+ *
+ * @param file Il file su cui scrivere
+ * @param stats Le misure
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int stats_write(FILE *file, const Stats *stats);
+
+#endif
@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tokenizer.h"
+#include "../charclass/charclass.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define BLOCK_SIZE (256 * 1024)
+
+static size_t _find_bit(const uint64_t *mask, size_t from, size_t to, bool value);
+static bool _any_bit(const uint64_t *mask, size_t from, size_t to);
+static int _fill(Tokenizer *tokenizer, size_t keep_from);
+static int _grow(Tokenizer *tokenizer);
+static ssize_t _read_fd(void *context, char *buffer, size_t size);
+
+/*
+ * Le maschere prodotte da charclass_scan() sono allineate al buffer:
+ * il bit i si riferisce a buffer[i]. Per questo una parola spezzata
+ * tra due blocchi viene spostata mantenendo la sua posizione modulo 64.
+ */
+typedef struct Tokenizer {
+    int fd;
+    TokenizerRead read;
+    void *context;
+    char *buffer;
+    uint64_t *delimiters;
+    uint64_t *non_alnum;
+    uint64_t *digits;
+    size_t capacity;
+    size_t position;
+    size_t end;
+    size_t bytes;
+    bool eof;
+} Tokenizer;
+
+Tokenizer *tokenizer_new(int fd){
+    Tokenizer *tokenizer = tokenizer_new_reader(_read_fd, NULL);
+    if(!tokenizer){
+        return NULL;
+    }
+    tokenizer->fd = fd;
+    tokenizer->context = &tokenizer->fd;
+    return tokenizer;
+}
+
+Tokenizer *tokenizer_new_reader(TokenizerRead read, void *context){
+    assert(read);
+    Tokenizer *tokenizer = calloc(1, sizeof(Tokenizer));
+    if(!tokenizer){
+        return NULL;
+    }
+    tokenizer->fd = -1;
+    tokenizer->read = read;
+    tokenizer->context = context;
+    if(_grow(tokenizer) < 0){
+        tokenizer_destroy(tokenizer);
+        return NULL;
+    }
+    return tokenizer;
+}
+
+void tokenizer_destroy(Tokenizer *tokenizer){
+    if(tokenizer){
+        free(tokenizer->buffer);
+        free(tokenizer->delimiters);
+        free(tokenizer->non_alnum);
+        free(tokenizer->digits);
+        free(tokenizer);
+    }
+}
+
+int tokenizer_next(Tokenizer *tokenizer, Token *token){
+    assert(tokenizer);
+    assert(token);
+    size_t start;
+    for(;;){
+        start = _find_bit(tokenizer->delimiters, tokenizer->position, tokenizer->end, false);
+        if(start < tokenizer->end){
+            break;
+        }
+        if(tokenizer->eof){
+            tokenizer->position = tokenizer->end;
+            return 0;
+        }
+        if(_fill(tokenizer, tokenizer->end) < 0){
+            return -1;
+        }
+    }
+    size_t stop;
+    for(;;){
+        stop = _find_bit(tokenizer->delimiters, start, tokenizer->end, true);
+        if(stop < tokenizer->end || tokenizer->eof){
+            break;
+        }
+        /* La parola prosegue nel blocco successivo */
+        if(_fill(tokenizer, start) < 0){
+            return -1;
+        }
+        start = tokenizer->position;
+    }
+    token->word = tokenizer->buffer + start;
+    token->length = stop - start;
+    token->is_alnum = !_any_bit(tokenizer->non_alnum, start, stop);
+    token->has_digits = _any_bit(tokenizer->digits, start, stop);
+    tokenizer->buffer[stop] = '\0';
+    tokenizer->position = (stop < tokenizer->end) ? stop + 1 : stop;
+    return 1;
+}
+
+size_t tokenizer_get_bytes(const Tokenizer *tokenizer){
+    assert(tokenizer);
+    return tokenizer->bytes;
+}
+
+/* Private Methods */
+
+static size_t _find_bit(const uint64_t *mask, size_t from, size_t to, bool value){
+    if(from >= to){
+        return to;
+    }
+    size_t word = from / 64;
+    uint64_t bits = (value ? mask[word] : ~mask[word]) & (~(uint64_t) 0 << (from % 64));
+    while(bits == 0){
+        word++;
+        if(word * 64 >= to){
+            return to;
+        }
+        bits = value ? mask[word] : ~mask[word];
+    }
+    size_t position = word * 64 + __builtin_ctzll(bits);
+    return (position < to) ? position : to;
+}
+
+static bool _any_bit(const uint64_t *mask, size_t from, size_t to){
+    return _find_bit(mask, from, to, true) < to;
+}
+
+/* Conserva i byte a partire da keep_from e accoda il blocco successivo */
+static int _fill(Tokenizer *tokenizer, size_t keep_from){
+    assert(keep_from <= tokenizer->end);
+    size_t kept = tokenizer->end - keep_from;
+    size_t offset = (kept > 0) ? keep_from % 64 : 0;
+    if(kept > 0 && keep_from >= 64){
+        size_t first_word = keep_from / 64, words = (tokenizer->end + 63) / 64 - first_word;
+        memmove(tokenizer->buffer + offset, tokenizer->buffer + keep_from, kept);
+        memmove(tokenizer->delimiters, tokenizer->delimiters + first_word, words * sizeof(uint64_t));
+        memmove(tokenizer->non_alnum, tokenizer->non_alnum + first_word, words * sizeof(uint64_t));
+        memmove(tokenizer->digits, tokenizer->digits + first_word, words * sizeof(uint64_t));
+    }
+    tokenizer->position = offset;
+    tokenizer->end = offset + kept;
+    if(tokenizer->end == tokenizer->capacity && _grow(tokenizer) < 0){
+        return -1;
+    }
+    ssize_t res = tokenizer->read(tokenizer->context, tokenizer->buffer + tokenizer->end, tokenizer->capacity - tokenizer->end);
+    if(res < 0){
+        return -1;
+    }
+    if(res == 0){
+        tokenizer->eof = true;
+        return 0;
+    }
+    size_t scan_from = tokenizer->end / 64 * 64;
+    tokenizer->end += res;
+    tokenizer->bytes += res;
+    charclass_scan(tokenizer->buffer + scan_from, tokenizer->end - scan_from,
+        tokenizer->delimiters + scan_from / 64,
+        tokenizer->non_alnum + scan_from / 64,
+        tokenizer->digits + scan_from / 64);
+    return 0;
+}
+
+static int _grow(Tokenizer *tokenizer){
+    size_t capacity = (tokenizer->capacity == 0) ? BLOCK_SIZE : tokenizer->capacity * 2;
+    size_t words = capacity / 64 + 1;
+    char *buffer = realloc(tokenizer->buffer, capacity + 1);
+    if(!buffer){
+        return -1;
+    }
+    tokenizer->buffer = buffer;
+    uint64_t **masks[] = {&tokenizer->delimiters, &tokenizer->non_alnum, &tokenizer->digits};
+    for(int i = 0; i < 3; i++){
+        uint64_t *mask = realloc(*masks[i], words * sizeof(uint64_t));
+        if(!mask){
+            return -1;
+        }
+        *masks[i] = mask;
+    }
+    tokenizer->capacity = capacity;
+    return 0;
+}
+
+static ssize_t _read_fd(void *context, char *buffer, size_t size){
+    int fd = *(int *) context;
+    ssize_t res;
+    do{
+        res = read(fd, buffer, size);
+    }while(res < 0 && errno == EINTR);
+    return res;
+}
@@ -0,0 +1,80 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+typedef struct Tokenizer Tokenizer;
+
+/**
+ * @brief Funzione da cui il tokenizer legge i blocchi, con la
+ * stessa semantica di read(): restituisce il numero di byte
+ * letti, 0 alla fine del file e -1 in caso di errore.
+ */
+typedef ssize_t (*TokenizerRead)(void *context, char *buffer, size_t size);
+
+/**
+ * Una parola letta dal tokenizer.
+ * word punta all'interno del blocco letto, è terminata da '\0'
+ * e resta valida fino alla chiamata successiva di tokenizer_next().
+ */
+typedef struct Token {
+    char *word;
+    size_t length;
+    bool is_alnum;
+    bool has_digits;
+} Token;
+
+/**
+ * @brief Crea un tokenizer che legge il file descriptor
+ * specificato a blocchi. Il file descriptor non viene
+ * chiuso dal tokenizer.
+ * 
+ * @param fd Il file descriptor da cui leggere
+ * @return Tokenizer* Il puntatore al tokenizer creato
+ * @return NULL Failure
+ */
+Tokenizer *tokenizer_new(int fd);
+
+/**
+ * @brief Crea un tokenizer che legge i blocchi dalla funzione
+ * specificata invece che da un file descriptor
+ * 
+ * @param read La funzione da cui leggere
+ * @param context Il contesto passato alla funzione
+ * @return Tokenizer* Il puntatore al tokenizer creato
+ * @return NULL Failure
+ */
+Tokenizer *tokenizer_new_reader(TokenizerRead read, void *context);
+
+/**
+ * @brief Libera la memoria riservata al tokenizer
+ * 
+ * @param tokenizer Il tokenizer da distruggere
+ */
+void tokenizer_destroy(Tokenizer *tokenizer);
+
+/**
+ * @brief Legge la parola successiva, delimitata da spazi,
+ * convertendola in minuscolo. La parola non viene copiata.
+ * Oltre alla parola viene indicato se questa è composta solo
+ * da caratteri alfanumerici e se contiene delle cifre.
+ * 
+ * @param tokenizer Il tokenizer da cui leggere
+ * @param token Il Token in cui salvare la parola letta
+ * @return 1 È stata letta una parola
+ * @return 0 Il file è terminato
+ * @return -1 Failure
+ */
+int tokenizer_next(Tokenizer *tokenizer, Token *token);
+
+/**
+ * @brief Restituisce il numero di byte letti finora
+ * 
+ * @param tokenizer Il tokenizer
+ * @return size_t Il numero di byte letti
+ */
+size_t tokenizer_get_bytes(const Tokenizer *tokenizer);
+
+#endif
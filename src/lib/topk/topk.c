@@ -0,0 +1,171 @@
+#include "topk.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+typedef struct _Entry _Entry;
+
+static bool _ranks_higher(int occurrences, const char *word, const _Entry *entry);
+static void _sift_up(size_t position, TopK *topk);
+static void _sift_down(size_t position, TopK *topk);
+static void _swap(size_t a, size_t b, TopK *topk);
+static int _set_word(_Entry *entry, const char *word);
+static int _compare_entries(const void *a, const void *b);
+
+/*
+ * Min-heap rispetto all'ordine di uscita: la radice è la parola
+ * che verrebbe scartata per prima.
+ */
+typedef struct TopK {
+    _Entry *entries;
+    size_t count;
+    size_t k;
+} TopK;
+
+typedef struct _Entry {
+    int occurrences;
+    char *word;
+    size_t capacity;
+} _Entry;
+
+TopK *topk_new(size_t k){
+    assert(k > 0);
+    TopK *topk = calloc(1, sizeof(TopK));
+    if(!topk){
+        return NULL;
+    }
+    topk->entries = calloc(k, sizeof(_Entry));
+    if(!topk->entries){
+        free(topk);
+        return NULL;
+    }
+    topk->k = k;
+    return topk;
+}
+
+void topk_destroy(TopK *topk){
+    if(topk){
+        for(size_t i = 0; i < topk->count; i++){
+            free(topk->entries[i].word);
+        }
+        free(topk->entries);
+        free(topk);
+    }
+}
+
+int topk_offer(const char *word, int occurrences, TopK *topk){
+    assert(word);
+    assert(topk);
+    if(topk->count < topk->k){
+        _Entry *entry = &topk->entries[topk->count];
+        if(_set_word(entry, word) < 0){
+            return -1;
+        }
+        entry->occurrences = occurrences;
+        topk->count++;
+        _sift_up(topk->count - 1, topk);
+        return 0;
+    }
+    if(!_ranks_higher(occurrences, word, &topk->entries[0])){
+        return 0;
+    }
+    /* La parola rimpiazza la radice riusandone il buffer */
+    if(_set_word(&topk->entries[0], word) < 0){
+        return -1;
+    }
+    topk->entries[0].occurrences = occurrences;
+    _sift_down(0, topk);
+    return 0;
+}
+
+int topk_visit(const TopK *topk, TopKVisitor visitor, void *context){
+    assert(topk);
+    assert(visitor);
+    if(topk->count == 0){
+        return 0;
+    }
+    const _Entry **sorted = malloc(topk->count * sizeof(_Entry *));
+    if(!sorted){
+        return -1;
+    }
+    for(size_t i = 0; i < topk->count; i++){
+        sorted[i] = &topk->entries[i];
+    }
+    qsort(sorted, topk->count, sizeof(_Entry *), _compare_entries);
+    int res = 0;
+    for(size_t i = 0; res == 0 && i < topk->count; i++){
+        res = visitor(sorted[i]->word, sorted[i]->occurrences, context);
+    }
+    free(sorted);
+    return res;
+}
+
+/* Private Methods */
+
+static bool _ranks_higher(int occurrences, const char *word, const _Entry *entry){
+    if(occurrences != entry->occurrences){
+        return occurrences > entry->occurrences;
+    }
+    return strcmp(word, entry->word) < 0;
+}
+
+static void _sift_up(size_t position, TopK *topk){
+    while(position > 0){
+        size_t parent = (position - 1) / 2;
+        _Entry *entry = &topk->entries[position];
+        if(!_ranks_higher(topk->entries[parent].occurrences, topk->entries[parent].word, entry)){
+            break;
+        }
+        _swap(position, parent, topk);
+        position = parent;
+    }
+}
+
+static void _sift_down(size_t position, TopK *topk){
+    for(;;){
+        size_t lowest = position;
+        size_t left = 2 * position + 1, right = left + 1;
+        if(left < topk->count && _ranks_higher(topk->entries[lowest].occurrences, topk->entries[lowest].word, &topk->entries[left])){
+            lowest = left;
+        }
+        if(right < topk->count && _ranks_higher(topk->entries[lowest].occurrences, topk->entries[lowest].word, &topk->entries[right])){
+            lowest = right;
+        }
+        if(lowest == position){
+            return;
+        }
+        _swap(position, lowest, topk);
+        position = lowest;
+    }
+}
+
+static void _swap(size_t a, size_t b, TopK *topk){
+    _Entry entry = topk->entries[a];
+    topk->entries[a] = topk->entries[b];
+    topk->entries[b] = entry;
+}
+
+static int _set_word(_Entry *entry, const char *word){
+    size_t length = strlen(word) + 1;
+    if(length > entry->capacity){
+        char *buffer = realloc(entry->word, length);
+        if(!buffer){
+            return -1;
+        }
+        entry->word = buffer;
+        entry->capacity = length;
+    }
+    memcpy(entry->word, word, length);
+    return 0;
+}
+
+static int _compare_entries(const void *a, const void *b){
+    const _Entry *first = *(const _Entry * const *) a;
+    const _Entry *second = *(const _Entry * const *) b;
+    if(first->occurrences != second->occurrences){
+        return (first->occurrences > second->occurrences) ? -1 : 1;
+    }
+    return strcmp(first->word, second->word);
+}
@@ -0,0 +1,61 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <stddef.h>
+
+typedef struct TopK TopK;
+
+/**
+ * @brief Funzione invocata da topk_visit() per ogni parola
+ * selezionata.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*TopKVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Crea una selezione delle k parole con più occorrenze.
+ * Le parole vengono mantenute in un min-heap di al più k elementi,
+ * quindi la memoria occupata non dipende dal numero di parole offerte.
+ * 
+ * @param k Il numero massimo di parole da mantenere
+ * @return TopK* Il puntatore alla selezione creata
+ * @return NULL Failure
+ */
+TopK *topk_new(size_t k);
+
+/**
+ * @brief Libera la memoria riservata alla selezione
+ * 
+ * @param topk La selezione da distruggere
+ */
+void topk_destroy(TopK *topk);
+
+/**
+ * @brief Propone una parola con il suo numero totale di occorrenze.
+ * Ogni parola deve essere proposta una sola volta.
+ * A parità di occorrenze viene preferita la parola
+ * alfabeticamente minore.
+ * 
+ * @param word La parola da proporre
+ * @param occurrences Le occorrenze della parola
+ * @param topk La selezione a cui proporre la parola
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int topk_offer(const char *word, int occurrences, TopK *topk);
+
+/**
+ * @brief Visita le parole selezionate in ordine decrescente
+ * di occorrenze; le parole con le stesse occorrenze vengono
+ * visitate in ordine alfabetico.
+ * 
+ * @param topk La selezione da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int topk_visit(const TopK *topk, TopKVisitor visitor, void *context);
+
+#endif
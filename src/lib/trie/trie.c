@@ -1,7 +1,7 @@
 #include "trie.h"
 #include "../list/list.h"
+#include "../arena/arena.h"
 
-#include <ctype.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
@@ -9,79 +9,186 @@
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 
 #define ALPHABET 36
+#define PREFIX_MAX 9
+
+/*
+ * Un riferimento a un nodo contiene nei due bit più alti il tipo
+ * del nodo e nei restanti l'indice del nodo nell'arena del suo tipo.
+ */
+#define NODE_NULL 0
+#define REF_TYPE_SHIFT 30
+#define REF_INDEX_MASK (((uint32_t) 1 << REF_TYPE_SHIFT) - 1)
+
+typedef enum _NodeType {
+    NODE4,
+    NODE16,
+    NODE36,
+    NODE_TYPES
+} _NodeType;
 
 typedef struct _TrieNode _TrieNode;
+typedef struct _VisitState _VisitState;
+typedef struct _VisitFrame _VisitFrame;
+typedef struct _RankedWord _RankedWord;
+typedef struct _Ranking _Ranking;
 
-static _TrieNode *_node_new(const char prefix, _TrieNode *parent);
-static void _node_destroy(_TrieNode *node);
-static bool _word_format_is_valid(const char *word);
-static void _node_insert(const char *word, int occurrences, _TrieNode *node);
-static _TrieNode *_get_last_word_node(const char *word, _TrieNode *node);
+static Trie *_trie_new(bool huge_pages);
+static uint32_t _node_new(_NodeType type, Trie *trie);
+static void _node_free(uint32_t ref, Trie *trie);
+static _TrieNode *_node_get(uint32_t ref, const Trie *trie);
+static _NodeType _get_type(uint32_t ref);
+static char _map_char(const char ch);
+static _TrieNode *_node_insert(const char *word, size_t length, int occurrences, Trie *trie);
+static uint32_t _chain_new(const char *word, size_t length, int occurrences, Trie *trie);
+static void _chain_free(uint32_t ref, Trie *trie);
+static int _split_prefix(uint32_t *slot, uint8_t matched, Trie *trie);
+static _TrieNode *_get_last_word_node(const char *word, size_t length, const Trie *trie);
+static uint32_t *_get_child(_TrieNode *node, _NodeType type, const char key);
+static int _add_child(uint32_t *slot, const char key, uint32_t child, Trie *trie);
+static uint32_t _get_child_at(const _TrieNode *node, _NodeType type, int *position, char *key);
 static int _get_children_array_pos(const char prefix);
-static void _collect_words(const _TrieNode *node, List *wordlist, char *word);
+static char _get_prefix_from_pos(int pos);
+static int _append_word_info(const char *word, int occurrences, void *wordlist);
+static int _merge_word(const char *word, int occurrences, void *destination);
+static int _visit_push(uint32_t ref, size_t depth, _VisitState *state);
+static int _rank_word(const char *word, int occurrences, void *ranking);
+static int _sort_by_occurrences(_Ranking *ranking);
 
+/*
+ * Trie adattivo: ogni nodo ha un tipo che dipende dal numero dei
+ * figli (fino a 4, fino a 16, fino a ALPHABET) ed è allocato
+ * nell'arena del suo tipo. Le catene di nodi con un solo figlio
+ * sono compresse nel prefisso del nodo.
+ */
 typedef struct Trie {
-    _TrieNode *root;
+    Arena *nodes[NODE_TYPES];
+    uint32_t root;
 } Trie;
 
+/*
+ * Il nodo rappresenta la stringa formata dal percorso che lo
+ * raggiunge seguita dai prefix_length caratteri di prefix.
+ */
 typedef struct _TrieNode {
-    char prefix;
     int occurrences;
-    bool is_leaf;
+    uint8_t children_count;
+    uint8_t prefix_length;
     bool is_word;
-    struct _TrieNode *children[ALPHABET];
-    struct _TrieNode *parent;
+    char prefix[PREFIX_MAX];
 } _TrieNode;
 
+typedef struct _Node4 {
+    _TrieNode header;
+    char keys[4];
+    uint32_t children[4];
+} _Node4;
+
+typedef struct _Node16 {
+    _TrieNode header;
+    char keys[16];
+    uint32_t children[16];
+} _Node16;
+
+typedef struct _Node36 {
+    _TrieNode header;
+    uint32_t children[ALPHABET];
+} _Node36;
+
+static const size_t _node_sizes[NODE_TYPES] = {sizeof(_Node4), sizeof(_Node16), sizeof(_Node36)};
+static const int _node_capacities[NODE_TYPES] = {4, 16, ALPHABET};
+
+typedef struct _VisitFrame {
+    uint32_t ref;
+    size_t length;
+    int position;
+} _VisitFrame;
+
+typedef struct _VisitState {
+    const Trie *trie;
+    char *word;
+    size_t capacity;
+    _VisitFrame *frames;
+    size_t frames_count;
+    size_t frames_capacity;
+} _VisitState;
+
+typedef struct _RankedWord {
+    uint32_t key;
+    size_t offset;
+} _RankedWord;
+
+/* Le parole in ordine alfabetico, copiate una di seguito all'altra in pool */
+typedef struct _Ranking {
+    _RankedWord *words;
+    size_t words_count;
+    size_t words_capacity;
+    char *pool;
+    size_t pool_length;
+    size_t pool_capacity;
+} _Ranking;
+
 Trie *trie_new(){
-    Trie *trie = malloc(sizeof(Trie));
-    if(!trie){
-        return NULL;
-    }
-    trie->root = _node_new('\0', NULL);
-    if(!trie->root){
-        free(trie);
-        return NULL;
-    }
-    return trie;
+    return _trie_new(false);
+}
+
+Trie *trie_new_huge_pages(){
+    return _trie_new(true);
 }
 
 void trie_destroy(Trie *trie){
     if(trie){
-        _node_destroy(trie->root);
+        for(int i = 0; i < NODE_TYPES; i++){
+            arena_destroy(trie->nodes[i]);
+        }
         free(trie);
     }
 }
 
 int trie_insert(const char *word, Trie *trie){
     assert(trie);
-    if(strlen(word) == 0 || !_word_format_is_valid(word)){
-        errno = EINVAL;
-        return -1;
-    }
-    _node_insert(word, 1, trie->root);
-    return 0;
+    return (trie_insert_n(word, strlen(word), 1, trie) < 0) ? -1 : 0;
 }
 
 int trie_insert_with_occ(const char *word, int occurrences, Trie *trie){
     assert(trie);
-    if(strlen(word) == 0 || !_word_format_is_valid(word)){
+    return (trie_insert_n(word, strlen(word), occurrences, trie) < 0) ? -1 : 0;
+}
+
+int trie_insert_n(const char *word, size_t length, int occurrences, Trie *trie){
+    assert(trie);
+    if(length == 0 || occurrences < 1){
         errno = EINVAL;
         return -1;
     }
-    if(occurrences < 1){
+    _TrieNode *node = _node_insert(word, length, occurrences, trie);
+    return (node != NULL) ? node->occurrences : -1;
+}
+
+int trie_subtract_n(const char *word, size_t length, int occurrences, Trie *trie){
+    assert(trie);
+    if(length == 0 || occurrences < 1){
         errno = EINVAL;
         return -1;
     }
-    _node_insert(word, occurrences, trie->root);
-    return 0;
+    _TrieNode *node = _get_last_word_node(word, length, trie);
+    if(!node){
+        return 0;
+    }
+    node->occurrences -= occurrences;
+    if(node->occurrences <= 0){
+        node->occurrences = 0;
+        node->is_word = false;
+    }
+    return node->occurrences;
 }
 
 void trie_remove(const char *word, Trie *trie){
     assert(trie);
-    _TrieNode *node = _get_last_word_node(word, trie->root);
+    _TrieNode *node = _get_last_word_node(word, strlen(word), trie);
     if(node){
         node->occurrences = 0;
         node->is_word = false;
@@ -90,18 +197,25 @@ void trie_remove(const char *word, Trie *trie){
 
 bool trie_contains(const char *word, const Trie *trie){
     assert(trie);
-    if(strlen(word) == 0 || !_word_format_is_valid(word)){
-        return false;
-    }
-    return (_get_last_word_node(word, trie->root) != NULL);
+    return trie_contains_n(word, strlen(word), trie);
+}
+
+bool trie_contains_n(const char *word, size_t length, const Trie *trie){
+    assert(trie);
+    return (length > 0 && _get_last_word_node(word, length, trie) != NULL);
 }
 
 int trie_get_word_occurrences(const char *word, const Trie *trie){
     assert(trie);
-    if(strlen(word) == 0 || !_word_format_is_valid(word)){
+    return trie_get_word_occurrences_n(word, strlen(word), trie);
+}
+
+int trie_get_word_occurrences_n(const char *word, size_t length, const Trie *trie){
+    assert(trie);
+    if(length == 0){
         return 0;
     }
-    _TrieNode *node = _get_last_word_node(word, trie->root);
+    _TrieNode *node = _get_last_word_node(word, length, trie);
     return (node != NULL) ? node->occurrences : 0;
 }
 
@@ -111,123 +225,546 @@ List *trie_get_wordlist(const Trie *trie){
     if(!wordlist){
         return NULL;
     }
-    _collect_words(trie->root, wordlist, '\0');
-    if(!wordlist){
+    if(trie_visit(trie, _append_word_info, wordlist) != 0){
+        list_destroy(wordlist);
         return NULL;
     }
     return wordlist;
 }
 
+int trie_visit(const Trie *trie, TrieVisitor visitor, void *context){
+    assert(trie);
+    assert(visitor);
+    _VisitState state;
+    state.trie = trie;
+    state.capacity = 64;
+    state.word = malloc(state.capacity);
+    state.frames_count = 0;
+    state.frames_capacity = 16;
+    state.frames = malloc(state.frames_capacity * sizeof(_VisitFrame));
+    int res = 0;
+    if(!state.word || !state.frames || _visit_push(trie->root, 0, &state) < 0){
+        res = -1;
+    }
+    while(res == 0 && state.frames_count > 0){
+        _VisitFrame *frame = &state.frames[state.frames_count - 1];
+        if(frame->position < 0){
+            /* Prima visita del nodo */
+            frame->position = 0;
+            _TrieNode *node = _node_get(frame->ref, trie);
+            if(node->is_word){
+                state.word[frame->length] = '\0';
+                res = visitor(state.word, node->occurrences, context);
+                continue;
+            }
+        }
+        char key;
+        uint32_t child = _get_child_at(_node_get(frame->ref, trie), _get_type(frame->ref), &frame->position, &key);
+        if(child == NODE_NULL){
+            state.frames_count--;
+        } else {
+            size_t length = frame->length;
+            state.word[length] = key;
+            if(_visit_push(child, length + 1, &state) < 0){
+                res = -1;
+            }
+        }
+    }
+    free(state.word);
+    free(state.frames);
+    return res;
+}
+
+int trie_visit_by_occurrences(const Trie *trie, TrieVisitor visitor, void *context){
+    assert(trie);
+    assert(visitor);
+    _Ranking ranking = {0};
+    int res = trie_visit(trie, _rank_word, &ranking);
+    if(res == 0){
+        res = _sort_by_occurrences(&ranking);
+    }
+    for(size_t i = 0; res == 0 && i < ranking.words_count; i++){
+        _RankedWord *ranked = &ranking.words[i];
+        res = visitor(ranking.pool + ranked->offset, ~ranked->key, context);
+    }
+    free(ranking.words);
+    free(ranking.pool);
+    return res;
+}
+
+int trie_merge(const Trie *source, Trie *destination){
+    assert(source);
+    assert(destination);
+    return trie_visit(source, _merge_word, destination);
+}
+
+size_t trie_get_nodes_count(const Trie *trie){
+    assert(trie);
+    size_t count = 0;
+    for(int i = 0; i < NODE_TYPES; i++){
+        count += arena_get_elements_count(trie->nodes[i]);
+    }
+    return count;
+}
+
+size_t trie_get_memory_usage(const Trie *trie){
+    assert(trie);
+    size_t usage = sizeof(Trie);
+    for(int i = 0; i < NODE_TYPES; i++){
+        usage += arena_get_memory_usage(trie->nodes[i]);
+    }
+    return usage;
+}
+
 /* Private Methods */
 
-static _TrieNode *_node_new(const char prefix, _TrieNode *parent){
-    _TrieNode *node = malloc(sizeof(_TrieNode));
-    if(!node){
+static Trie *_trie_new(bool huge_pages){
+    Trie *trie = calloc(1, sizeof(Trie));
+    if(!trie){
         return NULL;
     }
-    node->prefix = prefix;
-    for(int i = 0; i<ALPHABET; i++){
-        node->children[i] = NULL;
+    for(int i = 0; i < NODE_TYPES; i++){
+        trie->nodes[i] = arena_new(_node_sizes[i], huge_pages);
+        if(!trie->nodes[i]){
+            trie_destroy(trie);
+            return NULL;
+        }
     }
-    node->occurrences = 0;
-    node->is_word = false;
-    node->is_leaf = true;
-    node->parent = parent;
-    return node;
+    trie->root = _node_new(NODE4, trie);
+    if(trie->root == NODE_NULL){
+        trie_destroy(trie);
+        return NULL;
+    }
+    return trie;
 }
 
-static void _node_destroy(_TrieNode *node){
-    if(node){
-        for(int i = 0; i < ALPHABET; i++){
-            _node_destroy(node->children[i]);
+static uint32_t _node_new(_NodeType type, Trie *trie){
+    uint32_t index = arena_alloc(trie->nodes[type]);
+    if(index == ARENA_NULL){
+        return NODE_NULL;
+    }
+    if(index > REF_INDEX_MASK){
+        arena_free(index, trie->nodes[type]);
+        errno = ENOMEM;
+        return NODE_NULL;
+    }
+    return ((uint32_t) type << REF_TYPE_SHIFT) | index;
+}
+
+static void _node_free(uint32_t ref, Trie *trie){
+    arena_free(ref & REF_INDEX_MASK, trie->nodes[_get_type(ref)]);
+}
+
+static _TrieNode *_node_get(uint32_t ref, const Trie *trie){
+    return arena_get(ref & REF_INDEX_MASK, trie->nodes[_get_type(ref)]);
+}
+
+static _NodeType _get_type(uint32_t ref){
+    return ref >> REF_TYPE_SHIFT;
+}
+
+/* Restituisce il carattere in minuscolo se è alfanumerico, '\0' altrimenti */
+static char _map_char(const char ch){
+    char lower = ch | ('a' - 'A');
+    if(lower >= 'a' && lower <= 'z'){
+        return lower;
+    }
+    if(ch >= '0' && ch <= '9'){
+        return ch;
+    }
+    return '\0';
+}
+
+/*
+ * Scende nel Trie senza ricorsione: ogni carattere viene convertito
+ * e validato una sola volta, e i caratteri che mancano nel Trie
+ * vengono validati prima di modificarne i nodi.
+ */
+static _TrieNode *_node_insert(const char *word, size_t length, int occurrences, Trie *trie){
+    size_t i = 0;
+    uint32_t *slot = &trie->root;
+    for(;;){
+        _TrieNode *node = _node_get(*slot, trie);
+        uint8_t matched = 0;
+        while(matched < node->prefix_length && i < length && _map_char(word[i]) == node->prefix[matched]){
+            matched++;
+            i++;
+        }
+        if(i == length){
+            if(matched < node->prefix_length){
+                if(_split_prefix(slot, matched, trie) < 0){
+                    return NULL;
+                }
+                node = _node_get(*slot, trie);
+            }
+            /* Un conteggio che supererebbe INT_MAX fa fallire l'inserimento invece di traboccare */
+            if(node->occurrences > INT_MAX - occurrences){
+                errno = EOVERFLOW;
+                return NULL;
+            }
+            node->occurrences += occurrences;
+            node->is_word = true;
+            return node;
+        }
+        char key = _map_char(word[i]);
+        if(key == '\0'){
+            errno = EINVAL;
+            return NULL;
+        }
+        uint32_t *child = NULL;
+        if(matched == node->prefix_length){
+            child = _get_child(node, _get_type(*slot), key);
+        }
+        if(child == NULL){
+            uint32_t chain = _chain_new(word + i + 1, length - i - 1, occurrences, trie);
+            if(chain == NODE_NULL){
+                return NULL;
+            }
+            if( (matched < node->prefix_length && _split_prefix(slot, matched, trie) < 0)
+                || _add_child(slot, key, chain, trie) < 0){
+                _chain_free(chain, trie);
+                return NULL;
+            }
+            _TrieNode *last = _node_get(chain, trie);
+            while(last->children_count > 0){
+                chain = ((_Node4 *) last)->children[0];
+                last = _node_get(chain, trie);
+            }
+            return last;
+        }
+        slot = child;
+        i++;
+    }
+}
+
+/* Crea la catena di nodi che rappresenta la parola, con le occorrenze sull'ultimo */
+static uint32_t _chain_new(const char *word, size_t length, int occurrences, Trie *trie){
+    uint32_t first = NODE_NULL;
+    uint32_t *link = &first;
+    for(;;){
+        uint32_t ref = _node_new(NODE4, trie);
+        if(ref == NODE_NULL){
+            _chain_free(first, trie);
+            return NODE_NULL;
+        }
+        *link = ref;
+        _Node4 *node = (_Node4 *) _node_get(ref, trie);
+        uint8_t prefix_length = (length < PREFIX_MAX) ? length : PREFIX_MAX;
+        for(uint8_t j = 0; j <= prefix_length && j < length; j++){
+            char key = _map_char(word[j]);
+            if(key == '\0'){
+                _chain_free(first, trie);
+                errno = EINVAL;
+                return NODE_NULL;
+            }
+            if(j < prefix_length){
+                node->header.prefix[j] = key;
+            } else {
+                node->keys[0] = key;
+                node->header.children_count = 1;
+            }
+        }
+        node->header.prefix_length = prefix_length;
+        if(length == prefix_length){
+            node->header.occurrences = occurrences;
+            node->header.is_word = true;
+            return first;
+        }
+        link = &node->children[0];
+        word += prefix_length + 1;
+        length -= prefix_length + 1;
+    }
+}
+
+static void _chain_free(uint32_t ref, Trie *trie){
+    while(ref != NODE_NULL){
+        _Node4 *node = (_Node4 *) _node_get(ref, trie);
+        uint32_t next = (node->header.children_count > 0) ? node->children[0] : NODE_NULL;
+        _node_free(ref, trie);
+        ref = next;
+    }
+}
+
+/* Divide il prefisso del nodo dopo i primi matched caratteri */
+static int _split_prefix(uint32_t *slot, uint8_t matched, Trie *trie){
+    uint32_t ref = _node_new(NODE4, trie);
+    if(ref == NODE_NULL){
+        return -1;
+    }
+    _Node4 *parent = (_Node4 *) _node_get(ref, trie);
+    _TrieNode *node = _node_get(*slot, trie);
+    memcpy(parent->header.prefix, node->prefix, matched);
+    parent->header.prefix_length = matched;
+    parent->keys[0] = node->prefix[matched];
+    parent->children[0] = *slot;
+    parent->header.children_count = 1;
+    node->prefix_length -= matched + 1;
+    memmove(node->prefix, node->prefix + matched + 1, node->prefix_length);
+    *slot = ref;
+    return 0;
+}
+
+static _TrieNode *_get_last_word_node(const char *word, size_t length, const Trie *trie){
+    uint32_t ref = trie->root;
+    size_t i = 0;
+    for(;;){
+        _TrieNode *node = _node_get(ref, trie);
+        if(length - i < node->prefix_length){
+            return NULL;
+        }
+        for(uint8_t j = 0; j < node->prefix_length; j++, i++){
+            if(_map_char(word[i]) != node->prefix[j]){
+                return NULL;
+            }
+        }
+        if(i == length){
+            return (node->is_word) ? node : NULL;
         }
-        free(node);
+        char key = _map_char(word[i]);
+        if(key == '\0'){
+            return NULL;
+        }
+        uint32_t *child = _get_child(node, _get_type(ref), key);
+        if(child == NULL){
+            return NULL;
+        }
+        ref = *child;
+        i++;
     }
 }
 
-static bool _word_format_is_valid(const char *word){
-    assert(word);
-    for(int i = 0; i != strlen(word); i++){
-        if(!isalnum(word[i])){
-            return false;
+static uint32_t *_get_child(_TrieNode *node, _NodeType type, const char key){
+    switch(type){
+        case NODE4: {
+            _Node4 *node4 = (_Node4 *) node;
+            for(int j = 0; j < node->children_count; j++){
+                if(node4->keys[j] == key){
+                    return &node4->children[j];
+                }
+            }
+            return NULL;
+        }
+        case NODE16: {
+            _Node16 *node16 = (_Node16 *) node;
+            for(int j = 0; j < node->children_count; j++){
+                if(node16->keys[j] == key){
+                    return &node16->children[j];
+                }
+            }
+            return NULL;
+        }
+        default: {
+            int pos = _get_children_array_pos(key);
+            _Node36 *node36 = (_Node36 *) node;
+            return (node36->children[pos] != NODE_NULL) ? &node36->children[pos] : NULL;
         }
     }
-    return true;
 }
 
-static void _node_insert(const char *word, int occurrences, _TrieNode *node){
-    assert(node);
-    if(strlen(word) == 0){
-        node->occurrences += occurrences;
-        node->is_word = true;
+/* Aggiunge un figlio al nodo, sostituendolo con uno più capiente se è pieno */
+static int _add_child(uint32_t *slot, const char key, uint32_t child, Trie *trie){
+    _NodeType type = _get_type(*slot);
+    _TrieNode *node = _node_get(*slot, trie);
+    if(node->children_count == _node_capacities[type]){
+        assert(type != NODE36);
+        uint32_t ref = _node_new(type + 1, trie);
+        if(ref == NODE_NULL){
+            return -1;
+        }
+        _TrieNode *grown = _node_get(ref, trie);
+        *grown = *node;
+        if(type == NODE4){
+            _Node4 *old = (_Node4 *) node;
+            _Node16 *node16 = (_Node16 *) grown;
+            memcpy(node16->keys, old->keys, sizeof(old->keys));
+            memcpy(node16->children, old->children, sizeof(old->children));
+        } else {
+            _Node16 *old = (_Node16 *) node;
+            _Node36 *node36 = (_Node36 *) grown;
+            for(int j = 0; j < old->header.children_count; j++){
+                node36->children[_get_children_array_pos(old->keys[j])] = old->children[j];
+            }
+        }
+        _node_free(*slot, trie);
+        *slot = ref;
+        type++;
+        node = grown;
+    }
+    if(type == NODE36){
+        ((_Node36 *) node)->children[_get_children_array_pos(key)] = child;
     } else {
-        char next_prefix = tolower(word[0]);
-        int next_child_index = _get_children_array_pos(next_prefix);
-        assert(next_child_index != -1);
-        if(node->children[next_child_index] == NULL){
-            node->children[next_child_index] = _node_new(next_prefix, node);
-            assert(node->children[next_child_index]);
-            if(node->is_leaf){
-            node->is_leaf = false;
-            }
-        }   
-        _node_insert(word+1, occurrences, node->children[next_child_index]);
-    }   
-}
-
-static _TrieNode *_get_last_word_node(const char *word, _TrieNode *node){
-    assert(node);
-    if(strlen(word) == 0 && node->is_word == true){
-        return node;
-    }
-    char next_prefix = tolower(word[0]);
-    int next_child_index = _get_children_array_pos(next_prefix);
-    if(next_child_index == -1){
-        return NULL;
+        char *keys = (type == NODE4) ? ((_Node4 *) node)->keys : ((_Node16 *) node)->keys;
+        uint32_t *children = (type == NODE4) ? ((_Node4 *) node)->children : ((_Node16 *) node)->children;
+        int j = node->children_count;
+        while(j > 0 && keys[j - 1] > key){
+            keys[j] = keys[j - 1];
+            children[j] = children[j - 1];
+            j--;
+        }
+        keys[j] = key;
+        children[j] = child;
     }
-    _TrieNode *next_child = node->children[next_child_index];
-    if(next_child == NULL){
-        return NULL;
+    node->children_count++;
+    return 0;
+}
+
+/* Restituisce, in ordine alfabetico, il figlio successivo a position */
+static uint32_t _get_child_at(const _TrieNode *node, _NodeType type, int *position, char *key){
+    switch(type){
+        case NODE4: {
+            const _Node4 *node4 = (const _Node4 *) node;
+            if(*position >= node->children_count){
+                return NODE_NULL;
+            }
+            *key = node4->keys[*position];
+            return node4->children[(*position)++];
+        }
+        case NODE16: {
+            const _Node16 *node16 = (const _Node16 *) node;
+            if(*position >= node->children_count){
+                return NODE_NULL;
+            }
+            *key = node16->keys[*position];
+            return node16->children[(*position)++];
+        }
+        default: {
+            const _Node36 *node36 = (const _Node36 *) node;
+            while(*position < ALPHABET && node36->children[*position] == NODE_NULL){
+                (*position)++;
+            }
+            if(*position == ALPHABET){
+                return NODE_NULL;
+            }
+            *key = _get_prefix_from_pos(*position);
+            return node36->children[(*position)++];
+        }
     }
-    return _get_last_word_node(word + 1, next_child);
 }
 
 static int _get_children_array_pos(const char prefix){
-    int index = -1;
-    if(isalpha(prefix)){
-        index = prefix - 'a' + 10;
+    return (prefix <= '9') ? prefix - '0' : prefix - 'a' + 10;
+}
+
+static char _get_prefix_from_pos(int pos){
+    return (pos < 10) ? '0' + pos : 'a' + pos - 10;
+}
+
+static int _append_word_info(const char *word, int occurrences, void *wordlist){
+    size_t len = strlen(word) + 1 + 11 + 1;
+    char *word_info = malloc(len);
+    if(!word_info){
+        return -1;
+    }
+    snprintf(word_info, len, "%s %d", word, occurrences);
+    int res = list_append(word_info, wordlist);
+    free(word_info);
+    return res;
+}
+
+static int _merge_word(const char *word, int occurrences, void *destination){
+    return (_node_insert(word, strlen(word), occurrences, destination) != NULL) ? 0 : -1;
+}
+
+/* Aggiunge il nodo alla pila della visita, accodandone il prefisso alla parola */
+static int _visit_push(uint32_t ref, size_t depth, _VisitState *state){
+    _TrieNode *node = _node_get(ref, state->trie);
+    size_t length = depth + node->prefix_length;
+    if(length + 1 > state->capacity){
+        size_t capacity = state->capacity;
+        while(length + 1 > capacity){
+            capacity *= 2;
+        }
+        char *word = realloc(state->word, capacity);
+        if(!word){
+            return -1;
+        }
+        state->word = word;
+        state->capacity = capacity;
     }
-    else if(isdigit(prefix)){
-        index = prefix - '0';
+    if(state->frames_count == state->frames_capacity){
+        _VisitFrame *frames = realloc(state->frames, state->frames_capacity * 2 * sizeof(_VisitFrame));
+        if(!frames){
+            return -1;
+        }
+        state->frames = frames;
+        state->frames_capacity *= 2;
     }
-    if(index > 35 || index < 0){
-        return -1;
+    memcpy(state->word + depth, node->prefix, node->prefix_length);
+    _VisitFrame *frame = &state->frames[state->frames_count++];
+    frame->ref = ref;
+    frame->length = length;
+    frame->position = -1;
+    return 0;
+}
+
+static int _rank_word(const char *word, int occurrences, void *context){
+    _Ranking *ranking = context;
+    size_t length = strlen(word) + 1;
+    if(ranking->words_count == ranking->words_capacity){
+        size_t capacity = (ranking->words_capacity == 0) ? 1024 : ranking->words_capacity * 2;
+        _RankedWord *words = realloc(ranking->words, capacity * sizeof(_RankedWord));
+        if(!words){
+            return -1;
+        }
+        ranking->words = words;
+        ranking->words_capacity = capacity;
+    }
+    if(ranking->pool_length + length > ranking->pool_capacity){
+        size_t capacity = (ranking->pool_capacity == 0) ? 16384 : ranking->pool_capacity;
+        while(ranking->pool_length + length > capacity){
+            capacity *= 2;
+        }
+        char *pool = realloc(ranking->pool, capacity);
+        if(!pool){
+            return -1;
+        }
+        ranking->pool = pool;
+        ranking->pool_capacity = capacity;
     }
-    return index;
+    memcpy(ranking->pool + ranking->pool_length, word, length);
+    /* Chiave complementata: l'ordine crescente delle chiavi è decrescente per occorrenze */
+    ranking->words[ranking->words_count].key = ~(uint32_t) occurrences;
+    ranking->words[ranking->words_count].offset = ranking->pool_length;
+    ranking->words_count++;
+    ranking->pool_length += length;
+    return 0;
 }
 
-static void _collect_words(const _TrieNode *node, List *wordlist, char *word){
-    assert(node);
-    assert(wordlist);
-    if(node->is_word){
-        int len = strlen(word) + 1  + sizeof(int) + 1;
-        char *word_info = malloc(len);
-        assert(word_info);
-        snprintf(word_info, len, "%s %d", word, node->occurrences);
-        list_append(word_info, wordlist);
+/* Radix sort LSD, stabile: a parità di occorrenze resta l'ordine alfabetico */
+static int _sort_by_occurrences(_Ranking *ranking){
+    size_t count = ranking->words_count;
+    if(count < 2){
+        return 0;
     }
-    if(!node->is_leaf){
-        for (int i = 0; i < ALPHABET; i++){
-            if (node->children[i] != NULL){
-                int next_word_len = (word != NULL) ? (strlen(word) + 2) : 2;
-                char *next_word = malloc(next_word_len);
-                assert(next_word);
-                if (word != NULL)
-                    strcpy(next_word, word);
-                next_word[next_word_len - 2] = node->children[i]->prefix;
-                next_word[next_word_len - 1] = '\0';
-                _collect_words(node->children[i], wordlist, next_word);
-            }
+    _RankedWord *buffer = malloc(count * sizeof(_RankedWord));
+    if(!buffer){
+        return -1;
+    }
+    _RankedWord *source = ranking->words, *destination = buffer;
+    for(int shift = 0; shift < 32; shift += 8){
+        size_t buckets[256] = {0};
+        for(size_t i = 0; i < count; i++){
+            buckets[(source[i].key >> shift) & 0xFF]++;
+        }
+        if(buckets[(source[0].key >> shift) & 0xFF] == count){
+            continue;
         }
+        size_t position = 0;
+        for(int b = 0; b < 256; b++){
+            size_t bucket = buckets[b];
+            buckets[b] = position;
+            position += bucket;
+        }
+        for(size_t i = 0; i < count; i++){
+            destination[buckets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+        _RankedWord *swap = source;
+        source = destination;
+        destination = swap;
+    }
+    if(source != ranking->words){
+        memcpy(ranking->words, source, count * sizeof(_RankedWord));
     }
-}
\ No newline at end of file
+    free(buffer);
+    return 0;
+}
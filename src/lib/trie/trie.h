@@ -3,9 +3,17 @@
 
 #include "../list/list.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef struct Trie Trie;
 
+/**
+ * @brief Funzione invocata da trie_visit() per ogni parola
+ * contenuta nel Trie.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*TrieVisitor)(const char *word, int occurrences, void *context);
+
 /**
  * @brief Alloca la memoria per un Trie
  * composto dal solo nodo radice.
@@ -15,6 +23,16 @@ typedef struct Trie Trie;
  */
 Trie *trie_new();
 
+/**
+ * @brief Come trie_new(), ma i nodi del Trie vengono allocati,
+ * quando il sistema lo consente, su huge pages.
+ * Conviene per Trie di grandi dimensioni.
+ * 
+ * @return Trie* Il puntatore al Trie creato
+ * @return NULL Failure
+ */
+Trie *trie_new_huge_pages();
+
 /**
  * @brief Libera la memoria riservata al Trie
  * 
@@ -34,6 +52,35 @@ int trie_insert(const char *word, Trie *trie);
 
 int trie_insert_with_occ(const char *word, int occurrences, Trie *trie);
 
+/**
+ * @brief Aggiunge le occorrenze specificate ai primi length
+ * caratteri di word, inserendo la parola se non è contenuta
+ * nel Trie. La parola non deve essere terminata da '\0'.
+ * 
+ * @param word La parola da inserire
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da aggiungere
+ * @param trie Il trie a cui aggiungere la parola
+ * @return int Il numero di occorrenze della parola dopo l'inserimento
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int trie_insert_n(const char *word, size_t length, int occurrences, Trie *trie);
+
+/**
+ * @brief Sottrae le occorrenze specificate ai primi length
+ * caratteri di word. La parola viene rimossa quando le sue
+ * occorrenze si azzerano; se non è contenuta nel Trie non
+ * viene eseguita nessuna azione.
+ * 
+ * @param word La parola da cui sottrarre le occorrenze
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da sottrarre
+ * @param trie Il trie da cui sottrarre le occorrenze
+ * @return int Il numero di occorrenze rimaste
+ * @return -1 Failure
+ */
+int trie_subtract_n(const char *word, size_t length, int occurrences, Trie *trie);
+
 /**
  * @brief Rimuove una parola e tutte le sue 
  * occorrenze dal Trie. Se la parola non è
@@ -55,6 +102,11 @@ void trie_remove(const char *word, Trie *trie);
  */
 bool trie_contains(const char *word, const Trie *trie);
 
+/**
+ * @brief Come trie_contains(), per i primi length caratteri di word
+ */
+bool trie_contains_n(const char *word, size_t length, const Trie *trie);
+
 /**
  * @brief Restituisce il numero di occorrenze di una parola
  * all'interno del Trie
@@ -65,6 +117,12 @@ bool trie_contains(const char *word, const Trie *trie);
  */
 int trie_get_word_occurrences(const char *word, const Trie *trie);
 
+/**
+ * @brief Come trie_get_word_occurrences(), per i primi length
+ * caratteri di word
+ */
+int trie_get_word_occurrences_n(const char *word, size_t length, const Trie *trie);
+
 /**
  * @brief Restituisce le parole presenti nel Trie sottoforma
  * di lista di stringhe.
@@ -76,6 +134,63 @@ int trie_get_word_occurrences(const char *word, const Trie *trie);
  */
 List *trie_get_wordlist(const Trie *trie);
 
+/**
+ * @brief Visita in ordine alfabetico tutte le parole del Trie,
+ * invocando il visitor su ciascuna di esse.
+ * 
+ * @param trie Il Trie da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int trie_visit(const Trie *trie, TrieVisitor visitor, void *context);
+
+/**
+ * @brief Visita tutte le parole del Trie in ordine decrescente
+ * di occorrenze; le parole con le stesse occorrenze vengono
+ * visitate in ordine alfabetico.
+ * L'ordinamento viene calcolato al momento della chiamata.
+ * 
+ * @param trie Il Trie da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int trie_visit_by_occurrences(const Trie *trie, TrieVisitor visitor, void *context);
+
+/**
+ * @brief Aggiunge al Trie destination tutte le parole del Trie
+ * source, sommandone le occorrenze. Il Trie source non viene
+ * modificato.
+ * 
+ * @param source Il Trie da cui leggere le parole
+ * @param destination Il Trie in cui aggiungere le parole
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int trie_merge(const Trie *source, Trie *destination);
+
+/**
+ * @brief Restituisce il numero di nodi allocati dal Trie
+ * 
+ * @param trie Il Trie
+ * @return size_t Il numero di nodi
+ */
+size_t trie_get_nodes_count(const Trie *trie);
+
+/**
+ * @brief Restituisce la memoria in byte riservata dal Trie,
+ * comprese le arene dei nodi
+ * 
+ * @param trie Il Trie
+ * @return size_t La memoria in byte
+ */
+size_t trie_get_memory_usage(const Trie *trie);
+
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,269 @@
+#define _GNU_SOURCE
+
+#include "uring.h"
+
+#include <stdlib.h>
+#include <errno.h>
+
+#ifdef HAVE_IO_URING
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define PROBE_OPS 256
+
+static struct io_uring_sqe *_next_sqe(Uring *ring);
+static void _push_sqe(Uring *ring);
+static bool _supports_file_ops(int fd);
+
+/*
+ * Gli anelli sono condivisi con il kernel: la coda di sottomissione
+ * viene scritta da questo processo e letta dal kernel, quella dei
+ * completamenti il contrario. head e tail vengono letti e scritti
+ * con semantica acquire/release, come fa liburing.
+ */
+typedef struct Uring {
+    int fd;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int sq_entries;
+    struct io_uring_sqe *sqes;
+    unsigned int to_submit;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+} Uring;
+
+Uring *uring_new(unsigned int entries){
+    assert(entries > 0);
+    Uring *ring = calloc(1, sizeof(Uring));
+    if(!ring){
+        return NULL;
+    }
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if(ring->fd < 0){
+        free(ring);
+        return NULL;
+    }
+    if(!_supports_file_ops(ring->fd)){
+        close(ring->fd);
+        free(ring);
+        errno = ENOSYS;
+        return NULL;
+    }
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(single_mmap && ring->cq_ring_size > ring->sq_ring_size){
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->cq_ring = (single_mmap) ? ring->sq_ring :
+        mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if(ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED){
+        uring_destroy(ring);
+        return NULL;
+    }
+    char *sq = ring->sq_ring, *cq = ring->cq_ring;
+    ring->sq_head = (unsigned int *) (sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int *) (sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *) (sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *) (sq + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (unsigned int *) (cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int *) (cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+    return ring;
+}
+
+void uring_destroy(Uring *ring){
+    if(ring){
+        if(ring->sqes && ring->sqes != MAP_FAILED){
+            munmap(ring->sqes, ring->sqes_size);
+        }
+        if(ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring){
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        if(ring->sq_ring && ring->sq_ring != MAP_FAILED){
+            munmap(ring->sq_ring, ring->sq_ring_size);
+        }
+        close(ring->fd);
+        free(ring);
+    }
+}
+
+int uring_openat(const char *path, int flags, uint64_t data, Uring *ring){
+    struct io_uring_sqe *sqe = _next_sqe(ring);
+    if(!sqe){
+        return -1;
+    }
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t) (uintptr_t) path;
+    sqe->open_flags = flags;
+    sqe->user_data = data;
+    _push_sqe(ring);
+    return 0;
+}
+
+int uring_statx(const char *path, unsigned int mask, struct statx *buffer, uint64_t data, Uring *ring){
+    struct io_uring_sqe *sqe = _next_sqe(ring);
+    if(!sqe){
+        return -1;
+    }
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t) (uintptr_t) path;
+    sqe->len = mask;
+    sqe->off = (uint64_t) (uintptr_t) buffer;
+    sqe->user_data = data;
+    _push_sqe(ring);
+    return 0;
+}
+
+int uring_read(int fd, void *buffer, unsigned int size, uint64_t offset, uint64_t data, Uring *ring){
+    struct io_uring_sqe *sqe = _next_sqe(ring);
+    if(!sqe){
+        return -1;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) buffer;
+    sqe->len = size;
+    sqe->off = offset;
+    sqe->user_data = data;
+    _push_sqe(ring);
+    return 0;
+}
+
+int uring_close(int fd, uint64_t data, Uring *ring){
+    struct io_uring_sqe *sqe = _next_sqe(ring);
+    if(!sqe){
+        return -1;
+    }
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = data;
+    _push_sqe(ring);
+    return 0;
+}
+
+int uring_submit(unsigned int wait, Uring *ring){
+    assert(ring);
+    unsigned int flags = (wait > 0) ? IORING_ENTER_GETEVENTS : 0;
+    long res;
+    do{
+        res = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait, flags, NULL, 0);
+    }while(res < 0 && errno == EINTR);
+    if(res < 0){
+        return -1;
+    }
+    ring->to_submit -= res;
+    return 0;
+}
+
+bool uring_next_completion(UringCompletion *completion, Uring *ring){
+    assert(completion);
+    assert(ring);
+    unsigned int head = *ring->cq_head;
+    if(head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)){
+        return false;
+    }
+    const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    completion->data = cqe->user_data;
+    completion->result = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Private Methods */
+
+static struct io_uring_sqe *_next_sqe(Uring *ring){
+    assert(ring);
+    unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    unsigned int tail = *ring->sq_tail;
+    if(tail - head >= ring->sq_entries){
+        return NULL;
+    }
+    unsigned int index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    return sqe;
+}
+
+/* Rende visibile al kernel l'ultima operazione preparata da _next_sqe() */
+static void _push_sqe(Uring *ring){
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+}
+
+static bool _supports_file_ops(int fd){
+    struct io_uring_probe *probe = calloc(1, sizeof(struct io_uring_probe) + PROBE_OPS * sizeof(struct io_uring_probe_op));
+    if(!probe){
+        return false;
+    }
+    bool supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) == 0;
+    const int ops[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE};
+    for(size_t i = 0; supported && i < sizeof(ops) / sizeof(ops[0]); i++){
+        supported = ops[i] <= probe->last_op && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+}
+
+#else
+
+Uring *uring_new(unsigned int entries){
+    errno = ENOSYS;
+    return NULL;
+}
+
+void uring_destroy(Uring *ring){
+}
+
+int uring_openat(const char *path, int flags, uint64_t data, Uring *ring){
+    return -1;
+}
+
+int uring_statx(const char *path, unsigned int mask, struct statx *buffer, uint64_t data, Uring *ring){
+    return -1;
+}
+
+int uring_read(int fd, void *buffer, unsigned int size, uint64_t offset, uint64_t data, Uring *ring){
+    return -1;
+}
+
+int uring_close(int fd, uint64_t data, Uring *ring){
+    return -1;
+}
+
+int uring_submit(unsigned int wait, Uring *ring){
+    errno = ENOSYS;
+    return -1;
+}
+
+bool uring_next_completion(UringCompletion *completion, Uring *ring){
+    return false;
+}
+
+#endif
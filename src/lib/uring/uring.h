@@ -0,0 +1,112 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Interfaccia minima di io_uring per leggere file: apertura, stat,
+ * lettura e chiusura. È disponibile solo se compilata con
+ * HAVE_IO_URING, altrimenti uring_new() fallisce con ENOSYS.
+ */
+typedef struct Uring Uring;
+
+struct statx;
+
+typedef struct UringCompletion {
+    /* Il valore passato con l'operazione */
+    uint64_t data;
+    /* Il risultato dell'operazione, -errno in caso di errore */
+    int32_t result;
+} UringCompletion;
+
+/**
+ * @brief Crea una coda io_uring, verificando che il kernel
+ * supporti tutte le operazioni sui file
+ *
+ * @param entries Il numero di operazioni che possono essere in coda
+ * @return Uring* Il puntatore alla coda creata
+ * @return NULL Failure, io_uring non è disponibile
+ */
+Uring *uring_new(unsigned int entries);
+
+/**
+ * @brief Libera la coda. Le operazioni in corso vengono abbandonate.
+ *
+ * @param ring La coda da distruggere
+ */
+void uring_destroy(Uring *ring);
+
+/**
+ * @brief Accoda l'apertura di un file. Il risultato è il file descriptor.
+ * Il percorso deve restare valido fino alla sottomissione.
+ *
+ * @param path Il percorso del file
+ * @param flags I flag di open()
+ * @param data Il valore restituito con il completamento
+ * @param ring La coda
+ * @return 0 Success
+ * @return -1 La coda è piena
+ */
+int uring_openat(const char *path, int flags, uint64_t data, Uring *ring);
+
+/**
+ * @brief Accoda la lettura degli attributi di un file
+ *
+ * @param path Il percorso del file
+ * @param mask Gli attributi richiesti, come per statx()
+ * @param buffer Dove salvare gli attributi, valido fino al completamento
+ * @param data Il valore restituito con il completamento
+ * @param ring La coda
+ * @return 0 Success
+ * @return -1 La coda è piena
+ */
+int uring_statx(const char *path, unsigned int mask, struct statx *buffer, uint64_t data, Uring *ring);
+
+/**
+ * @brief Accoda una lettura. Il risultato è il numero di byte letti.
+ *
+ * @param fd Il file descriptor da cui leggere
+ * @param buffer Il buffer, valido fino al completamento
+ * @param size Il numero di byte da leggere
+ * @param offset La posizione nel file
+ * @param data Il valore restituito con il completamento
+ * @param ring La coda
+ * @return 0 Success
+ * @return -1 La coda è piena
+ */
+int uring_read(int fd, void *buffer, unsigned int size, uint64_t offset, uint64_t data, Uring *ring);
+
+/**
+ * @brief Accoda la chiusura di un file descriptor
+ *
+ * @param fd Il file descriptor da chiudere
+ * @param data Il valore restituito con il completamento
+ * @param ring La coda
+ * @return 0 Success
+ * @return -1 La coda è piena
+ */
+int uring_close(int fd, uint64_t data, Uring *ring);
+
+/**
+ * @brief Sottomette al kernel le operazioni accodate e attende
+ * che ne siano completate almeno wait
+ *
+ * @param wait Il numero di completamenti da attendere
+ * @param ring La coda
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int uring_submit(unsigned int wait, Uring *ring);
+
+/**
+ * @brief Estrae un'operazione completata, senza attendere
+ *
+ * @param completion Dove salvare il completamento
+ * @param ring La coda
+ * @return true È stato estratto un completamento
+ * @return false Non ci sono operazioni completate
+ */
+bool uring_next_completion(UringCompletion *completion, Uring *ring);
+
+#endif
@@ -0,0 +1,721 @@
+#define _GNU_SOURCE
+
+#include "walker.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define DIRENT_BUFFER_SIZE (32 * 1024)
+
+typedef struct _Task _Task;
+typedef struct _Deque _Deque;
+typedef struct _FileId _FileId;
+typedef struct _Visited _Visited;
+typedef struct _WalkerThread _WalkerThread;
+typedef struct _DirReader _DirReader;
+typedef struct _DirHandle _DirHandle;
+
+static void *_walk(void *args);
+static int _scan(const _Task *task, unsigned int id, Walker *walker);
+static int _emit(const char *path, unsigned int root, Walker *walker);
+static int _push(const char *path, size_t name_offset, _DirHandle *parent, unsigned int root, unsigned int id, Walker *walker);
+static bool _pop(_Deque *deque, _Task *task);
+static bool _steal(unsigned int id, _Task *task, Walker *walker);
+static void _wait_for_tasks(Walker *walker);
+static void _wake_idle(bool all, Walker *walker);
+static int _visited_add(dev_t device, ino_t inode, unsigned int root, Walker *walker);
+static unsigned char _get_type(mode_t mode);
+static int _reader_open(int fd, _DirReader *reader);
+static int _reader_next(_DirReader *reader, const char **name, unsigned char *type, uint64_t *inode);
+static void _reader_close(_DirReader *reader);
+static void _handle_release(_DirHandle *handle);
+
+/*
+ * Cartella aperta, condivisa con le sottocartelle in attesa che la
+ * usano per openat(); il descrittore si chiude con l'ultimo riferimento
+ */
+typedef struct _DirHandle {
+    int fd;
+    atomic_uint references;
+} _DirHandle;
+
+/*
+ * Cartella da visitare; root identifica il percorso di partenza.
+ * Le sottocartelle si aprono con il nome relativo alla cartella
+ * padre, che è NULL per i percorsi di partenza.
+ */
+typedef struct _Task {
+    char *path;
+    size_t name_offset;
+    _DirHandle *parent;
+    unsigned int root;
+} _Task;
+
+/*
+ * Il thread proprietario inserisce ed estrae in coda, gli altri
+ * sottraggono dalla testa le cartelle in attesa da più tempo,
+ * che di solito hanno i sottoalberi più grandi.
+ */
+typedef struct _Deque {
+    pthread_mutex_t mutex;
+    _Task *tasks;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+} _Deque;
+
+typedef struct _FileId {
+    uint64_t device;
+    uint64_t inode;
+    unsigned int root;
+    bool used;
+} _FileId;
+
+/* Cartelle già visitate per ogni percorso di partenza, usate solo seguendo i link */
+typedef struct _Visited {
+    pthread_mutex_t mutex;
+    _FileId *ids;
+    size_t count;
+    size_t capacity;
+} _Visited;
+
+typedef struct _WalkerThread {
+    pthread_t thread;
+    unsigned int id;
+    Walker *walker;
+} _WalkerThread;
+
+typedef struct _DirReader {
+#ifdef SYS_getdents64
+    int fd;
+    long length;
+    long position;
+    _Alignas(8) char buffer[DIRENT_BUFFER_SIZE];
+#else
+    DIR *dir;
+#endif
+} _DirReader;
+
+#ifdef SYS_getdents64
+typedef struct _LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+} _LinuxDirent64;
+#endif
+
+typedef struct Walker {
+    WalkerOptions options;
+    char **roots;
+    unsigned int roots_count;
+    _Deque *deques;
+    _WalkerThread *threads;
+    unsigned int started;
+    bool joined;
+    atomic_size_t pending;
+    atomic_size_t queued;
+    atomic_bool failed;
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t idle_cond;
+    _Visited visited;
+    pthread_mutex_t output_mutex;
+    pthread_cond_t output_cond;
+    char **paths;
+    unsigned int *paths_roots;
+    size_t paths_count;
+    size_t paths_capacity;
+    size_t consumed;
+    unsigned int running;
+} Walker;
+
+Walker *walker_new(const WalkerOptions *options){
+    assert(options);
+    assert(options->threads > 0);
+    Walker *walker = calloc(1, sizeof(Walker));
+    if(!walker){
+        return NULL;
+    }
+    walker->options = *options;
+    walker->deques = calloc(options->threads, sizeof(_Deque));
+    walker->threads = calloc(options->threads, sizeof(_WalkerThread));
+    if(!walker->deques || !walker->threads){
+        free(walker->deques);
+        free(walker->threads);
+        free(walker);
+        return NULL;
+    }
+    for(unsigned int i = 0; i < options->threads; i++){
+        pthread_mutex_init(&walker->deques[i].mutex, NULL);
+    }
+    pthread_mutex_init(&walker->visited.mutex, NULL);
+    pthread_mutex_init(&walker->output_mutex, NULL);
+    pthread_cond_init(&walker->output_cond, NULL);
+    pthread_mutex_init(&walker->idle_mutex, NULL);
+    pthread_cond_init(&walker->idle_cond, NULL);
+    atomic_init(&walker->pending, 0);
+    atomic_init(&walker->queued, 0);
+    atomic_init(&walker->failed, false);
+    walker->joined = true;
+    return walker;
+}
+
+void walker_destroy(Walker *walker){
+    if(walker){
+        walker_wait(walker);
+        for(unsigned int i = 0; i < walker->options.threads; i++){
+            _Deque *deque = &walker->deques[i];
+            for(size_t j = deque->head; j < deque->tail; j++){
+                free(deque->tasks[j].path);
+                _handle_release(deque->tasks[j].parent);
+            }
+            free(deque->tasks);
+            pthread_mutex_destroy(&deque->mutex);
+        }
+        for(unsigned int i = 0; i < walker->roots_count; i++){
+            free(walker->roots[i]);
+        }
+        for(size_t i = 0; i < walker->paths_count; i++){
+            free(walker->paths[i]);
+        }
+        pthread_mutex_destroy(&walker->visited.mutex);
+        pthread_mutex_destroy(&walker->output_mutex);
+        pthread_cond_destroy(&walker->output_cond);
+        pthread_mutex_destroy(&walker->idle_mutex);
+        pthread_cond_destroy(&walker->idle_cond);
+        free(walker->visited.ids);
+        free(walker->roots);
+        free(walker->paths);
+        free(walker->paths_roots);
+        free(walker->deques);
+        free(walker->threads);
+        free(walker);
+    }
+}
+
+int walker_add_root(const char *path, Walker *walker){
+    assert(path);
+    assert(walker);
+    char **roots = realloc(walker->roots, (walker->roots_count + 1) * sizeof(char *));
+    if(!roots){
+        return -1;
+    }
+    walker->roots = roots;
+    walker->roots[walker->roots_count] = malloc(strlen(path) + 1);
+    if(!walker->roots[walker->roots_count]){
+        return -1;
+    }
+    strcpy(walker->roots[walker->roots_count], path);
+    walker->roots_count++;
+    return 0;
+}
+
+int walker_start(Walker *walker){
+    assert(walker);
+    for(unsigned int i = 0; i < walker->roots_count; i++){
+        const char *root = walker->roots[i];
+        struct stat info;
+        if(stat(root, &info) < 0){
+            return -1;
+        }
+        int res;
+        if(walker->options.exclude && walker->options.exclude(root, info.st_dev, info.st_ino, walker->options.context)){
+            res = 0;
+        } else if(S_ISDIR(info.st_mode)){
+            res = (walker->options.follow) ? _visited_add(info.st_dev, info.st_ino, i, walker) : 1;
+            if(res > 0){
+                res = _push(root, 0, NULL, i, i % walker->options.threads, walker);
+            }
+        } else {
+            res = _emit(root, i, walker);
+        }
+        if(res < 0){
+            return -1;
+        }
+    }
+    walker->joined = false;
+    walker->running = walker->options.threads;
+    for(; walker->started < walker->options.threads; walker->started++){
+        _WalkerThread *thread = &walker->threads[walker->started];
+        thread->id = walker->started;
+        thread->walker = walker;
+        if(pthread_create(&thread->thread, NULL, _walk, thread) != 0){
+            break;
+        }
+    }
+    /* Le cartelle dei thread non avviati vengono sottratte dagli altri */
+    pthread_mutex_lock(&walker->output_mutex);
+    walker->running -= walker->options.threads - walker->started;
+    if(walker->started == 0){
+        atomic_store(&walker->failed, true);
+    }
+    pthread_cond_broadcast(&walker->output_cond);
+    pthread_mutex_unlock(&walker->output_mutex);
+    return (walker->started > 0) ? 0 : -1;
+}
+
+const char *walker_next(Walker *walker){
+    const char *root;
+    return walker_next_with_root(&root, walker);
+}
+
+const char *walker_next_with_root(const char **root, Walker *walker){
+    assert(root);
+    assert(walker);
+    const char *path = NULL;
+    pthread_mutex_lock(&walker->output_mutex);
+    while(walker->consumed == walker->paths_count && walker->running > 0){
+        pthread_cond_wait(&walker->output_cond, &walker->output_mutex);
+    }
+    if(walker->consumed < walker->paths_count){
+        *root = walker->roots[walker->paths_roots[walker->consumed]];
+        path = walker->paths[walker->consumed++];
+    }
+    pthread_mutex_unlock(&walker->output_mutex);
+    return path;
+}
+
+int walker_wait(Walker *walker){
+    assert(walker);
+    if(!walker->joined){
+        for(unsigned int i = 0; i < walker->started; i++){
+            pthread_join(walker->threads[i].thread, NULL);
+        }
+        walker->joined = true;
+    }
+    return (atomic_load(&walker->failed)) ? -1 : 0;
+}
+
+/* Private Methods */
+
+static void *_walk(void *args){
+    _WalkerThread *thread = args;
+    Walker *walker = thread->walker;
+    _Task task;
+    while(!atomic_load(&walker->failed)){
+        if(_pop(&walker->deques[thread->id], &task) || _steal(thread->id, &task, walker)){
+            atomic_fetch_sub(&walker->queued, 1);
+            if(_scan(&task, thread->id, walker) < 0){
+                atomic_store(&walker->failed, true);
+                _wake_idle(true, walker);
+            }
+            free(task.path);
+            _handle_release(task.parent);
+            if(atomic_fetch_sub(&walker->pending, 1) == 1){
+                _wake_idle(true, walker);
+            }
+        } else if(atomic_load(&walker->pending) == 0){
+            /* Nessuna cartella in attesa né in visita: non ne possono arrivare altre */
+            break;
+        } else {
+            _wait_for_tasks(walker);
+        }
+    }
+    pthread_mutex_lock(&walker->output_mutex);
+    walker->running--;
+    if(walker->running == 0){
+        pthread_cond_broadcast(&walker->output_cond);
+    }
+    pthread_mutex_unlock(&walker->output_mutex);
+    return NULL;
+}
+
+/*
+ * Le voci vengono lette dal file descriptor della cartella: il tipo
+ * arriva da getdents64 e fstatat() serve solo quando il tipo non è
+ * noto o per risolvere i link simbolici. La cartella si apre dalla
+ * cartella padre, senza seguire un link che l'abbia sostituita dopo
+ * la lettura del tipo, a meno che i link non vadano seguiti.
+ */
+static int _scan(const _Task *task, unsigned int id, Walker *walker){
+    int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+    int fd;
+    if(task->parent){
+        fd = openat(task->parent->fd, task->path + task->name_offset, flags | ((walker->options.follow) ? 0 : O_NOFOLLOW));
+    } else {
+        fd = open(task->path, flags);
+    }
+    if(fd < 0){
+        /* Come nftw(), le cartelle non leggibili vengono saltate */
+        return 0;
+    }
+    _DirReader *reader = malloc(sizeof(_DirReader));
+    _DirHandle *handle = malloc(sizeof(_DirHandle));
+    if(!reader || !handle){
+        free(reader);
+        free(handle);
+        close(fd);
+        return -1;
+    }
+    handle->fd = fd;
+    atomic_init(&handle->references, 1);
+    struct stat directory;
+    /* Il lettore usa una copia del descrittore, che resta aperto per le sottocartelle */
+    int reader_fd = (fstat(fd, &directory) == 0) ? fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+    if(reader_fd < 0 || _reader_open(reader_fd, reader) < 0){
+        if(reader_fd >= 0){
+            close(reader_fd);
+        }
+        free(reader);
+        _handle_release(handle);
+        return 0;
+    }
+    size_t base_length = strlen(task->path);
+    bool add_separator = base_length == 0 || task->path[base_length - 1] != '/';
+    size_t capacity = base_length + 256;
+    char *path = malloc(capacity);
+    int res = (path) ? 0 : -1;
+    if(path){
+        memcpy(path, task->path, base_length);
+        if(add_separator){
+            path[base_length++] = '/';
+        }
+    }
+    const char *name = NULL;
+    unsigned char type = DT_UNKNOWN;
+    uint64_t inode = 0;
+    int next = 0;
+    while(res == 0 && (next = _reader_next(reader, &name, &type, &inode)) > 0){
+        if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))){
+            continue;
+        }
+        size_t name_length = strlen(name);
+        if(base_length + name_length + 1 > capacity){
+            capacity = base_length + name_length + 1;
+            char *grown = realloc(path, capacity);
+            if(!grown){
+                res = -1;
+                break;
+            }
+            path = grown;
+        }
+        memcpy(path + base_length, name, name_length + 1);
+
+        struct stat info;
+        bool have_info = false;
+        if(type == DT_UNKNOWN){
+            if(fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) < 0){
+                continue;
+            }
+            type = _get_type(info.st_mode);
+            have_info = true;
+        }
+        if(type == DT_LNK){
+            /* Senza -f i link vengono ignorati; i link interrotti sempre */
+            if(!walker->options.follow || fstatat(fd, name, &info, 0) < 0){
+                continue;
+            }
+            type = _get_type(info.st_mode);
+            have_info = true;
+        }
+        if(type == DT_DIR && !walker->options.recursive){
+            continue;
+        }
+        if(walker->options.exclude){
+            /* Una cartella esclusa non viene visitata, con tutto il suo sottoalbero */
+            uint64_t device = (have_info) ? info.st_dev : directory.st_dev;
+            if(have_info){
+                inode = info.st_ino;
+            }
+            if(walker->options.exclude(path, device, inode, walker->options.context)){
+                continue;
+            }
+        }
+        if(type == DT_DIR){
+            if(walker->options.follow){
+                if(!have_info && fstatat(fd, name, &info, 0) < 0){
+                    continue;
+                }
+                int added = _visited_add(info.st_dev, info.st_ino, task->root, walker);
+                if(added <= 0){
+                    res = added;
+                    continue;
+                }
+            }
+            res = _push(path, base_length, handle, task->root, id, walker);
+        } else {
+            res = _emit(path, task->root, walker);
+        }
+    }
+    /* Un errore di lettura della cartella interrompe la visita */
+    if(res == 0 && next < 0){
+        res = -1;
+    }
+    free(path);
+    _reader_close(reader);
+    free(reader);
+    _handle_release(handle);
+    return res;
+}
+
+static int _emit(const char *path, unsigned int root, Walker *walker){
+    char *copy = malloc(strlen(path) + 1);
+    if(!copy){
+        return -1;
+    }
+    strcpy(copy, path);
+    int res = 0;
+    pthread_mutex_lock(&walker->output_mutex);
+    if(walker->paths_count == walker->paths_capacity){
+        size_t capacity = (walker->paths_capacity == 0) ? 1024 : walker->paths_capacity * 2;
+        char **paths = realloc(walker->paths, capacity * sizeof(char *));
+        if(paths){
+            walker->paths = paths;
+        }
+        unsigned int *paths_roots = realloc(walker->paths_roots, capacity * sizeof(unsigned int));
+        if(paths_roots){
+            walker->paths_roots = paths_roots;
+        }
+        if(paths && paths_roots){
+            walker->paths_capacity = capacity;
+        } else {
+            res = -1;
+        }
+    }
+    if(res == 0){
+        walker->paths_roots[walker->paths_count] = root;
+        walker->paths[walker->paths_count++] = copy;
+        pthread_cond_signal(&walker->output_cond);
+    }
+    pthread_mutex_unlock(&walker->output_mutex);
+    if(res < 0){
+        free(copy);
+    }
+    return res;
+}
+
+static int _push(const char *path, size_t name_offset, _DirHandle *parent, unsigned int root, unsigned int id, Walker *walker){
+    _Task task = { malloc(strlen(path) + 1), name_offset, parent, root };
+    if(!task.path){
+        return -1;
+    }
+    strcpy(task.path, path);
+    /* Il riferimento alla cartella padre precede la visibilità della cartella agli altri thread */
+    if(parent){
+        atomic_fetch_add(&parent->references, 1);
+    }
+    _Deque *deque = &walker->deques[id];
+    int res = 0;
+    pthread_mutex_lock(&deque->mutex);
+    if(deque->tail == deque->capacity){
+        if(deque->head > 0){
+            memmove(deque->tasks, deque->tasks + deque->head, (deque->tail - deque->head) * sizeof(_Task));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        } else {
+            size_t capacity = (deque->capacity == 0) ? 64 : deque->capacity * 2;
+            _Task *tasks = realloc(deque->tasks, capacity * sizeof(_Task));
+            if(tasks){
+                deque->tasks = tasks;
+                deque->capacity = capacity;
+            } else {
+                res = -1;
+            }
+        }
+    }
+    if(res == 0){
+        /* Il contatore cresce prima che la cartella sia visibile agli altri thread */
+        atomic_fetch_add(&walker->pending, 1);
+        atomic_fetch_add(&walker->queued, 1);
+        deque->tasks[deque->tail++] = task;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    if(res < 0){
+        free(task.path);
+        _handle_release(parent);
+    } else {
+        _wake_idle(false, walker);
+    }
+    return res;
+}
+
+static bool _pop(_Deque *deque, _Task *task){
+    bool found = false;
+    pthread_mutex_lock(&deque->mutex);
+    if(deque->tail > deque->head){
+        *task = deque->tasks[--deque->tail];
+        found = true;
+        if(deque->tail == deque->head){
+            deque->head = deque->tail = 0;
+        }
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return found;
+}
+
+static bool _steal(unsigned int id, _Task *task, Walker *walker){
+    unsigned int threads = walker->options.threads;
+    for(unsigned int i = 1; i < threads; i++){
+        _Deque *deque = &walker->deques[(id + i) % threads];
+        bool found = false;
+        pthread_mutex_lock(&deque->mutex);
+        if(deque->tail > deque->head){
+            *task = deque->tasks[deque->head++];
+            found = true;
+            if(deque->tail == deque->head){
+                deque->head = deque->tail = 0;
+            }
+        }
+        pthread_mutex_unlock(&deque->mutex);
+        if(found){
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Un thread senza cartelle attende che ne venga accodata una o che
+ * la visita finisca. Il contatore delle cartelle accodate viene letto
+ * con idle_mutex, che _wake_idle() acquisisce prima di svegliare:
+ * un risveglio non può andare perso tra il controllo e l'attesa.
+ */
+static void _wait_for_tasks(Walker *walker){
+    pthread_mutex_lock(&walker->idle_mutex);
+    while(atomic_load(&walker->queued) == 0 && atomic_load(&walker->pending) > 0 && !atomic_load(&walker->failed)){
+        pthread_cond_wait(&walker->idle_cond, &walker->idle_mutex);
+    }
+    pthread_mutex_unlock(&walker->idle_mutex);
+}
+
+/* Sveglia un thread in attesa per una nuova cartella, tutti quando la visita finisce */
+static void _wake_idle(bool all, Walker *walker){
+    pthread_mutex_lock(&walker->idle_mutex);
+    if(all){
+        pthread_cond_broadcast(&walker->idle_cond);
+    } else {
+        pthread_cond_signal(&walker->idle_cond);
+    }
+    pthread_mutex_unlock(&walker->idle_mutex);
+}
+
+/* Restituisce 1 se la cartella non era ancora stata visitata, 0 altrimenti */
+static int _visited_add(dev_t device, ino_t inode, unsigned int root, Walker *walker){
+    _Visited *visited = &walker->visited;
+    int res = 1;
+    pthread_mutex_lock(&visited->mutex);
+    if(2 * (visited->count + 1) > visited->capacity){
+        size_t capacity = (visited->capacity == 0) ? 256 : visited->capacity * 2;
+        _FileId *ids = calloc(capacity, sizeof(_FileId));
+        if(!ids){
+            pthread_mutex_unlock(&visited->mutex);
+            return -1;
+        }
+        for(size_t i = 0; i < visited->capacity; i++){
+            if(visited->ids[i].used){
+                _FileId *id = &visited->ids[i];
+                size_t slot = (id->device * 31 + id->inode * 0x9e3779b97f4a7c15u + id->root) & (capacity - 1);
+                while(ids[slot].used){
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                ids[slot] = *id;
+            }
+        }
+        free(visited->ids);
+        visited->ids = ids;
+        visited->capacity = capacity;
+    }
+    size_t mask = visited->capacity - 1;
+    size_t slot = ((uint64_t) device * 31 + (uint64_t) inode * 0x9e3779b97f4a7c15u + root) & mask;
+    while(visited->ids[slot].used){
+        _FileId *id = &visited->ids[slot];
+        if(id->device == device && id->inode == inode && id->root == root){
+            res = 0;
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if(res == 1){
+        visited->ids[slot] = (_FileId) { device, inode, root, true };
+        visited->count++;
+    }
+    pthread_mutex_unlock(&visited->mutex);
+    return res;
+}
+
+static void _handle_release(_DirHandle *handle){
+    if(handle && atomic_fetch_sub(&handle->references, 1) == 1){
+        close(handle->fd);
+        free(handle);
+    }
+}
+
+static unsigned char _get_type(mode_t mode){
+    if(S_ISDIR(mode)){
+        return DT_DIR;
+    }
+    if(S_ISLNK(mode)){
+        return DT_LNK;
+    }
+    return DT_REG;
+}
+
+#ifdef SYS_getdents64
+
+static int _reader_open(int fd, _DirReader *reader){
+    reader->fd = fd;
+    reader->length = 0;
+    reader->position = 0;
+    return 0;
+}
+
+static int _reader_next(_DirReader *reader, const char **name, unsigned char *type, uint64_t *inode){
+    if(reader->position >= reader->length){
+        long length;
+        do {
+            length = syscall(SYS_getdents64, reader->fd, reader->buffer, DIRENT_BUFFER_SIZE);
+        } while(length < 0 && errno == EINTR);
+        if(length <= 0){
+            return (int) length;
+        }
+        reader->length = length;
+        reader->position = 0;
+    }
+    const _LinuxDirent64 *entry = (const _LinuxDirent64 *) (reader->buffer + reader->position);
+    reader->position += entry->d_reclen;
+    *name = entry->d_name;
+    *type = entry->d_type;
+    *inode = entry->d_ino;
+    return 1;
+}
+
+static void _reader_close(_DirReader *reader){
+    close(reader->fd);
+}
+
+#else
+
+static int _reader_open(int fd, _DirReader *reader){
+    reader->dir = fdopendir(fd);
+    return (reader->dir) ? 0 : -1;
+}
+
+static int _reader_next(_DirReader *reader, const char **name, unsigned char *type, uint64_t *inode){
+    errno = 0;
+    struct dirent *entry = readdir(reader->dir);
+    if(!entry){
+        return (errno == 0) ? 0 : -1;
+    }
+    *name = entry->d_name;
+    *type = entry->d_type;
+    *inode = entry->d_ino;
+    return 1;
+}
+
+static void _reader_close(_DirReader *reader){
+    closedir(reader->dir);
+}
+
+#endif
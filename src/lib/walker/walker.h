@@ -0,0 +1,106 @@
+#ifndef WALKER_H
+#define WALKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct Walker Walker;
+
+/**
+ * @brief Funzione invocata per ogni file e cartella trovati,
+ * con il dispositivo e l'inode a cui si riferiscono.
+ * Se restituisce true il file viene scartato; una cartella
+ * scartata non viene visitata, con tutto il suo sottoalbero.
+ * Può essere invocata in contemporanea da più thread.
+ */
+typedef bool (*WalkerFilter)(const char *path, uint64_t device, uint64_t inode, void *context);
+
+typedef struct WalkerOptions {
+    /* Visita anche le sottocartelle delle cartelle di partenza */
+    bool recursive;
+    /* Segue i link simbolici, visitando ogni cartella una sola volta */
+    bool follow;
+    /* Il numero di thread che visitano le cartelle */
+    unsigned int threads;
+    /* Il filtro dei file, NULL per non scartarne nessuno */
+    WalkerFilter exclude;
+    void *context;
+} WalkerOptions;
+
+/**
+ * @brief Crea un walker che visita in parallelo le cartelle
+ * e rende disponibili i file man mano che li trova.
+ * Ogni thread visita le proprie cartelle e, quando le ha
+ * esaurite, sottrae le cartelle in attesa agli altri thread.
+ * 
+ * @param options Le opzioni della visita
+ * @return Walker* Il puntatore al walker creato
+ * @return NULL Failure
+ */
+Walker *walker_new(const WalkerOptions *options);
+
+/**
+ * @brief Libera la memoria riservata al walker, attendendo
+ * la fine della visita. I percorsi restituiti da walker_next()
+ * non sono più validi.
+ * 
+ * @param walker Il walker da distruggere
+ */
+void walker_destroy(Walker *walker);
+
+/**
+ * @brief Aggiunge un percorso di partenza. Un file viene reso
+ * disponibile così com'è, una cartella viene visitata.
+ * Deve essere invocata prima di walker_start().
+ * 
+ * @param path Il percorso di partenza
+ * @param walker Il walker a cui aggiungere il percorso
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int walker_add_root(const char *path, Walker *walker);
+
+/**
+ * @brief Avvia i thread della visita
+ * 
+ * @param walker Il walker da avviare
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int walker_start(Walker *walker);
+
+/**
+ * @brief Restituisce il prossimo file trovato, attendendo
+ * se la visita non è terminata. Può essere invocata da più
+ * thread. Il percorso resta valido fino alla distruzione
+ * del walker.
+ * 
+ * @param walker Il walker da cui leggere
+ * @return const char* Il percorso del file
+ * @return NULL La visita è terminata
+ */
+const char *walker_next(Walker *walker);
+
+/**
+ * @brief Come walker_next(), ma indica anche il percorso di
+ * partenza da cui il file è stato raggiunto, di cui il percorso
+ * del file è un prolungamento
+ * 
+ * @param root Riceve il percorso di partenza, valido fino alla
+ * distruzione del walker
+ * @param walker Il walker da cui leggere
+ * @return const char* Il percorso del file
+ * @return NULL La visita è terminata
+ */
+const char *walker_next_with_root(const char **root, Walker *walker);
+
+/**
+ * @brief Attende la fine della visita
+ * 
+ * @param walker Il walker da attendere
+ * @return 0 Success
+ * @return -1 La visita è stata interrotta da un errore
+ */
+int walker_wait(Walker *walker);
+
+#endif
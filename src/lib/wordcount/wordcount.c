@@ -0,0 +1,127 @@
+#include "wordcount.h"
+#include "../trie/trie.h"
+#include "../hashtable/hashtable.h"
+
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+
+/* Solo la struttura del motore scelto è allocata */
+typedef struct WordCount {
+    WordCountEngine engine;
+    Trie *trie;
+    HashTable *table;
+} WordCount;
+
+WordCount *wordcount_new(WordCountEngine engine, bool huge_pages){
+    WordCount *words = calloc(1, sizeof(WordCount));
+    if(!words){
+        return NULL;
+    }
+    words->engine = engine;
+    switch(engine){
+        case WORDCOUNT_TRIE:
+            words->trie = (huge_pages) ? trie_new_huge_pages() : trie_new();
+            break;
+        case WORDCOUNT_HASH:
+            words->table = hashtable_new();
+            break;
+    }
+    if(!words->trie && !words->table){
+        free(words);
+        return NULL;
+    }
+    return words;
+}
+
+void wordcount_destroy(WordCount *words){
+    if(!words){
+        return;
+    }
+    trie_destroy(words->trie);
+    hashtable_destroy(words->table);
+    free(words);
+}
+
+WordCountEngine wordcount_get_engine(const WordCount *words){
+    assert(words);
+    return words->engine;
+}
+
+int wordcount_insert_n(const char *word, size_t length, int occurrences, WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_insert_n(word, length, occurrences, words->table);
+    }
+    return trie_insert_n(word, length, occurrences, words->trie);
+}
+
+int wordcount_subtract_n(const char *word, size_t length, int occurrences, WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_subtract_n(word, length, occurrences, words->table);
+    }
+    return trie_subtract_n(word, length, occurrences, words->trie);
+}
+
+int wordcount_get_occurrences_n(const char *word, size_t length, const WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_get_occurrences_n(word, length, words->table);
+    }
+    return trie_get_word_occurrences_n(word, length, words->trie);
+}
+
+int wordcount_merge(const WordCount *source, WordCount *destination){
+    assert(source);
+    assert(destination);
+    if(source->engine != destination->engine){
+        errno = EINVAL;
+        return -1;
+    }
+    if(source->engine == WORDCOUNT_HASH){
+        return hashtable_merge(source->table, destination->table);
+    }
+    return trie_merge(source->trie, destination->trie);
+}
+
+int wordcount_visit(const WordCount *words, WordCountVisitor visitor, void *context){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_visit(words->table, visitor, context);
+    }
+    return trie_visit(words->trie, visitor, context);
+}
+
+int wordcount_visit_by_occurrences(const WordCount *words, WordCountVisitor visitor, void *context){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_visit_by_occurrences(words->table, visitor, context);
+    }
+    return trie_visit_by_occurrences(words->trie, visitor, context);
+}
+
+bool wordcount_is_empty(const WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_get_words_count(words->table) == 0;
+    }
+    /* Il Trie vuoto ha solo la radice */
+    return trie_get_nodes_count(words->trie) <= 1;
+}
+
+size_t wordcount_get_nodes_count(const WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_get_slots_count(words->table);
+    }
+    return trie_get_nodes_count(words->trie);
+}
+
+size_t wordcount_get_memory_usage(const WordCount *words){
+    assert(words);
+    if(words->engine == WORDCOUNT_HASH){
+        return hashtable_get_memory_usage(words->table);
+    }
+    return trie_get_memory_usage(words->trie);
+}
@@ -0,0 +1,153 @@
+#ifndef WORDCOUNT_H
+#define WORDCOUNT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Le occorrenze delle parole, contate da uno dei motori disponibili.
+ * Tutti i motori visitano le parole nello stesso ordine, quindi
+ * producono lo stesso output.
+ */
+typedef struct WordCount WordCount;
+
+/**
+ * Motori di conteggio disponibili.
+ */
+typedef enum WordCountEngine {
+    /* Trie adattivo: le parole sono sempre in ordine alfabetico */
+    WORDCOUNT_TRIE,
+    /* Tabella hash: le parole vengono ordinate solo quando sono visitate */
+    WORDCOUNT_HASH
+} WordCountEngine;
+
+/**
+ * @brief Funzione invocata dalle visite per ogni parola.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*WordCountVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Crea un conteggio vuoto
+ *
+ * @param engine Il motore di conteggio
+ * @param huge_pages Il Trie viene allocato su huge pages, se disponibili;
+ * ignorato dagli altri motori
+ * @return WordCount* Il puntatore al conteggio creato
+ * @return NULL Failure
+ */
+WordCount *wordcount_new(WordCountEngine engine, bool huge_pages);
+
+/**
+ * @brief Libera la memoria riservata al conteggio
+ *
+ * @param words Il conteggio da distruggere
+ */
+void wordcount_destroy(WordCount *words);
+
+/**
+ * @brief Restituisce il motore del conteggio
+ *
+ * @param words Il conteggio
+ * @return WordCountEngine Il motore
+ */
+WordCountEngine wordcount_get_engine(const WordCount *words);
+
+/**
+ * @brief Aggiunge le occorrenze specificate ai primi length
+ * caratteri di word, inserendo la parola se non è contata
+ *
+ * @param word La parola da inserire, non necessariamente terminata da '\0'
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da aggiungere
+ * @param words Il conteggio
+ * @return int Il numero di occorrenze della parola dopo l'inserimento
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int wordcount_insert_n(const char *word, size_t length, int occurrences, WordCount *words);
+
+/**
+ * @brief Sottrae le occorrenze specificate ai primi length
+ * caratteri di word; una parola senza occorrenze non viene più visitata
+ *
+ * @param word La parola da cui sottrarre le occorrenze
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da sottrarre
+ * @param words Il conteggio
+ * @return int Il numero di occorrenze rimaste
+ * @return -1 Failure
+ */
+int wordcount_subtract_n(const char *word, size_t length, int occurrences, WordCount *words);
+
+/**
+ * @brief Restituisce le occorrenze dei primi length caratteri di word
+ *
+ * @param word La parola da cercare
+ * @param length La lunghezza della parola
+ * @param words Il conteggio
+ * @return int Le occorrenze, 0 se la parola non è contata
+ */
+int wordcount_get_occurrences_n(const char *word, size_t length, const WordCount *words);
+
+/**
+ * @brief Aggiunge a destination le parole e le occorrenze di source,
+ * che deve usare lo stesso motore. source non viene modificato.
+ *
+ * @param source Il conteggio da cui leggere le parole
+ * @param destination Il conteggio in cui inserire le parole
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int wordcount_merge(const WordCount *source, WordCount *destination);
+
+/**
+ * @brief Visita le parole in ordine alfabetico
+ *
+ * @param words Il conteggio da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int wordcount_visit(const WordCount *words, WordCountVisitor visitor, void *context);
+
+/**
+ * @brief Visita le parole in ordine decrescente di occorrenze
+ * e, a parità di occorrenze, in ordine alfabetico
+ *
+ * @param words Il conteggio da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int wordcount_visit_by_occurrences(const WordCount *words, WordCountVisitor visitor, void *context);
+
+/**
+ * @brief Indica se nel conteggio non è mai stata inserita una parola
+ *
+ * @param words Il conteggio
+ * @return true Il conteggio è vuoto
+ * @return false Il conteggio contiene almeno una parola
+ */
+bool wordcount_is_empty(const WordCount *words);
+
+/**
+ * @brief Restituisce il numero dei nodi del Trie oppure dei posti della tabella
+ *
+ * @param words Il conteggio
+ * @return size_t Il numero dei nodi o dei posti
+ */
+size_t wordcount_get_nodes_count(const WordCount *words);
+
+/**
+ * @brief Restituisce i byte occupati dal conteggio
+ *
+ * @param words Il conteggio
+ * @return size_t I byte occupati
+ */
+size_t wordcount_get_memory_usage(const WordCount *words);
+
+#endif
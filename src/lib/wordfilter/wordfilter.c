@@ -0,0 +1,124 @@
+#include "wordfilter.h"
+#include "../trie/trie.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+#define FNV_OFFSET 0xcbf29ce484222325u
+#define FNV_PRIME 0x100000001b3u
+
+static bool _accepts(const Token *token, const WordFilter *filter);
+static int _hash_ignored_word(const char *word, int occurrences, void *fingerprint);
+
+typedef struct WordFilter {
+    unsigned int minimum_length;
+    bool alpha;
+    Trie *ignored;
+} WordFilter;
+
+WordFilter *wordfilter_new(){
+    WordFilter *filter = calloc(1, sizeof(WordFilter));
+    if(!filter){
+        return NULL;
+    }
+    filter->ignored = trie_new();
+    if(!filter->ignored){
+        free(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+void wordfilter_destroy(WordFilter *filter){
+    if(filter){
+        trie_destroy(filter->ignored);
+        free(filter);
+    }
+}
+
+void wordfilter_set_minimum_length(unsigned int length, WordFilter *filter){
+    assert(filter);
+    filter->minimum_length = length;
+}
+
+void wordfilter_set_alpha(bool alpha, WordFilter *filter){
+    assert(filter);
+    filter->alpha = alpha;
+}
+
+int wordfilter_ignore_tokens(Tokenizer *tokenizer, WordFilter *filter){
+    assert(tokenizer);
+    assert(filter);
+    Token token;
+    int res;
+    while( (res = tokenizer_next(tokenizer, &token)) > 0){
+        if(token.is_alnum && trie_insert_n(token.word, token.length, 1, filter->ignored) < 0){
+            return -1;
+        }
+    }
+    return (res < 0) ? -1 : 0;
+}
+
+bool wordfilter_accepts(const Token *token, const WordFilter *filter){
+    assert(token);
+    assert(filter);
+    return _accepts(token, filter);
+}
+
+int wordfilter_count_tokens(Tokenizer *tokenizer, const WordFilter *filter, WordSink sink, void *context, WordFilterCounts *counts){
+    assert(tokenizer);
+    assert(filter);
+    assert(sink);
+    assert(counts);
+    counts->tokens = 0;
+    counts->counted_tokens = 0;
+    Token token;
+    int res;
+    while( (res = tokenizer_next(tokenizer, &token)) > 0){
+        counts->tokens++;
+        if(_accepts(&token, filter)){
+            int counted = sink(&token, context);
+            if(counted < 0){
+                return -1;
+            }
+            if(counted == 0){
+                counts->counted_tokens++;
+            }
+        }
+    }
+    return (res < 0) ? -1 : 0;
+}
+
+uint64_t wordfilter_get_fingerprint(const WordFilter *filter){
+    assert(filter);
+    uint64_t fingerprint = FNV_OFFSET;
+    fingerprint = (fingerprint ^ filter->alpha) * FNV_PRIME;
+    fingerprint = (fingerprint ^ filter->minimum_length) * FNV_PRIME;
+    trie_visit(filter->ignored, _hash_ignored_word, &fingerprint);
+    return fingerprint;
+}
+
+/* Private Methods */
+
+static bool _accepts(const Token *token, const WordFilter *filter){
+    if(!token->word || !token->is_alnum){
+        return false;
+    }
+    if(token->length < filter->minimum_length){
+        return false;
+    }
+    if(filter->alpha && token->has_digits){
+        return false;
+    }
+    return !trie_contains_n(token->word, token->length, filter->ignored);
+}
+
+static int _hash_ignored_word(const char *word, int occurrences, void *fingerprint){
+    (void) occurrences;
+    uint64_t *hash = fingerprint;
+    for(; *word; word++){
+        *hash = (*hash ^ (unsigned char) *word) * FNV_PRIME;
+    }
+    *hash = (*hash ^ ' ') * FNV_PRIME;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef WORDFILTER_H
+#define WORDFILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../tokenizer/tokenizer.h"
+
+/*
+ * Le regole con cui una parola letta viene conteggiata o scartata:
+ * la lunghezza minima, le cifre e le parole da ignorare. Sono le
+ * stesse per swordx e per libswordx, che contano le parole con
+ * wordfilter_count_tokens().
+ */
+typedef struct WordFilter WordFilter;
+
+/**
+ * @brief Funzione invocata da wordfilter_count_tokens() per ogni
+ * parola accettata dal filtro
+ *
+ * @return 0 La parola è stata conteggiata
+ * @return 1 La parola è stata scartata
+ * @return -1 Failure, il conteggio si interrompe
+ */
+typedef int (*WordSink)(const Token *token, void *context);
+
+typedef struct WordFilterCounts {
+    /* Le parole lette */
+    size_t tokens;
+    /* Le parole conteggiate dal WordSink */
+    size_t counted_tokens;
+} WordFilterCounts;
+
+/**
+ * @brief Crea un filtro che accetta tutte le parole alfanumeriche
+ *
+ * @return WordFilter* Il puntatore al filtro creato
+ * @return NULL Failure
+ */
+WordFilter *wordfilter_new();
+
+/**
+ * @brief Libera la memoria riservata al filtro
+ *
+ * @param filter Il filtro da distruggere
+ */
+void wordfilter_destroy(WordFilter *filter);
+
+/**
+ * @brief Imposta la lunghezza minima delle parole accettate
+ *
+ * @param length La lunghezza minima
+ * @param filter Il filtro
+ */
+void wordfilter_set_minimum_length(unsigned int length, WordFilter *filter);
+
+/**
+ * @brief Scarta, oppure no, le parole che contengono cifre
+ *
+ * @param alpha true per scartare le parole con cifre
+ * @param filter Il filtro
+ */
+void wordfilter_set_alpha(bool alpha, WordFilter *filter);
+
+/**
+ * @brief Aggiunge le parole alfanumeriche lette dal tokenizer a
+ * quelle da ignorare, indipendentemente dalle altre regole
+ *
+ * @param tokenizer Il tokenizer da cui leggere
+ * @param filter Il filtro
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int wordfilter_ignore_tokens(Tokenizer *tokenizer, WordFilter *filter);
+
+/**
+ * @brief Indica se la parola rispetta tutte le regole del filtro
+ *
+ * @param token La parola letta
+ * @param filter Il filtro
+ * @return true La parola va conteggiata
+ * @return false La parola va scartata
+ */
+bool wordfilter_accepts(const Token *token, const WordFilter *filter);
+
+/**
+ * @brief Legge tutte le parole del tokenizer e passa a sink quelle
+ * accettate dal filtro. counts viene riempito anche in caso di
+ * errore, con le parole lette fino a quel momento.
+ *
+ * @param tokenizer Il tokenizer da cui leggere
+ * @param filter Il filtro
+ * @param sink La funzione che conteggia le parole accettate
+ * @param context Puntatore passato invariato a sink
+ * @param counts I conteggi delle parole lette e conteggiate
+ * @return 0 Success
+ * @return -1 Failure, della lettura o di sink
+ */
+int wordfilter_count_tokens(Tokenizer *tokenizer, const WordFilter *filter, WordSink sink, void *context, WordFilterCounts *counts);
+
+/**
+ * @brief Restituisce un'impronta delle regole: filtri con regole
+ * diverse hanno, salvo collisioni, impronte diverse
+ *
+ * @param filter Il filtro
+ * @return uint64_t L'impronta
+ */
+uint64_t wordfilter_get_fingerprint(const WordFilter *filter);
+
+#endif
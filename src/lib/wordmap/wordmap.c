@@ -0,0 +1,339 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "wordmap.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define SHARDS_BITS 8
+#define SHARDS (1 << SHARDS_BITS)
+#define INITIAL_CAPACITY 256
+/* Una tabella viene raddoppiata quando è piena per tre quarti */
+#define MAX_LOAD_NUMERATOR 3
+#define MAX_LOAD_DENOMINATOR 4
+#define CACHE_LINE 64
+
+typedef struct _Entry _Entry;
+typedef struct _Shard _Shard;
+
+static uint64_t _hash(const char *word, size_t length);
+static _Entry *_entry_new(const char *word, size_t length, uint64_t hash, int occurrences);
+static bool _entry_matches(const _Entry *entry, const char *word, size_t length, uint64_t hash);
+static size_t _get_limit(size_t capacity);
+static int _grow(size_t capacity, _Shard *shard);
+static _Entry **_get_entries(const WordMap *map, size_t *count);
+static int _visit_entries(_Entry **entries, size_t count, WordMapVisitor visitor, void *context);
+static int _compare_words(const void *a, const void *b);
+static int _compare_occurrences(const void *a, const void *b);
+
+/* La parola, terminata da '\0', segue le occorrenze */
+typedef struct _Entry {
+    uint64_t hash;
+    atomic_int occurrences;
+    size_t length;
+    char word[];
+} _Entry;
+
+/*
+ * Gli inserimenti tengono il lock in lettura, quindi procedono
+ * insieme: solo il raddoppio della tabella lo prende in scrittura.
+ * count comprende i posti prenotati da chi sta aggiungendo una parola,
+ * così la tabella non supera mai il carico massimo.
+ */
+typedef struct _Shard {
+    _Alignas(CACHE_LINE) pthread_rwlock_t lock;
+    _Atomic(_Entry *) *slots;
+    size_t capacity;
+    atomic_size_t count;
+    atomic_size_t bytes;
+} _Shard;
+
+typedef struct WordMap {
+    _Shard shards[SHARDS];
+} WordMap;
+
+WordMap *wordmap_new(){
+    WordMap *map = aligned_alloc(CACHE_LINE, sizeof(WordMap));
+    if(!map){
+        return NULL;
+    }
+    for(int i = 0; i < SHARDS; i++){
+        _Shard *shard = &map->shards[i];
+        shard->capacity = INITIAL_CAPACITY;
+        shard->slots = calloc(INITIAL_CAPACITY, sizeof(_Atomic(_Entry *)));
+        atomic_init(&shard->count, 0);
+        atomic_init(&shard->bytes, 0);
+        if(!shard->slots || pthread_rwlock_init(&shard->lock, NULL) != 0){
+            free(shard->slots);
+            for(int j = 0; j < i; j++){
+                free(map->shards[j].slots);
+                pthread_rwlock_destroy(&map->shards[j].lock);
+            }
+            free(map);
+            return NULL;
+        }
+    }
+    return map;
+}
+
+void wordmap_destroy(WordMap *map){
+    if(!map){
+        return;
+    }
+    for(int i = 0; i < SHARDS; i++){
+        _Shard *shard = &map->shards[i];
+        for(size_t j = 0; j < shard->capacity; j++){
+            free(atomic_load_explicit(&shard->slots[j], memory_order_relaxed));
+        }
+        free(shard->slots);
+        pthread_rwlock_destroy(&shard->lock);
+    }
+    free(map);
+}
+
+int wordmap_insert_n(const char *word, size_t length, int occurrences, WordMap *map){
+    assert(word);
+    assert(map);
+    uint64_t hash = _hash(word, length);
+    _Shard *shard = &map->shards[hash >> (64 - SHARDS_BITS)];
+    _Entry *entry = NULL;
+    for(;;){
+        pthread_rwlock_rdlock(&shard->lock);
+        size_t capacity = shard->capacity, mask = capacity - 1;
+        bool full = false, inserted = false, overflow = false;
+        for(size_t index = hash & mask;; index = (index + 1) & mask){
+            _Entry *current = atomic_load_explicit(&shard->slots[index], memory_order_acquire);
+            if(!current){
+                if(!entry){
+                    entry = _entry_new(word, length, hash, occurrences);
+                    if(!entry){
+                        pthread_rwlock_unlock(&shard->lock);
+                        return -1;
+                    }
+                }
+                if(atomic_fetch_add(&shard->count, 1) >= _get_limit(capacity)){
+                    atomic_fetch_sub(&shard->count, 1);
+                    full = true;
+                    break;
+                }
+                if(atomic_compare_exchange_strong_explicit(&shard->slots[index], &current, entry,
+                    memory_order_release, memory_order_acquire)){
+                    atomic_fetch_add_explicit(&shard->bytes, sizeof(_Entry) + length + 1, memory_order_relaxed);
+                    inserted = true;
+                    break;
+                }
+                /* Un altro thread ha occupato il posto: current è la sua parola */
+                atomic_fetch_sub(&shard->count, 1);
+            }
+            if(_entry_matches(current, word, length, hash)){
+                /* Il conteggio trabocca solo se lo faceva già la somma: il conteggio fallisce */
+                overflow = atomic_fetch_add_explicit(&current->occurrences, occurrences, memory_order_relaxed) > INT_MAX - occurrences;
+                break;
+            }
+        }
+        pthread_rwlock_unlock(&shard->lock);
+        if(!full){
+            if(!inserted){
+                free(entry);
+            }
+            if(overflow){
+                errno = EOVERFLOW;
+                return -1;
+            }
+            return 0;
+        }
+        if(_grow(capacity, shard) < 0){
+            free(entry);
+            return -1;
+        }
+    }
+}
+
+int wordmap_get_occurrences_n(const char *word, size_t length, WordMap *map){
+    assert(word);
+    assert(map);
+    uint64_t hash = _hash(word, length);
+    _Shard *shard = &map->shards[hash >> (64 - SHARDS_BITS)];
+    int occurrences = 0;
+    pthread_rwlock_rdlock(&shard->lock);
+    size_t mask = shard->capacity - 1;
+    for(size_t index = hash & mask;; index = (index + 1) & mask){
+        _Entry *current = atomic_load_explicit(&shard->slots[index], memory_order_acquire);
+        if(!current){
+            break;
+        }
+        if(_entry_matches(current, word, length, hash)){
+            occurrences = atomic_load_explicit(&current->occurrences, memory_order_relaxed);
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return occurrences;
+}
+
+size_t wordmap_get_words_count(const WordMap *map){
+    assert(map);
+    size_t count = 0;
+    for(int i = 0; i < SHARDS; i++){
+        count += atomic_load((atomic_size_t *) &map->shards[i].count);
+    }
+    return count;
+}
+
+size_t wordmap_get_memory_usage(const WordMap *map){
+    assert(map);
+    size_t bytes = sizeof(WordMap);
+    for(int i = 0; i < SHARDS; i++){
+        const _Shard *shard = &map->shards[i];
+        bytes += shard->capacity * sizeof(_Atomic(_Entry *)) + atomic_load((atomic_size_t *) &shard->bytes);
+    }
+    return bytes;
+}
+
+int wordmap_visit(const WordMap *map, WordMapVisitor visitor, void *context){
+    assert(map);
+    assert(visitor);
+    size_t count;
+    _Entry **entries = _get_entries(map, &count);
+    if(!entries){
+        return -1;
+    }
+    qsort(entries, count, sizeof(_Entry *), _compare_words);
+    int res = _visit_entries(entries, count, visitor, context);
+    free(entries);
+    return res;
+}
+
+int wordmap_visit_by_occurrences(const WordMap *map, WordMapVisitor visitor, void *context){
+    assert(map);
+    assert(visitor);
+    size_t count;
+    _Entry **entries = _get_entries(map, &count);
+    if(!entries){
+        return -1;
+    }
+    qsort(entries, count, sizeof(_Entry *), _compare_occurrences);
+    int res = _visit_entries(entries, count, visitor, context);
+    free(entries);
+    return res;
+}
+
+/* Private Methods */
+
+/* FNV-1a seguito dal finalizzatore di MurmurHash3: i bit alti scelgono lo shard, i bassi il posto */
+static uint64_t _hash(const char *word, size_t length){
+    uint64_t hash = 0xcbf29ce484222325u;
+    for(size_t i = 0; i < length; i++){
+        hash = (hash ^ (unsigned char) word[i]) * 0x100000001b3u;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53u;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static _Entry *_entry_new(const char *word, size_t length, uint64_t hash, int occurrences){
+    _Entry *entry = malloc(sizeof(_Entry) + length + 1);
+    if(!entry){
+        return NULL;
+    }
+    entry->hash = hash;
+    atomic_init(&entry->occurrences, occurrences);
+    entry->length = length;
+    memcpy(entry->word, word, length);
+    entry->word[length] = '\0';
+    return entry;
+}
+
+static bool _entry_matches(const _Entry *entry, const char *word, size_t length, uint64_t hash){
+    return entry->hash == hash && entry->length == length && memcmp(entry->word, word, length) == 0;
+}
+
+static size_t _get_limit(size_t capacity){
+    return capacity / MAX_LOAD_DENOMINATOR * MAX_LOAD_NUMERATOR;
+}
+
+/* Raddoppia la tabella, se nessun altro thread l'ha già fatto dopo che era di capacity posti */
+static int _grow(size_t capacity, _Shard *shard){
+    pthread_rwlock_wrlock(&shard->lock);
+    if(shard->capacity != capacity){
+        pthread_rwlock_unlock(&shard->lock);
+        return 0;
+    }
+    size_t grown = capacity * 2, mask = grown - 1;
+    _Atomic(_Entry *) *slots = calloc(grown, sizeof(_Atomic(_Entry *)));
+    if(!slots){
+        pthread_rwlock_unlock(&shard->lock);
+        return -1;
+    }
+    for(size_t i = 0; i < capacity; i++){
+        _Entry *entry = atomic_load_explicit(&shard->slots[i], memory_order_relaxed);
+        if(!entry){
+            continue;
+        }
+        size_t index = entry->hash & mask;
+        while(atomic_load_explicit(&slots[index], memory_order_relaxed)){
+            index = (index + 1) & mask;
+        }
+        atomic_store_explicit(&slots[index], entry, memory_order_relaxed);
+    }
+    free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = grown;
+    pthread_rwlock_unlock(&shard->lock);
+    return 0;
+}
+
+/* Le parole di tutti gli shard, nell'ordine delle tabelle */
+static _Entry **_get_entries(const WordMap *map, size_t *count){
+    size_t words = wordmap_get_words_count(map);
+    _Entry **entries = malloc((words + 1) * sizeof(_Entry *));
+    if(!entries){
+        return NULL;
+    }
+    size_t position = 0;
+    for(int i = 0; i < SHARDS; i++){
+        const _Shard *shard = &map->shards[i];
+        for(size_t j = 0; j < shard->capacity && position < words; j++){
+            _Entry *entry = atomic_load_explicit((_Atomic(_Entry *) *) &shard->slots[j], memory_order_acquire);
+            if(entry){
+                entries[position++] = entry;
+            }
+        }
+    }
+    *count = position;
+    return entries;
+}
+
+static int _visit_entries(_Entry **entries, size_t count, WordMapVisitor visitor, void *context){
+    for(size_t i = 0; i < count; i++){
+        int res = visitor(entries[i]->word, atomic_load_explicit(&entries[i]->occurrences, memory_order_relaxed), context);
+        if(res != 0){
+            return res;
+        }
+    }
+    return 0;
+}
+
+static int _compare_words(const void *a, const void *b){
+    return strcmp((*(_Entry * const *) a)->word, (*(_Entry * const *) b)->word);
+}
+
+static int _compare_occurrences(const void *a, const void *b){
+    _Entry *x = *(_Entry * const *) a, *y = *(_Entry * const *) b;
+    int x_occurrences = atomic_load_explicit(&x->occurrences, memory_order_relaxed);
+    int y_occurrences = atomic_load_explicit(&y->occurrences, memory_order_relaxed);
+    if(x_occurrences != y_occurrences){
+        return (x_occurrences > y_occurrences) ? -1 : 1;
+    }
+    return strcmp(x->word, y->word);
+}
@@ -0,0 +1,101 @@
+#ifndef WORDMAP_H
+#define WORDMAP_H
+
+#include <stddef.h>
+
+typedef struct WordMap WordMap;
+
+/**
+ * @brief Funzione invocata dalle visite per ogni parola della mappa.
+ * Un valore di ritorno diverso da 0 interrompe la visita.
+ */
+typedef int (*WordMapVisitor)(const char *word, int occurrences, void *context);
+
+/**
+ * @brief Crea una mappa vuota delle occorrenze delle parole,
+ * in cui più thread possono inserire contemporaneamente.
+ * La mappa è divisa in shard indipendenti, ognuno una tabella
+ * a indirizzamento aperto: le parole vengono aggiunte con una
+ * compare-and-swap e le occorrenze incrementate atomicamente.
+ *
+ * @return WordMap* Il puntatore alla mappa creata
+ * @return NULL Failure
+ */
+WordMap *wordmap_new();
+
+/**
+ * @brief Libera la memoria riservata alla mappa
+ *
+ * @param map La mappa da distruggere
+ */
+void wordmap_destroy(WordMap *map);
+
+/**
+ * @brief Aggiunge le occorrenze specificate ai primi length
+ * caratteri di word, inserendo la parola se non è contenuta
+ * nella mappa. Può essere invocata da più thread insieme.
+ *
+ * @param word La parola da inserire, non necessariamente terminata da '\0'
+ * @param length La lunghezza della parola
+ * @param occurrences Le occorrenze da aggiungere
+ * @param map La mappa
+ * @return 0 Success
+ * @return -1 Failure, EOVERFLOW se le occorrenze superano INT_MAX
+ */
+int wordmap_insert_n(const char *word, size_t length, int occurrences, WordMap *map);
+
+/**
+ * @brief Restituisce le occorrenze dei primi length caratteri di word
+ *
+ * @param word La parola da cercare
+ * @param length La lunghezza della parola
+ * @param map La mappa
+ * @return int Le occorrenze, 0 se la parola non è contenuta
+ */
+int wordmap_get_occurrences_n(const char *word, size_t length, WordMap *map);
+
+/**
+ * @brief Restituisce il numero di parole distinte della mappa
+ *
+ * @param map La mappa
+ * @return size_t Il numero di parole
+ */
+size_t wordmap_get_words_count(const WordMap *map);
+
+/**
+ * @brief Restituisce i byte occupati dalle tabelle e dalle parole
+ *
+ * @param map La mappa
+ * @return size_t I byte occupati
+ */
+size_t wordmap_get_memory_usage(const WordMap *map);
+
+/**
+ * @brief Visita tutte le parole in ordine alfabetico, come trie_visit().
+ * Non deve essere invocata mentre altri thread inseriscono parole.
+ *
+ * @param map La mappa da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int wordmap_visit(const WordMap *map, WordMapVisitor visitor, void *context);
+
+/**
+ * @brief Visita tutte le parole in ordine decrescente di occorrenze
+ * e, a parità di occorrenze, in ordine alfabetico, come
+ * trie_visit_by_occurrences().
+ * Non deve essere invocata mentre altri thread inseriscono parole.
+ *
+ * @param map La mappa da visitare
+ * @param visitor La funzione da invocare per ogni parola
+ * @param context Puntatore passato invariato al visitor
+ * @return 0 Success
+ * @return -1 Failure
+ * @return int Il valore diverso da 0 restituito dal visitor
+ */
+int wordmap_visit_by_occurrences(const WordMap *map, WordMapVisitor visitor, void *context);
+
+#endif
@@ -0,0 +1,113 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "writer.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* Cifre di INT_MIN più il segno */
+#define INT_DIGITS_MAX 11
+
+static int _write_all(int fd, const char *data, size_t length);
+
+typedef struct Writer {
+    int fd;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+} Writer;
+
+Writer *writer_new(int fd, size_t capacity){
+    assert(fd >= 0);
+    assert(capacity >= INT_DIGITS_MAX);
+    Writer *writer = malloc(sizeof(Writer));
+    if(!writer){
+        return NULL;
+    }
+    writer->buffer = malloc(capacity);
+    if(!writer->buffer){
+        free(writer);
+        return NULL;
+    }
+    writer->fd = fd;
+    writer->length = 0;
+    writer->capacity = capacity;
+    return writer;
+}
+
+void writer_destroy(Writer *writer){
+    if(writer){
+        free(writer->buffer);
+        free(writer);
+    }
+}
+
+int writer_write(const char *data, size_t length, Writer *writer){
+    assert(writer);
+    if(writer->length + length > writer->capacity){
+        if(writer_flush(writer) < 0){
+            return -1;
+        }
+        /* I dati più grandi del buffer vengono scritti direttamente */
+        if(length > writer->capacity){
+            return _write_all(writer->fd, data, length);
+        }
+    }
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+    return 0;
+}
+
+int writer_write_char(char ch, Writer *writer){
+    assert(writer);
+    if(writer->length == writer->capacity && writer_flush(writer) < 0){
+        return -1;
+    }
+    writer->buffer[writer->length++] = ch;
+    return 0;
+}
+
+int writer_write_int(int value, Writer *writer){
+    assert(writer);
+    char digits[INT_DIGITS_MAX];
+    size_t position = INT_DIGITS_MAX;
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int) value : (unsigned int) value;
+    do {
+        digits[--position] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0){
+        digits[--position] = '-';
+    }
+    return writer_write(digits + position, INT_DIGITS_MAX - position, writer);
+}
+
+int writer_flush(Writer *writer){
+    assert(writer);
+    if(_write_all(writer->fd, writer->buffer, writer->length) < 0){
+        return -1;
+    }
+    writer->length = 0;
+    return 0;
+}
+
+/* Private Methods */
+
+static int _write_all(int fd, const char *data, size_t length){
+    while(length > 0){
+        ssize_t written = write(fd, data, length);
+        if(written < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        length -= written;
+    }
+    return 0;
+}
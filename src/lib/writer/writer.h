@@ -0,0 +1,69 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h>
+
+typedef struct Writer Writer;
+
+/**
+ * @brief Crea un writer che accumula i dati in un buffer
+ * di capacity byte e li scrive sul file descriptor con
+ * write() solo quando il buffer è pieno.
+ * Il file descriptor non viene chiuso dal writer.
+ * 
+ * @param fd Il file descriptor su cui scrivere
+ * @param capacity La dimensione del buffer
+ * @return Writer* Il puntatore al writer creato
+ * @return NULL Failure
+ */
+Writer *writer_new(int fd, size_t capacity);
+
+/**
+ * @brief Libera la memoria riservata al writer.
+ * I dati non ancora scritti vengono scartati.
+ * 
+ * @param writer Il writer da distruggere
+ */
+void writer_destroy(Writer *writer);
+
+/**
+ * @brief Accoda i primi length byte di data
+ * 
+ * @param data I dati da scrivere
+ * @param length Il numero di byte da scrivere
+ * @param writer Il writer su cui scrivere
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int writer_write(const char *data, size_t length, Writer *writer);
+
+/**
+ * @brief Accoda un carattere
+ * 
+ * @param ch Il carattere da scrivere
+ * @param writer Il writer su cui scrivere
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int writer_write_char(char ch, Writer *writer);
+
+/**
+ * @brief Accoda la rappresentazione decimale di un intero
+ * 
+ * @param value L'intero da scrivere
+ * @param writer Il writer su cui scrivere
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int writer_write_int(int value, Writer *writer);
+
+/**
+ * @brief Scrive sul file descriptor tutti i dati accodati
+ * 
+ * @param writer Il writer da svuotare
+ * @return 0 Success
+ * @return -1 Failure
+ */
+int writer_flush(Writer *writer);
+
+#endif
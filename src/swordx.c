@@ -6,74 +6,339 @@
 #include <errno.h>
 #include <glob.h>
 #include <ctype.h>
-#include <ftw.h>
 #include <string.h>
 #include <assert.h>
 #include <time.h>
 #include <getopt.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
 
 #include "lib/list/list.h"
 #include "lib/trie/trie.h"
-#include "lib/avltree/avltree.h"
+#include "lib/wordmap/wordmap.h"
+#include "lib/wordcount/wordcount.h"
+#include "lib/tokenizer/tokenizer.h"
+#include "lib/charclass/charclass.h"
+#include "lib/topk/topk.h"
+#include "lib/spacesaving/spacesaving.h"
+#include "lib/writer/writer.h"
+#include "lib/snapshot/snapshot.h"
+#include "lib/manifest/manifest.h"
+#include "lib/walker/walker.h"
+#include "lib/exclude/exclude.h"
+#include "lib/readahead/readahead.h"
+#include "lib/filelog/filelog.h"
+#include "lib/stats/stats.h"
+#include "lib/alloc/alloc.h"
+#include "lib/spill/spill.h"
+#include "lib/runfile/runfile.h"
+#include "lib/wordfilter/wordfilter.h"
 
 #define DEFAULT_OUTPUT_NAME "swordx.out"
+#define SNAPSHOT_SUFFIX ".snap"
+#define LOG_SUFFIX ".csv"
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+#define DEFAULT_READERS 0
+#define DEFAULT_QUEUE_DEPTH 16
+#define DEFAULT_BUFFER_SIZE_KB 1024
+#define DEFAULT_SPLIT_SIZE_MB 1024
+#define BOUNDARY_PROBE_SIZE (64 * 1024)
+#define STDIN_NAME "-"
+#define TEMP_SUFFIX ".tmp"
+#define STREAM_PIPE_SIZE (1024 * 1024)
+#define DEFAULT_TEMP_DIRECTORY "/tmp"
+/* Parole contate tra due controlli della memoria occupata con --memory-limit */
+#define SPILL_CHECK_INTERVAL 4096
+/* Memoria per ordinare per occorrenze le parole unite da --merge, senza --memory-limit */
+#define DEFAULT_MERGE_MEMORY_MB 256
 
 static bool recursive;
 static bool follow;
-static bool alpha;
 static bool sortbyoccurrency;
 static bool update;
 static bool log;
+static bool hugepages;
+static bool approx;
+static bool snapshot;
+static bool io_uring;
+static bool print_stats;
+static bool shared_map;
+static bool merge;
+/* Indica un'opzione che riguarda solo la visita e il conteggio dei file, non usata da --merge */
+static bool counting_options;
+/* --engine sceglie il motore di WordCount, che --shared-map e --approx non usano */
+static bool engine_selected;
 
 static struct OptArgs {
-    List *files_to_exclude;
-    Trie *words_to_ignore;
-    unsigned int minimum_word_length;
+    ExcludeSet *files_to_exclude;
+    WordFilter *words_filter;
     char *output_path;
     char *log_path;
+    char *snapshot_path;
+    char *manifest_path;
+    char *stats_path;
+    unsigned int threads;
+    unsigned int top;
+    unsigned int readers;
+    unsigned int queue_depth;
+    unsigned int buffer_size_kb;
+    unsigned int flush_mb;
+    unsigned int flush_seconds;
+    unsigned int split_size_mb;
+    unsigned int memory_limit_mb;
+    char *temp_directory;
+    unsigned int shard_index;
+    unsigned int shard_count;
+    WordCountEngine engine;
 } OptArgs;
 
-static List *files;
+static Walker *files;
+static WordMap *word_map;
+static Spill *spill;
+static List *streams;
+static FileLog *file_log;
+static Stats *run_stats;
+
+/*
+ * Destinazione dei conteggi: le parole contate dal motore scelto, con
+ * --shared-map la mappa condivisa da tutti i thread oppure,
+ * con --approx, lo sketch delle parole più frequenti.
+ * Con --memory-limit le parole contate oltre il limite vengono
+ * scaricate su disco e il conteggio ricomincia vuoto.
+ * Vengono contati anche i file, i byte e le parole lette, per --stats.
+ * live indica se il conteggio è tra quelli che si dividono --memory-limit.
+ */
+typedef struct Counter {
+    WordCount *words;
+    WordMap *map;
+    SpaceSaving *top_words;
+    bool live;
+    size_t files;
+    size_t bytes;
+    size_t tokens;
+    size_t valid_tokens;
+} Counter;
+
+/*
+ * Le parole distinte e i diversi numeri di occorrenze, raccolti per
+ * --stats mentre le parole vengono visitate per l'output. I numeri
+ * di occorrenze sono in un insieme a indirizzamento aperto, riempito
+ * al più per metà, in cui 0 indica un posto libero.
+ */
+typedef struct WordStats {
+    bool collected;
+    size_t words;
+    int *occurrences;
+    size_t buckets;
+    size_t capacity;
+} WordStats;
+
+/* Visita di visit_words() che raccoglie anche le WordStats */
+typedef struct StatsVisit {
+    WordCountVisitor visitor;
+    void *context;
+} StatsVisit;
+
+/*
+ * Parole dell'output precedente usate da --update: lo snapshot
+ * mappato quando è aggiornato, altrimenti il Trie ricostruito
+ * dal file di output.
+ */
+typedef struct ImportedWords {
+    Trie *words;
+    Snapshot *snapshot;
+} ImportedWords;
+
+/* Conteggio di un file da parte di count_tokens(): counted sono le parole già contate */
+typedef struct Counting {
+    Counter *counter;
+    const ImportedWords *imported_words;
+    size_t counted;
+} Counting;
+
+/* Destinazioni di save_output(): il file di output e, con --snapshot, lo snapshot */
+typedef struct Output {
+    Writer *text;
+    SnapshotWriter *snapshot;
+} Output;
+
+/*
+ * File da elaborare: quelli trovati dal walker oppure quelli di una
+ * lista. Con la lettura anticipata i file vengono letti dai thread
+ * di readahead e gli altri ricevono i file già letti.
+ */
+typedef struct FileSource {
+    Walker *walker;
+    ListIterator *iterator;
+    ReadAhead *readahead;
+} FileSource;
+
+/*
+ * Input letto man mano che i dati arrivano: lo standard input o una
+ * FIFO. Con --flush-mb e --flush-seconds i conteggi raggiunti vengono
+ * scritti nell'output anche prima della fine dell'input.
+ */
+typedef struct Stream {
+    int fd;
+    Counter *counter;
+    size_t unflushed_bytes;
+    double next_flush;
+} Stream;
+
+/*
+ * Intervallo [begin, end) di un file diviso tra più thread.
+ * Gli estremi cadono su uno spazio, quindi nessuna parola
+ * appartiene a due intervalli.
+ */
+typedef struct FileRange {
+    pthread_t thread;
+    int fd;
+    off_t begin;
+    off_t end;
+    Counter counter;
+    const ImportedWords *imported_words;
+    int result;
+} FileRange;
+
+typedef struct Worker {
+    pthread_t thread;
+    FileSource *files;
+    Counter counter;
+    const ImportedWords *imported_words;
+    ManifestWriter *manifest_writer;
+    int result;
+} Worker;
+
+static pthread_mutex_t files_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t manifest_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t range_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Thread che i file divisi possono ancora avviare: in tutto al più --threads - 1, tra tutti i worker */
+static unsigned int range_threads;
+/* Conteggi esistenti, dei worker e degli intervalli, tra cui è diviso --memory-limit */
+static atomic_uint live_counters;
+static WordStats word_stats;
 
 void process_command(int argc, char *argv[], List *inputs);
 void collect_inputs(char *inputs[], List *list);
+void collect_partials(List *inputs);
+bool parse_shard(const char *text);
+bool file_in_shard(const char *path, const char *root);
+uint64_t hash_text(const char *text, uint64_t hash);
 void collect_files(List *inputs);
-int manage_entry(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftbuf);
-void collect_words(Trie *words, AVLTree *occurr_words);
-int process_file(char *path, Trie *words, AVLTree *occurr_words, Trie *imported_words);
-char *get_word(FILE *fp);
-int write_log_line(char *logfilepath, char *name, int cw, int iw, double time);
-int import_words(FILE *file, Trie *trie);
-int save_word(char *word, Trie *words, AVLTree *occurr_words, Trie *imported_words);
-void save_output(char *output_path, Trie *words, AVLTree *occurr_words);
-int save_trie_on_file(char *filepath, Trie *trie);
-bool word_is_valid(const char *word);
+bool is_excluded(const char *path, uint64_t device, uint64_t inode, void *context);
+void collect_words(Counter *counter);
+bool is_stream(const char *path);
+int process_stream(const char *path, Counter *counter, const ImportedWords *imported_words);
+ssize_t read_stream(void *context, char *buffer, size_t size);
+void flush_output(Counter *counter);
+int collect_words_incremental(Counter *counter);
+int process_files(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer);
+int collect_words_parallel(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer);
+void *worker_run(void *args);
+const char *next_file(void *source);
+int process_next_file(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer);
+int process_input_file(const char *path, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer);
+int process_file(const char *path, Counter *counter, const ImportedWords *imported_words);
+int process_read_ahead_file(ReadAheadFile *file, Counter *counter, const ImportedWords *imported_words);
+int count_words(const char *path, double begin, Tokenizer *tokenizer, Counter *counter, const ImportedWords *imported_words, const ReadAheadFile *file);
+int count_tokens(Tokenizer *tokenizer, Counter *counter, const ImportedWords *imported_words);
+int count_word(const Token *token, void *counting);
+int record_file(const char *path, double begin, const Counter *before, Counter *counter, const ReadAheadFile *file);
+off_t get_split_size(int fd);
+int process_file_ranges(const char *path, int fd, off_t size, double begin, Counter *counter, const ImportedWords *imported_words, const ReadAheadFile *file);
+unsigned int reserve_range_threads(unsigned int wanted);
+void release_range_threads(unsigned int reserved);
+off_t find_range_boundary(int fd, off_t from, off_t size);
+void *range_run(void *args);
+ssize_t read_range(void *context, char *buffer, size_t size);
+int process_recorded_file(const char *path, Counter *counter, ManifestWriter *manifest_writer);
+int describe_file(const char *path, bool hash, ManifestFile *file);
+int file_is_unchanged(const char *path, const ManifestFile *recorded, ManifestFile *current);
+int add_word(const char *word, int occurrences, void *words);
+int subtract_word(const char *word, int occurrences, void *words);
+uint64_t get_settings_fingerprint();
+int write_log_summary(const ReadAheadStats *stats);
+int write_stats(Counter *counter);
+int collect_word_stats(const char *word, int occurrences, void *visit);
+int add_occurrence_bucket(int occurrences);
+bool insert_occurrence_bucket(int occurrences, int *buckets, size_t capacity);
+int ignore_word(const char *word, int occurrences, void *context);
+double get_time();
+int import_previous_output(ImportedWords *imported_words);
+bool snapshot_is_fresh(const char *snapshot_path, const char *output_path);
+bool imported_words_contains(const Token *token, const ImportedWords *imported_words);
+int import_words(int fd, Trie *trie);
+int import_ignored_words(int fd, WordFilter *filter);
+int save_word(const Token *token, Counter *counter, const ImportedWords *imported_words);
+void save_output(char *output_path, char *temp_path, Counter *counter);
+void save_partial(const char *output_path, Counter *counter);
+int save_top_words(Counter *counter, Output *output);
+int offer_word(const char *word, int occurrences, void *topk);
+int write_word(const char *word, int occurrences, void *output);
+int write_word_estimate(const char *word, int count, int error, void *output);
 char *get_absolute_path(const char *path);
 int convert_to_int(const char *text);
+WordCount *words_count_new();
+int counter_init(Counter *counter);
+int counter_merge(const Counter *source, Counter *destination);
+int counter_spill_if_full(Counter *counter);
+int counter_spill(Counter *counter);
+size_t get_counter_memory_limit();
+int visit_words(Counter *counter, bool by_occurrences, WordCountVisitor visitor, void *context);
+int visit_counted_words(Counter *counter, bool by_occurrences, WordCountVisitor visitor, void *context);
+void counter_destroy(Counter *counter);
 void initialize_global();
 void free_global();
 void exit_success();
 void die(char *message);
 void print_help();
+bool stats_requested(int argc, char *argv[]);
 
 int main(int argc, char *argv[]){
+    /* Le allocazioni vanno contate dalla prima, perché free() sottrae anche i blocchi precedenti */
+    if(stats_requested(argc, argv)){
+        alloc_enable_counting();
+    }
     initialize_global();
     List *inputs = list_new();
     if(!inputs) die(NULL);
-    Trie *words = trie_new();
-    if(!words) die(NULL);
-    AVLTree *occurr_words = avltree_new();
-    if(!occurr_words) die(NULL);
 
+    stats_begin_phase("process_command", run_stats);
     process_command(argc, argv, inputs);
-    collect_files(inputs);
-    collect_words(words, occurr_words);
-    save_output(OptArgs.output_path, words, occurr_words);
+    Counter counter;
+    if(counter_init(&counter) < 0) die(NULL);
+    if(merge){
+        stats_begin_phase("collect_partials", run_stats);
+        collect_partials(inputs);
+    } else {
+        stats_begin_phase("collect_files", run_stats);
+        collect_files(inputs);
+        stats_begin_phase("collect_words", run_stats);
+        collect_words(&counter);
+    }
+    if(filelog_close(file_log) < 0){
+        file_log = NULL;
+        die("Error writing the log");
+    }
+    file_log = NULL;
+    stats_begin_phase("save_output", run_stats);
+    if(OptArgs.shard_count > 0){
+        save_partial(OptArgs.output_path, &counter);
+    } else {
+        save_output(OptArgs.output_path, NULL, &counter);
+    }
+    stats_end_phase(run_stats);
+    if(print_stats && write_stats(&counter) < 0){
+        die("Error writing the stats");
+    }
 
     list_destroy(inputs);
-    trie_destroy(words);
-    avltree_destroy(occurr_words);
+    counter_destroy(&counter);
     free_global();
 }
 
@@ -97,9 +362,29 @@ void process_command(int argc, char *argv[], List *inputs){
         {"log", required_argument, NULL, 'l'},
         {"update", no_argument, NULL, 'u'},
         {"output", required_argument, NULL, 'o'},
+        {"threads", required_argument, NULL, 't'},
+        {"hugepages", no_argument, NULL, 'H'},
+        {"engine", required_argument, NULL, 'E'},
+        {"top", required_argument, NULL, 'k'},
+        {"approx", no_argument, NULL, 'A'},
+        {"snapshot", no_argument, NULL, 'S'},
+        {"manifest", required_argument, NULL, 'M'},
+        {"readers", required_argument, NULL, 'R'},
+        {"queue-depth", required_argument, NULL, 'Q'},
+        {"buffer-size", required_argument, NULL, 'B'},
+        {"io-uring", no_argument, NULL, 'U'},
+        {"stats", optional_argument, NULL, 'I'},
+        {"flush-mb", required_argument, NULL, 'F'},
+        {"flush-seconds", required_argument, NULL, 'W'},
+        {"split-size", required_argument, NULL, 'P'},
+        {"shared-map", no_argument, NULL, 'C'},
+        {"memory-limit", required_argument, NULL, 'L'},
+        {"temp-dir", required_argument, NULL, 'T'},
+        {"shard", required_argument, NULL, 'D'},
+        {"merge", no_argument, NULL, 'G'},
         {NULL, no_argument, NULL, 0}
     };
-    const char *short_opts = "hrfe:am:i:sl:uo:";
+    const char *short_opts = "hrfe:am:i:sl:uo:t:";
     
     int option_index = 0;
     int opt;
@@ -109,50 +394,49 @@ void process_command(int argc, char *argv[], List *inputs){
             case 'h': print_help(); exit_success(); 
                 break;
             case 'r': recursive = true;
+                counting_options = true;
                 break;
             case 'f': follow = true;
+                counting_options = true;
                 break;
-            case 'e': {
-                char *abspath = get_absolute_path(optarg);
-                if(!abspath){
+            case 'e':
+                counting_options = true;
+                if(exclude_set_add(optarg, OptArgs.files_to_exclude) < 0){
                     die("Invalid --exclude argument");
                 }
-                list_append(abspath, OptArgs.files_to_exclude);
-            }
                 break;
-            case 'a': alpha = true;
+            case 'a': wordfilter_set_alpha(true, OptArgs.words_filter);
+                counting_options = true;
                 break;
             case 'm': {
+                counting_options = true;
                 int min = convert_to_int(optarg);
                 if(min < 0){
                     errno = EIO;
                     die("Invalid --minimum argument");
                 } else {
-                    OptArgs.minimum_word_length = min;
+                    wordfilter_set_minimum_length(min, OptArgs.words_filter);
                 }
             } break;
             case 'i': {
-                FILE *file = fopen(optarg, "r");
-                if(!file)
+                counting_options = true;
+                int fd = open(optarg, O_RDONLY);
+                if(fd < 0)
                     die("Invalid --ignore argument");
-                char *word;
-                while( (word = get_word(file)) != NULL){
-                    if(word_is_valid(word)){
-                        if( (trie_insert(word, OptArgs.words_to_ignore)) < 0){
-                            die("Ignore fail arg");
-                        }
-                    }
+                if( (import_ignored_words(fd, OptArgs.words_filter)) < 0){
+                    die("Ignore fail arg");
                 }
             } break;
             case 's': sortbyoccurrency = true;
                 break;
             case 'l': {
                 log = true;
-                OptArgs.log_path = malloc(strlen(optarg) +1);
+                free(OptArgs.log_path);
+                OptArgs.log_path = malloc(strlen(optarg) + strlen(LOG_SUFFIX) + 1);
                 if(!OptArgs.log_path){
                     die("Error with --log argument");
                 }
-                strcpy(OptArgs.log_path, optarg);
+                sprintf(OptArgs.log_path, "%s%s", optarg, LOG_SUFFIX);
             }
                 break;
             case 'u': update = true;
@@ -165,24 +449,238 @@ void process_command(int argc, char *argv[], List *inputs){
                 strcpy(OptArgs.output_path, optarg);
             }
                 break;
+            case 't': {
+                int threads = convert_to_int(optarg);
+                if(threads < 1){
+                    errno = EIO;
+                    die("Invalid --threads argument");
+                } else {
+                    OptArgs.threads = threads;
+                }
+            } break;
+            case 'H': hugepages = true;
+                break;
+            case 'E':
+                counting_options = true;
+                engine_selected = true;
+                if(strcmp(optarg, "trie") == 0){
+                    OptArgs.engine = WORDCOUNT_TRIE;
+                } else if(strcmp(optarg, "hash") == 0){
+                    OptArgs.engine = WORDCOUNT_HASH;
+                } else {
+                    errno = EIO;
+                    die("Invalid --engine argument");
+                }
+                break;
+            case 'k': {
+                int top = convert_to_int(optarg);
+                if(top < 1){
+                    errno = EIO;
+                    die("Invalid --top argument");
+                } else {
+                    OptArgs.top = top;
+                }
+            } break;
+            case 'A': approx = true;
+                break;
+            case 'S': snapshot = true;
+                break;
+            case 'M': {
+                OptArgs.manifest_path = malloc(strlen(optarg) +1);
+                if(!OptArgs.manifest_path){
+                    die("Error with --manifest argument");
+                }
+                strcpy(OptArgs.manifest_path, optarg);
+            }
+                break;
+            case 'R': {
+                int readers = convert_to_int(optarg);
+                if(readers < 0){
+                    errno = EIO;
+                    die("Invalid --readers argument");
+                } else {
+                    OptArgs.readers = readers;
+                }
+            } break;
+            case 'Q': {
+                int depth = convert_to_int(optarg);
+                if(depth < 1){
+                    errno = EIO;
+                    die("Invalid --queue-depth argument");
+                } else {
+                    OptArgs.queue_depth = depth;
+                }
+            } break;
+            case 'B': {
+                int size = convert_to_int(optarg);
+                if(size < 1){
+                    errno = EIO;
+                    die("Invalid --buffer-size argument");
+                } else {
+                    OptArgs.buffer_size_kb = size;
+                }
+            } break;
+            case 'U': io_uring = true;
+                break;
+            case 'I': {
+                print_stats = true;
+                free(OptArgs.stats_path);
+                OptArgs.stats_path = NULL;
+                if(optarg){
+                    OptArgs.stats_path = malloc(strlen(optarg) + 1);
+                    if(!OptArgs.stats_path){
+                        die("Error with --stats argument");
+                    }
+                    strcpy(OptArgs.stats_path, optarg);
+                }
+            } break;
+            case 'F': {
+                int size = convert_to_int(optarg);
+                if(size < 1){
+                    errno = EIO;
+                    die("Invalid --flush-mb argument");
+                } else {
+                    OptArgs.flush_mb = size;
+                }
+            } break;
+            case 'W': {
+                int seconds = convert_to_int(optarg);
+                if(seconds < 1){
+                    errno = EIO;
+                    die("Invalid --flush-seconds argument");
+                } else {
+                    OptArgs.flush_seconds = seconds;
+                }
+            } break;
+            case 'P': {
+                int size = convert_to_int(optarg);
+                if(size < 0){
+                    errno = EIO;
+                    die("Invalid --split-size argument");
+                } else {
+                    OptArgs.split_size_mb = size;
+                }
+            } break;
+            case 'C': shared_map = true;
+                break;
+            case 'L': {
+                int size = convert_to_int(optarg);
+                if(size < 1){
+                    errno = EIO;
+                    die("Invalid --memory-limit argument");
+                } else {
+                    OptArgs.memory_limit_mb = size;
+                }
+            } break;
+            case 'T': {
+                free(OptArgs.temp_directory);
+                OptArgs.temp_directory = malloc(strlen(optarg) + 1);
+                if(!OptArgs.temp_directory){
+                    die("Error with --temp-dir argument");
+                }
+                strcpy(OptArgs.temp_directory, optarg);
+            } break;
+            case 'D':
+                if(!parse_shard(optarg)){
+                    errno = EIO;
+                    die("Invalid --shard argument");
+                }
+                break;
+            case 'G': merge = true;
+                break;
             case '?': print_help(); errno = EIO; die("Option not valid");
                 break;
             default: print_help(); errno = EIO; die("Option not valid");
                 break;
         }
     }
+    if(approx && OptArgs.top == 0){
+        errno = EIO;
+        die("--approx requires --top");
+    }
+    if(OptArgs.manifest_path && (approx || update)){
+        errno = EIO;
+        die("--manifest cannot be used with --approx or --update");
+    }
+    if(shared_map && (approx || OptArgs.manifest_path)){
+        errno = EIO;
+        die("--shared-map cannot be used with --approx or --manifest");
+    }
+    if(engine_selected && (shared_map || approx)){
+        errno = EIO;
+        die("--engine cannot be used with --shared-map or --approx");
+    }
+    if(shared_map && (word_map = wordmap_new()) == NULL){
+        die("Error with --shared-map argument");
+    }
+    if(OptArgs.memory_limit_mb > 0 && (approx || shared_map || OptArgs.manifest_path)){
+        errno = EIO;
+        die("--memory-limit cannot be used with --approx, --shared-map or --manifest");
+    }
+    if(OptArgs.shard_count > 0 && (approx || update || snapshot || sortbyoccurrency || OptArgs.top > 0 || OptArgs.manifest_path)){
+        errno = EIO;
+        die("--shard cannot be used with --approx, --update, --snapshot, --sortbyoccurrency, --top or --manifest");
+    }
+    if(merge && (OptArgs.shard_count > 0 || approx || update || shared_map || OptArgs.manifest_path)){
+        errno = EIO;
+        die("--merge cannot be used with --shard, --approx, --update, --shared-map or --manifest");
+    }
+    /* I parziali sono già filtrati e contati: le opzioni del conteggio non avrebbero effetto */
+    if(merge && (counting_options || log)){
+        errno = EIO;
+        die("--merge cannot be used with -r, -f, -e, -a, -m, -i, -l or --engine");
+    }
+    /* Le parole unite vengono ordinate per occorrenze a blocchi, come con --memory-limit */
+    if(merge && OptArgs.memory_limit_mb == 0){
+        OptArgs.memory_limit_mb = DEFAULT_MERGE_MEMORY_MB;
+    }
+    if(OptArgs.memory_limit_mb > 0){
+        const char *directory = OptArgs.temp_directory;
+        if(!directory){
+            directory = (getenv("TMPDIR")) ? getenv("TMPDIR") : DEFAULT_TEMP_DIRECTORY;
+        }
+        spill = spill_new(directory);
+        if(!spill){
+            die("Error with --temp-dir argument");
+        }
+    }
     if(optind == argc){
         errno = EIO;
         die("No input to be processed has been specified");
     }
+    else if(merge){
+        for(int i = optind; i < argc; i++){
+            if(list_append(argv[i], inputs) < 0)
+                die("Error in inputs collect");
+        }
+    }
     else{
         collect_inputs(argv+optind, inputs);
     }
+    if(OptArgs.manifest_path && list_get_elements_count(streams) > 0){
+        errno = EIO;
+        die("--manifest cannot be used with standard input or FIFO inputs");
+    }
+    if(OptArgs.shard_count > 0 && list_get_elements_count(streams) > 0){
+        errno = EIO;
+        die("--shard cannot be used with standard input or FIFO inputs");
+    }
 
     if(OptArgs.output_path == NULL){
         OptArgs.output_path = malloc(strlen(DEFAULT_OUTPUT_NAME) +1);
         strcpy(OptArgs.output_path, DEFAULT_OUTPUT_NAME);
     }
+    OptArgs.snapshot_path = malloc(strlen(OptArgs.output_path) + strlen(SNAPSHOT_SUFFIX) + 1);
+    if(!OptArgs.snapshot_path){
+        die("Error with --output argument");
+    }
+    sprintf(OptArgs.snapshot_path, "%s%s", OptArgs.output_path, SNAPSHOT_SUFFIX);
+    if(log){
+        file_log = filelog_open(OptArgs.log_path);
+        if(!file_log){
+            die("Error with --log argument");
+        }
+    }
 }
 
 void collect_inputs(char *inputs[], List *list){
@@ -190,6 +688,13 @@ void collect_inputs(char *inputs[], List *list){
     glob_t results;
     int ret;
     for(int i = 0; inputs[i] != NULL; i++){
+        /* Lo standard input e le FIFO non vengono visitati ma letti a parte */
+        if(strcmp(inputs[i], STDIN_NAME) == 0 || is_stream(inputs[i])){
+            const char *path = (strcmp(inputs[i], STDIN_NAME) == 0) ? STDIN_NAME : get_absolute_path(inputs[i]);
+            if(list_append(path, streams) < 0)
+                die("Error in inputs collect");
+            continue;
+        }
         ret = glob(inputs[i], 0, NULL, &results);
         if(ret != 0){
             errno = EIO;
@@ -204,7 +709,7 @@ void collect_inputs(char *inputs[], List *list){
             }
             die("Regex Error. Unknow problem");
         }
-        for(int j = 0; j < results.gl_pathc; j++){
+        for(size_t j = 0; j < results.gl_pathc; j++){
             if(list_append(get_absolute_path(results.gl_pathv[j]), list) < 0)
             die("Error in inputs collect"); 
         }
@@ -212,233 +717,1078 @@ void collect_inputs(char *inputs[], List *list){
     }
 }
 
+/*
+ * I conteggi parziali non vengono caricati in memoria: diventano
+ * scarichi, uniti quando viene scritto l'output.
+ */
+void collect_partials(List *inputs){
+    ListIterator *iterator = list_iterator_new(inputs);
+    if(!iterator){
+        die("Error in inputs collect");
+    }
+    while(list_iterator_has_next(iterator)){
+        list_iterator_advance(iterator);
+        const char *path = list_iterator_get_element(iterator);
+        RunReader *reader = runfile_reader_open(path);
+        bool valid = reader && runfile_reader_get_order(reader) == RUNFILE_BY_WORD;
+        if(reader && !valid){
+            errno = EINVAL;
+        }
+        runfile_reader_close(reader);
+        if(!valid){
+            list_iterator_destroy(iterator);
+            die("Invalid partial count file");
+        }
+        if(spill_add_run(path, spill) < 0){
+            list_iterator_destroy(iterator);
+            die("Error in inputs collect");
+        }
+    }
+    list_iterator_destroy(iterator);
+}
+
+/* Legge i/N, con 1 <= i <= N, come in split -n */
+bool parse_shard(const char *text){
+    const char *separator = strchr(text, '/');
+    if(!separator || separator == text){
+        return false;
+    }
+    char index[16];
+    size_t length = separator - text;
+    if(length >= sizeof(index)){
+        return false;
+    }
+    memcpy(index, text, length);
+    index[length] = '\0';
+    int shard = convert_to_int(index), count = convert_to_int(separator + 1);
+    if(shard < 1 || count < 1 || shard > count){
+        return false;
+    }
+    OptArgs.shard_index = shard - 1;
+    OptArgs.shard_count = count;
+    return true;
+}
+
+/*
+ * Un file appartiene a un solo shard, scelto dall'hash FNV-1a del nome
+ * dell'input in cui è stato trovato seguito dal resto del percorso:
+ * processi diversi a cui sono dati gli stessi input si dividono i file
+ * senza comunicare, anche se gli input sono in cartelle diverse.
+ */
+bool file_in_shard(const char *path, const char *root){
+    const char *name = strrchr(root, '/');
+    uint64_t hash = hash_text((name) ? name + 1 : root, 0xcbf29ce484222325u);
+    hash = hash_text(path + strlen(root), hash);
+    return hash % OptArgs.shard_count == OptArgs.shard_index;
+}
+
+uint64_t hash_text(const char *text, uint64_t hash){
+    for(; *text; text++){
+        hash = (hash ^ (unsigned char) *text) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+/*
+ * Avvia la visita delle cartelle: i file vengono elaborati
+ * man mano che il walker li trova.
+ */
 void collect_files(List *inputs){
     assert(inputs);
-    assert(files);
-    int flags = 0;
-    flags |= FTW_ACTIONRETVAL;
-    if(!follow){
-        flags |= FTW_PHYS;
+    WalkerOptions options = {recursive, follow, OptArgs.threads, is_excluded, NULL};
+    files = walker_new(&options);
+    if(!files){
+        die("Error in files collecting");
     }
     ListIterator *iterator = list_iterator_new(inputs);
     while(list_iterator_has_next(iterator)){
         list_iterator_advance(iterator);
         char *path = list_iterator_get_element(iterator);
-        if( (nftw(path, manage_entry, 20, flags)) == -1){
+        if( (walker_add_root(path, files)) < 0){
             die("Error in files collecting");
         }
     }
     list_iterator_destroy(iterator);
+    if( (walker_start(files)) < 0){
+        die("Error in files collecting");
+    }
 }
 
-int manage_entry(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftbuf){
-    if(typeflag == FTW_F){
-        if(!list_contains(fpath, OptArgs.files_to_exclude)){
-            if( list_append(fpath, files) == 0)
-                return FTW_CONTINUE;
-            else
-                return FTW_STOP;
+bool is_excluded(const char *path, uint64_t device, uint64_t inode, void *context){
+    (void) context;
+    return exclude_set_contains(path, device, inode, OptArgs.files_to_exclude);
+}
+
+void collect_words(Counter *counter){
+    assert(counter);
+    assert(files);
+    ImportedWords imported = {NULL, NULL};
+    const ImportedWords *imported_words = NULL;
+
+    if(update){
+        if( (import_previous_output(&imported)) < 0){
+            die("Fail with word import");
         }
+        imported_words = &imported;
     }
-    if( (typeflag == FTW_D && recursive == true) || ftbuf->level == 0){
-        return FTW_CONTINUE;
+    range_threads = OptArgs.threads - 1;
+    int res;
+    if(OptArgs.manifest_path){
+        res = collect_words_incremental(counter);
     } else {
-        return FTW_SKIP_SUBTREE;
+        FileSource source = {files, NULL, NULL};
+        res = process_files(&source, counter, imported_words, NULL);
+    }
+    if(res < 0){
+        die("Fail with file processing");
+    }
+    if( (walker_wait(files)) < 0){
+        die("Error in files collecting");
+    }
+    ListIterator *iterator = list_iterator_new(streams);
+    if(!iterator){
+        die("Fail with stream processing");
+    }
+    while(list_iterator_has_next(iterator)){
+        list_iterator_advance(iterator);
+        if(process_stream(list_iterator_get_element(iterator), counter, imported_words) < 0){
+            die("Fail with stream processing");
+        }
     }
-    return FTW_STOP;
+    list_iterator_destroy(iterator);
+    trie_destroy(imported.words);
+    snapshot_close(imported.snapshot);
 }
 
-void collect_words(Trie *words, AVLTree *occurr_words){
-    assert(words);
-    assert(files);
-    if(sortbyoccurrency)
-        assert(occurr_words);
-    Trie *imported_words = NULL;
+/* Le FIFO e i dispositivi a caratteri non hanno una dimensione e non si possono rileggere */
+bool is_stream(const char *path){
+    struct stat info;
+    if(stat(path, &info) < 0){
+        return false;
+    }
+    return S_ISFIFO(info.st_mode) || S_ISCHR(info.st_mode);
+}
 
-    if(update){
-        if( (imported_words = trie_new()) == NULL){
-            die("Init fail");
+/*
+ * Legge l'input fino alla fine, dividendolo in parole blocco per
+ * blocco: la memoria usata non dipende dalla lunghezza dell'input.
+ * Lo standard input non viene chiuso.
+ */
+int process_stream(const char *path, Counter *counter, const ImportedWords *imported_words){
+    double begin = get_time();
+    Stream stream = {STDIN_FILENO, counter, 0, begin + OptArgs.flush_seconds};
+    if(strcmp(path, STDIN_NAME) != 0){
+        stream.fd = open(path, O_RDONLY);
+        if(stream.fd < 0){
+            return -1;
         }
-        if( (import_words(fopen(OptArgs.output_path, "r"), imported_words)) < 0){
-            die("Fail with word import");
+    }
+    /* Una pipe più capiente riduce i risvegli; se non è una pipe l'errore non conta */
+    fcntl(stream.fd, F_SETPIPE_SZ, STREAM_PIPE_SIZE);
+    Tokenizer *tokenizer = tokenizer_new_reader(read_stream, &stream);
+    int res = (tokenizer) ? count_words(path, begin, tokenizer, counter, imported_words, NULL) : -1;
+    tokenizer_destroy(tokenizer);
+    if(stream.fd != STDIN_FILENO){
+        close(stream.fd);
+    }
+    return res;
+}
+
+/*
+ * Il tokenizer chiede altri dati solo dopo aver diviso quelli già
+ * letti, quindi i conteggi scritti prima di una lettura comprendono
+ * tutte le parole complete ricevute. Con --flush-seconds l'attesa
+ * dei dati è limitata, così l'output viene aggiornato anche quando
+ * l'input è fermo.
+ */
+ssize_t read_stream(void *context, char *buffer, size_t size){
+    Stream *stream = context;
+    for(;;){
+        double now = get_time();
+        bool bytes_due = OptArgs.flush_mb > 0 && stream->unflushed_bytes >= (size_t) OptArgs.flush_mb * 1024 * 1024;
+        bool time_due = OptArgs.flush_seconds > 0 && now >= stream->next_flush;
+        if(bytes_due || time_due){
+            flush_output(stream->counter);
+            stream->unflushed_bytes = 0;
+            stream->next_flush = now + OptArgs.flush_seconds;
+        }
+        if(OptArgs.flush_seconds > 0){
+            struct pollfd request = {stream->fd, POLLIN, 0};
+            int ready = poll(&request, 1, (int) ((stream->next_flush - now) * 1000) + 1);
+            if(ready < 0 && errno != EINTR){
+                return -1;
+            }
+            if(ready <= 0){
+                continue;
+            }
+        }
+        ssize_t res = read(stream->fd, buffer, size);
+        if(res < 0 && errno == EINTR){
+            continue;
+        }
+        if(res > 0){
+            stream->unflushed_bytes += res;
+        }
+        return res;
+    }
+}
+
+/* Scrive i conteggi raggiunti su un file temporaneo che poi sostituisce l'output */
+void flush_output(Counter *counter){
+    char *temp_path = malloc(strlen(OptArgs.output_path) + strlen(TEMP_SUFFIX) + 1);
+    if(!temp_path){
+        die("Error in output file");
+    }
+    sprintf(temp_path, "%s%s", OptArgs.output_path, TEMP_SUFFIX);
+    save_output(OptArgs.output_path, temp_path, counter);
+    free(temp_path);
+}
+
+/*
+ * Elabora solo i file aggiunti o modificati rispetto al manifest:
+ * ai totali registrati vengono sottratte le occorrenze dei file
+ * modificati o rimossi e aggiunte quelle dei file elaborati.
+ * Se il manifest manca o è stato scritto con opzioni diverse
+ * vengono elaborati tutti i file.
+ */
+int collect_words_incremental(Counter *counter){
+    assert(counter->words);
+    uint64_t settings = get_settings_fingerprint();
+    Manifest *previous = manifest_open(OptArgs.manifest_path, settings);
+    size_t previous_count = (previous) ? manifest_get_files_count(previous) : 0;
+    ManifestWriter *manifest_writer = manifest_writer_new(OptArgs.manifest_path, settings);
+    List *pending = list_new();
+    bool *seen = calloc(previous_count + 1, sizeof(bool));
+    int res = (manifest_writer && pending && seen) ? 0 : -1;
+    if(res == 0 && previous){
+        res = manifest_visit_totals(add_word, counter->words, previous);
+    }
+    const char *file;
+    while(res == 0 && (file = walker_next(files)) != NULL){
+        res = manifest_writer_claim(file, manifest_writer);
+        if(res <= 0){
+            continue;
+        }
+        res = 0;
+        long index = (previous) ? manifest_find(file, previous) : -1;
+        if(index >= 0){
+            ManifestFile recorded, current;
+            seen[index] = true;
+            manifest_get_file(index, &recorded, previous);
+            int unchanged = file_is_unchanged(file, &recorded, &current);
+            if(unchanged > 0){
+                res = manifest_writer_copy_file(&current, index, previous, manifest_writer);
+                continue;
+            }
+            res = (unchanged < 0) ? -1 : manifest_visit_file_words(index, subtract_word, counter->words, previous);
+        }
+        if(res == 0){
+            res = list_append(file, pending);
+        }
+    }
+    for(size_t i = 0; res == 0 && i < previous_count; i++){
+        if(!seen[i]){
+            res = manifest_visit_file_words(i, subtract_word, counter->words, previous);
+        }
+    }
+    /* I file rimossi sono noti solo alla fine della visita */
+    if(res == 0 && walker_wait(files) < 0){
+        res = -1;
+    }
+    ListIterator *pending_iterator = (res == 0) ? list_iterator_new(pending) : NULL;
+    if(pending_iterator){
+        FileSource source = {NULL, pending_iterator, NULL};
+        res = process_files(&source, counter, NULL, manifest_writer);
+        list_iterator_destroy(pending_iterator);
+    } else {
+        res = -1;
+    }
+    if(res == 0){
+        res = manifest_writer_begin_totals(manifest_writer);
+    }
+    if(res == 0){
+        res = wordcount_visit(counter->words, manifest_writer_add_word, manifest_writer);
+    }
+    if(res == 0){
+        res = manifest_writer_close(manifest_writer);
+        manifest_writer = NULL;
+    }
+    manifest_writer_destroy(manifest_writer);
+    manifest_close(previous);
+    list_destroy(pending);
+    free(seen);
+    return (res == 0) ? 0 : -1;
+}
+
+/*
+ * Con la lettura anticipata i thread di readahead aprono e leggono
+ * i file mentre quelli di elaborazione li dividono in parole.
+ * I file registrati nel manifest vengono letti anche per calcolarne
+ * l'hash, quindi vengono elaborati senza lettura anticipata.
+ */
+int process_files(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer){
+    assert(source);
+    assert(counter);
+    if(OptArgs.readers > 0 && !manifest_writer){
+        ReadAheadOptions options = {OptArgs.readers, OptArgs.queue_depth, (size_t) OptArgs.buffer_size_kb * 1024, io_uring};
+        source->readahead = readahead_new(&options, next_file, source);
+        if(!source->readahead || readahead_start(source->readahead) < 0){
+            readahead_destroy(source->readahead);
+            source->readahead = NULL;
+            return -1;
         }
     }
-    ListIterator *files_iterator = list_iterator_new(files);
-    while(list_iterator_has_next(files_iterator)){
-        list_iterator_advance(files_iterator);
-        char *file = list_iterator_get_element(files_iterator);
-        if( (process_file(file, words, occurr_words, imported_words)) < 0 ){
-            die("Fail with file processing");
+    int res;
+    if(OptArgs.threads > 1){
+        res = collect_words_parallel(source, counter, imported_words, manifest_writer);
+    } else {
+        do{
+            res = process_next_file(source, counter, imported_words, manifest_writer);
+        }while(res > 0);
+    }
+    if(source->readahead){
+        if(res == 0 && log){
+            ReadAheadStats stats;
+            readahead_get_stats(source->readahead, &stats);
+            res = write_log_summary(&stats);
         }
+        readahead_destroy(source->readahead);
+        source->readahead = NULL;
     }
-    list_iterator_destroy(files_iterator);
-    trie_destroy(imported_words);
+    return res;
 }
 
-int import_words(FILE *file, Trie *trie){
-    if(!file){
+int collect_words_parallel(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer){
+    assert(counter);
+    int res = 0;
+    Worker *workers = calloc(OptArgs.threads, sizeof(Worker));
+    if(!workers){
+        return -1;
+    }
+    unsigned int started = 0;
+    for(; started < OptArgs.threads; started++){
+        Worker *worker = &workers[started];
+        worker->files = source;
+        worker->imported_words = imported_words;
+        worker->manifest_writer = manifest_writer;
+        if(counter_init(&worker->counter) < 0){
+            res = -1;
+            break;
+        }
+        if(pthread_create(&worker->thread, NULL, worker_run, worker) != 0){
+            counter_destroy(&worker->counter);
+            res = -1;
+            break;
+        }
+    }
+    for(unsigned int i = 0; i < started; i++){
+        pthread_join(workers[i].thread, NULL);
+        if(workers[i].result < 0 || counter_merge(&workers[i].counter, counter) < 0){
+            res = -1;
+        }
+        counter_destroy(&workers[i].counter);
+    }
+    free(workers);
+    return res;
+}
+
+void *worker_run(void *args){
+    Worker *worker = args;
+    int res;
+    do{
+        res = process_next_file(worker->files, &worker->counter, worker->imported_words, worker->manifest_writer);
+    }while(res > 0);
+    worker->result = res;
+    return NULL;
+}
+
+const char *next_file(void *files){
+    FileSource *source = files;
+    if(source->walker){
+        const char *file, *root;
+        while( (file = walker_next_with_root(&root, source->walker)) != NULL && OptArgs.shard_count > 0 && !file_in_shard(file, root));
+        return file;
+    }
+    char *file = NULL;
+    pthread_mutex_lock(&files_mutex);
+    if(list_iterator_has_next(source->iterator)){
+        list_iterator_advance(source->iterator);
+        file = list_iterator_get_element(source->iterator);
+    }
+    pthread_mutex_unlock(&files_mutex);
+    return file;
+}
+
+int import_previous_output(ImportedWords *imported_words){
+    if(snapshot_is_fresh(OptArgs.snapshot_path, OptArgs.output_path)){
+        imported_words->snapshot = snapshot_open(OptArgs.snapshot_path);
+        if(imported_words->snapshot){
+            return 0;
+        }
+    }
+    if( (imported_words->words = trie_new()) == NULL){
+        return -1;
+    }
+    return import_words(open(OptArgs.output_path, O_RDONLY), imported_words->words);
+}
+
+/* Lo snapshot è valido se non è più vecchio del file di output */
+bool snapshot_is_fresh(const char *snapshot_path, const char *output_path){
+    struct stat snapshot_info, output_info;
+    if(stat(snapshot_path, &snapshot_info) < 0){
+        return false;
+    }
+    if(stat(output_path, &output_info) < 0){
+        return true;
+    }
+    if(snapshot_info.st_mtim.tv_sec != output_info.st_mtim.tv_sec){
+        return snapshot_info.st_mtim.tv_sec > output_info.st_mtim.tv_sec;
+    }
+    return snapshot_info.st_mtim.tv_nsec >= output_info.st_mtim.tv_nsec;
+}
+
+bool imported_words_contains(const Token *token, const ImportedWords *imported_words){
+    if(imported_words->snapshot){
+        return snapshot_contains_n(token->word, token->length, imported_words->snapshot);
+    }
+    return trie_contains_n(token->word, token->length, imported_words->words);
+}
+
+int import_words(int fd, Trie *trie){
+    if(fd < 0){
         return -1;
     }
     assert(trie);
-    char *word;
-    while( (word = get_word(file)) != NULL){
-        if(word_is_valid(word)){
-            if(trie_insert(word, trie) < 0)
-                return -1;
+    Tokenizer *tokenizer = tokenizer_new(fd);
+    if(!tokenizer){
+        close(fd);
+        return -1;
+    }
+    int res;
+    Token token;
+    while( (res = tokenizer_next(tokenizer, &token)) > 0){
+        if(wordfilter_accepts(&token, OptArgs.words_filter)){
+            if(trie_insert_n(token.word, token.length, 1, trie) < 0)
+                res = -1;
             else
-                if( (word = get_word(file)) == NULL)
-                    return -1;
+                res = tokenizer_next(tokenizer, &token);
+            if(res <= 0){
+                res = -1;
+                break;
+            }
         }
     }
-    fclose(file);
-    return 0;
+    tokenizer_destroy(tokenizer);
+    close(fd);
+    return (res < 0) ? -1 : 0;
 }
 
-int process_file(char *path, Trie *words, AVLTree *occurr_words, Trie *imported_words){
-    assert(words);
-    if(sortbyoccurrency)
-        assert(occurr_words);
-    if(update)
-        assert(imported_words);
-    int words_count = 0, words_valid = 0, words_ignored = 0;
-    clock_t begin = clock();
-    char *word;
-    FILE *file = fopen(path, "r");
-    if(!file)
+int import_ignored_words(int fd, WordFilter *filter){
+    assert(fd >= 0);
+    assert(filter);
+    Tokenizer *tokenizer = tokenizer_new(fd);
+    if(!tokenizer){
+        close(fd);
         return -1;
-    while( (word = get_word(file)) != NULL){
-        words_count++;
-        if(word_is_valid(word)){
-            if(!update || trie_contains(word, imported_words)){
-                if( (save_word(word, words, occurr_words, imported_words) < 0))
-                    return -1;
-                words_valid++;
-            }
+    }
+    int res = wordfilter_ignore_tokens(tokenizer, filter);
+    tokenizer_destroy(tokenizer);
+    close(fd);
+    return (res < 0) ? -1 : 0;
+}
+
+/* Restituisce 1 se è stato elaborato un file, 0 se i file sono terminati */
+int process_next_file(FileSource *source, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer){
+    if(source->readahead){
+        ReadAheadFile *file = readahead_next(source->readahead);
+        if(!file){
+            return 0;
         }
+        int res = process_read_ahead_file(file, counter, imported_words);
+        readahead_release(file, source->readahead);
+        return (res < 0) ? -1 : 1;
+    }
+    const char *file = next_file(source);
+    if(!file){
+        return 0;
+    }
+    return (process_input_file(file, counter, imported_words, manifest_writer) < 0) ? -1 : 1;
+}
+
+int process_input_file(const char *path, Counter *counter, const ImportedWords *imported_words, ManifestWriter *manifest_writer){
+    if(manifest_writer){
+        return process_recorded_file(path, counter, manifest_writer);
+    }
+    return process_file(path, counter, imported_words);
+}
+
+int process_file(const char *path, Counter *counter, const ImportedWords *imported_words){
+    double begin = get_time();
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return -1;
+    off_t size = get_split_size(fd);
+    int res;
+    if(size > 0){
+        res = process_file_ranges(path, fd, size, begin, counter, imported_words, NULL);
+    } else {
+        Tokenizer *tokenizer = tokenizer_new(fd);
+        res = (tokenizer) ? count_words(path, begin, tokenizer, counter, imported_words, NULL) : -1;
+        tokenizer_destroy(tokenizer);
+    }
+    close(fd);
+    return res;
+}
+
+int process_read_ahead_file(ReadAheadFile *file, Counter *counter, const ImportedWords *imported_words){
+    double begin = get_time();
+    if(file->error){
+        errno = file->error;
+        return -1;
     }
-    fclose(file);
-    clock_t end = clock();
-    double time_spent = (double) (end-begin) / CLOCKS_PER_SEC;
-    words_ignored = words_count - words_valid;
+    /* Un file da dividere viene riletto per intervalli, scartando l'inizio già letto */
+    int fd = readahead_get_fd(file);
+    off_t size = (fd >= 0) ? get_split_size(fd) : 0;
+    if(size > 0){
+        return process_file_ranges(file->path, fd, size, begin, counter, imported_words, file);
+    }
+    Tokenizer *tokenizer = tokenizer_new_reader(readahead_read, file);
+    int res = (tokenizer) ? count_words(file->path, begin, tokenizer, counter, imported_words, file) : -1;
+    tokenizer_destroy(tokenizer);
+    return res;
+}
+
+/*
+ * begin è l'istante in cui è iniziata l'elaborazione del file, file
+ * è il file letto in anticipo da cui legge il tokenizer, NULL se non c'è
+ */
+int count_words(const char *path, double begin, Tokenizer *tokenizer, Counter *counter, const ImportedWords *imported_words, const ReadAheadFile *file){
+    assert(counter);
+    Counter before = *counter;
+    if(count_tokens(tokenizer, counter, imported_words) < 0)
+        return -1;
+    return record_file(path, begin, &before, counter, file);
+}
+
+/* Conta le parole lette dal tokenizer, senza contare un file */
+int count_tokens(Tokenizer *tokenizer, Counter *counter, const ImportedWords *imported_words){
+    assert(counter);
+    if(update)
+        assert(imported_words);
+    Counting counting = {counter, imported_words, 0};
+    WordFilterCounts counts;
+    if(wordfilter_count_tokens(tokenizer, OptArgs.words_filter, count_word, &counting, &counts) < 0)
+        return -1;
+    counter->bytes += tokenizer_get_bytes(tokenizer);
+    counter->tokens += counts.tokens;
+    counter->valid_tokens += counts.counted_tokens;
+    return 0;
+}
+
+/* Conta una parola accettata dal filtro; con --update solo se era nell'output precedente */
+int count_word(const Token *token, void *counting){
+    Counting *current = counting;
+    if(update && !imported_words_contains(token, current->imported_words))
+        return 1;
+    if(save_word(token, current->counter, current->imported_words) < 0)
+        return -1;
+    current->counted++;
+    if(spill && (current->counter->valid_tokens + current->counted) % SPILL_CHECK_INTERVAL == 0 && counter_spill_if_full(current->counter) < 0)
+        return -1;
+    return 0;
+}
+
+/* Conta il file e lo registra nel log; before sono i conteggi prima del file */
+int record_file(const char *path, double begin, const Counter *before, Counter *counter, const ReadAheadFile *file){
+    counter->files++;
     if(log){
-        if(write_log_line(OptArgs.log_path, path, words_valid, words_ignored,time_spent) < 0){
+        size_t words_count = counter->tokens - before->tokens, words_valid = counter->valid_tokens - before->valid_tokens;
+        FileLogEntry entry = {path, words_valid, words_count - words_valid, counter->bytes - before->bytes, get_time() - begin,
+            (file) ? file->read_seconds : 0, (file) ? file->wait_seconds : 0};
+        if(filelog_write(&entry, file_log) < 0){
             return -1;
         }
     }
     return 0;
 }
 
-int save_word(char *word, Trie *words, AVLTree *occurr_words, Trie *imported_words){
-    assert(words);
-    assert(occurr_words);
-    if(update)
-        assert(imported_words);
-    if (sortbyoccurrency){
-        int old_occ = trie_get_word_occurrences(word, words);
-        if (old_occ != 0)
-            trie_remove(word, avltree_get_element_by_key(old_occ, occurr_words));
-        if (!avltree_contains_key(old_occ + 1, occurr_words))
-            if (avltree_insert(old_occ + 1, trie_new(), occurr_words) < 0)
-                return -1;
-        Trie *occ_trie = avltree_get_element_by_key(old_occ + 1, occurr_words);
-        if (trie_insert_with_occ(word, old_occ + 1, occ_trie) < 0)
-            return -1;
+/*
+ * Restituisce la dimensione del file se va diviso tra i thread,
+ * altrimenti 0. Con --approx i file non vengono divisi, perché
+ * unire gli sketch cambierebbe le stime.
+ */
+off_t get_split_size(int fd){
+    if(OptArgs.split_size_mb == 0 || OptArgs.threads < 2 || approx){
+        return 0;
     }
-    if ((trie_insert(word, words) < 0))
+    struct stat info;
+    if(fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)){
+        return 0;
+    }
+    return (info.st_size > (off_t) OptArgs.split_size_mb * 1024 * 1024) ? info.st_size : 0;
+}
+
+/*
+ * Divide il file in intervalli che terminano su uno spazio: il primo
+ * viene contato dal thread chiamante, gli altri da thread dedicati,
+ * ognuno con i propri conteggi, uniti infine a counter. I thread
+ * dedicati sono quelli ancora disponibili tra i --threads - 1 condivisi
+ * dai worker, quindi senza thread liberi il file è un intervallo solo.
+ * I conteggi sono quelli della lettura sequenziale del file.
+ */
+int process_file_ranges(const char *path, int fd, off_t size, double begin, Counter *counter, const ImportedWords *imported_words, const ReadAheadFile *file){
+    unsigned int extra_threads = reserve_range_threads(OptArgs.threads - 1);
+    unsigned int count = extra_threads + 1;
+    FileRange *ranges = calloc(count, sizeof(FileRange));
+    if(!ranges){
+        release_range_threads(extra_threads);
         return -1;
-    return 0;
+    }
+    int res = 0;
+    off_t boundary = 0;
+    for(unsigned int i = 0; i < count && res == 0; i++){
+        FileRange *range = &ranges[i];
+        range->fd = fd;
+        range->begin = boundary;
+        range->end = size;
+        if(i < count - 1){
+            off_t nominal = size / count * (i + 1);
+            range->end = find_range_boundary(fd, (nominal > boundary) ? nominal : boundary, size);
+            if(range->end < 0){
+                res = -1;
+                break;
+            }
+        }
+        boundary = range->end;
+        range->imported_words = imported_words;
+        if(counter_init(&range->counter) < 0){
+            res = -1;
+        }
+    }
+    unsigned int started = 1;
+    for(; res == 0 && started < count; started++){
+        if(pthread_create(&ranges[started].thread, NULL, range_run, &ranges[started]) != 0){
+            res = -1;
+            break;
+        }
+    }
+    if(res == 0){
+        range_run(&ranges[0]);
+    }
+    Counter before = *counter;
+    for(unsigned int i = 0; i < count; i++){
+        if(i > 0 && i < started){
+            pthread_join(ranges[i].thread, NULL);
+        }
+        if(res == 0 && (ranges[i].result < 0 || counter_merge(&ranges[i].counter, counter) < 0)){
+            res = -1;
+        }
+        counter_destroy(&ranges[i].counter);
+    }
+    free(ranges);
+    release_range_threads(extra_threads);
+    if(res < 0){
+        return -1;
+    }
+    return record_file(path, begin, &before, counter, file);
 }
 
-char *get_word(FILE *fp){
-    char word[200];
-    int ch, i=0;
+/* Restituisce quanti dei wanted thread sono stati riservati, anche 0 */
+unsigned int reserve_range_threads(unsigned int wanted){
+    pthread_mutex_lock(&range_threads_mutex);
+    unsigned int reserved = (range_threads < wanted) ? range_threads : wanted;
+    range_threads -= reserved;
+    pthread_mutex_unlock(&range_threads_mutex);
+    return reserved;
+}
 
-    while(EOF != (ch=fgetc(fp)) && isblank(ch) && isspace(ch))
-        ;
-    if(ch == EOF)
-        return NULL;
+void release_range_threads(unsigned int reserved){
+    pthread_mutex_lock(&range_threads_mutex);
+    range_threads += reserved;
+    pthread_mutex_unlock(&range_threads_mutex);
+}
+
+/* Restituisce la posizione del primo spazio da from in poi, size se non c'è */
+off_t find_range_boundary(int fd, off_t from, off_t size){
+    char buffer[BOUNDARY_PROBE_SIZE];
+    uint64_t delimiters[BOUNDARY_PROBE_SIZE / 64], non_alnum[BOUNDARY_PROBE_SIZE / 64], digits[BOUNDARY_PROBE_SIZE / 64];
+    while(from < size){
+        ssize_t res = pread(fd, buffer, sizeof(buffer), from);
+        if(res < 0 && errno == EINTR){
+            continue;
+        }
+        if(res <= 0){
+            return (res < 0) ? -1 : size;
+        }
+        charclass_scan(buffer, res, delimiters, non_alnum, digits);
+        for(size_t word = 0; word < ((size_t) res + 63) / 64; word++){
+            if(delimiters[word]){
+                return from + word * 64 + __builtin_ctzll(delimiters[word]);
+            }
+        }
+        from += res;
+    }
+    return size;
+}
+
+void *range_run(void *args){
+    FileRange *range = args;
+    Tokenizer *tokenizer = tokenizer_new_reader(read_range, range);
+    range->result = (tokenizer) ? count_tokens(tokenizer, &range->counter, range->imported_words) : -1;
+    tokenizer_destroy(tokenizer);
+    return NULL;
+}
+
+/* Legge l'intervallo con pread(), così i thread condividono il file descriptor */
+ssize_t read_range(void *context, char *buffer, size_t size){
+    FileRange *range = context;
+    if((off_t) size > range->end - range->begin){
+        size = range->end - range->begin;
+    }
+    if(size == 0){
+        return 0;
+    }
+    ssize_t res;
     do{
-        word[i++] = tolower(ch);
-    }while(EOF!=(ch=fgetc(fp)) && !isblank(ch) && !isspace(ch));
+        res = pread(range->fd, buffer, size, range->begin);
+    }while(res < 0 && errno == EINTR);
+    if(res > 0){
+        range->begin += res;
+    }
+    return res;
+}
+
+/* Conta le parole del file a parte, per registrarne le occorrenze nel manifest */
+int process_recorded_file(const char *path, Counter *counter, ManifestWriter *manifest_writer){
+    ManifestFile file;
+    if(describe_file(path, true, &file) < 0){
+        return -1;
+    }
+    Counter file_counter = {wordcount_new(OptArgs.engine, false), NULL, NULL, false, 0, 0, 0, 0};
+    if(!file_counter.words){
+        return -1;
+    }
+    int res = process_file(path, &file_counter, NULL);
+    if(res == 0){
+        pthread_mutex_lock(&manifest_mutex);
+        res = manifest_writer_begin_file(&file, manifest_writer);
+        if(res == 0){
+            res = wordcount_visit(file_counter.words, manifest_writer_add_word, manifest_writer);
+        }
+        pthread_mutex_unlock(&manifest_mutex);
+    }
+    if(res == 0){
+        res = wordcount_merge(file_counter.words, counter->words);
+        counter->files += file_counter.files;
+        counter->bytes += file_counter.bytes;
+        counter->tokens += file_counter.tokens;
+        counter->valid_tokens += file_counter.valid_tokens;
+    }
+    counter_destroy(&file_counter);
+    return (res == 0) ? 0 : -1;
+}
 
-    word[i]='\0';
-    return strdup(word);
+int describe_file(const char *path, bool hash, ManifestFile *file){
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return -1;
+    }
+    struct stat info;
+    int res = fstat(fd, &info);
+    if(res == 0){
+        file->path = path;
+        file->device = info.st_dev;
+        file->inode = info.st_ino;
+        file->mtime_sec = info.st_mtim.tv_sec;
+        file->mtime_nsec = info.st_mtim.tv_nsec;
+        file->size = info.st_size;
+        file->hash = 0;
+        if(hash){
+            res = manifest_hash_fd(fd, &file->hash);
+        }
+    }
+    close(fd);
+    return res;
 }
 
-int write_log_line(char *logfilepath, char *name, int cw, int iw, double time){
-    static char *log_filename;
-    FILE *logfile;
-    if(!log_filename){
-        log_filename  = malloc(strlen(logfilepath) + 5);
-        snprintf(log_filename,50,"%s.csv",logfilepath);
-        logfile = fopen(log_filename, "w");
+/*
+ * Un file è invariato se ha gli stessi metadati registrati, oppure
+ * se ha la stessa dimensione e lo stesso contenuto.
+ * current riceve i metadati attuali.
+ */
+int file_is_unchanged(const char *path, const ManifestFile *recorded, ManifestFile *current){
+    if(describe_file(path, false, current) < 0){
+        return -1;
+    }
+    current->hash = recorded->hash;
+    if(current->size != recorded->size){
+        return 0;
     }
-    logfile = fopen(log_filename, "a");
-    if (!logfile)
+    if(current->device == recorded->device && current->inode == recorded->inode
+        && current->mtime_sec == recorded->mtime_sec && current->mtime_nsec == recorded->mtime_nsec){
+        return 1;
+    }
+    if(describe_file(path, true, current) < 0){
+        return -1;
+    }
+    return (current->hash == recorded->hash) ? 1 : 0;
+}
+
+int add_word(const char *word, int occurrences, void *words){
+    return (wordcount_insert_n(word, strlen(word), occurrences, words) < 0) ? -1 : 0;
+}
+
+int subtract_word(const char *word, int occurrences, void *words){
+    return (wordcount_subtract_n(word, strlen(word), occurrences, words) < 0) ? -1 : 0;
+}
+
+/* Impronta delle opzioni che cambiano i conteggi di un file */
+uint64_t get_settings_fingerprint(){
+    return wordfilter_get_fingerprint(OptArgs.words_filter);
+}
+
+int save_word(const Token *token, Counter *counter, const ImportedWords *imported_words){
+    assert(counter);
+    if(update)
+        assert(imported_words);
+    if(approx)
+        return spacesaving_offer(token->word, token->length, 1, counter->top_words);
+    if(counter->map)
+        return wordmap_insert_n(token->word, token->length, 1, counter->map);
+    if ((wordcount_insert_n(token->word, token->length, 1, counter->words) < 0))
         return -1;
-    fprintf(logfile, "%s;%d;%d;%lf\n", name, cw, iw, time);
-    fclose(logfile);
     return 0;
 }
 
-void save_output(char *output_path, Trie *words, AVLTree *occurr_words){
-    assert(occurr_words);
-    assert(words);
-    int res = 0;
-    if(sortbyoccurrency){
-        AVLTreeIterator *avliterator = avltree_iterator_new(occurr_words);
-        while(avltree_iterator_has_next(avliterator)){
-            avltree_iterator_advance(avliterator);
-            res = save_trie_on_file(output_path, avltree_iterator_get_element(avliterator));
-            if(res < 0){
-                die("Error in output file");
-            }
+/*
+ * La sovrapposizione è la parte del tempo di lettura nascosta
+ * dall'elaborazione, cioè non passata ad attendere i file.
+ */
+int write_log_summary(const ReadAheadStats *stats){
+    double overlap = 1;
+    if(stats->read_seconds > 0){
+        overlap = 1 - stats->wait_seconds / stats->read_seconds;
+        overlap = (overlap < 0) ? 0 : overlap;
+    }
+    char summary[256];
+    snprintf(summary, sizeof(summary), "readahead backend=%s files=%zu bytes=%zu read=%lf stall=%lf wait=%lf overlap=%.1lf%%",
+        (stats->io_uring) ? "io_uring" : "read", stats->files, stats->bytes, stats->read_seconds, stats->stall_seconds, stats->wait_seconds, overlap * 100);
+    return filelog_write_comment(summary, file_log);
+}
+
+/*
+ * Scrive le misure di --stats su stderr o sul file indicato.
+ * I bucket delle occorrenze sono i valori distinti delle occorrenze,
+ * cioè i gruppi in cui l'ordinamento per occorrenze divide le parole
+ * (i nodi dell'AVLTree che un tempo lo realizzava).
+ */
+int write_stats(Counter *counter){
+    stats_set_counter("files", counter->files, run_stats);
+    stats_set_counter("bytes", counter->bytes, run_stats);
+    stats_set_counter("tokens", counter->tokens, run_stats);
+    stats_set_counter("counted_tokens", counter->valid_tokens, run_stats);
+    if(counter->words || counter->map){
+        /* Le parole sono già state visitate per l'output, salvo che l'output non le visiti tutte */
+        if(!word_stats.collected && visit_words(counter, false, ignore_word, NULL) != 0){
+            return -1;
         }
-        avltree_iterator_destroy(avliterator);
-    } else {
-        res = save_trie_on_file(output_path, words);
-        if(res < 0){
-            die("Error in output file");
+        stats_set_counter("distinct_words", word_stats.words, run_stats);
+        if(counter->map){
+            stats_set_counter("map_bytes", wordmap_get_memory_usage(counter->map), run_stats);
+        } else if(wordcount_get_engine(counter->words) == WORDCOUNT_HASH){
+            stats_set_counter("hash_slots", wordcount_get_nodes_count(counter->words), run_stats);
+            stats_set_counter("hash_bytes", wordcount_get_memory_usage(counter->words), run_stats);
+        } else {
+            stats_set_counter("trie_nodes", wordcount_get_nodes_count(counter->words), run_stats);
+            stats_set_counter("trie_bytes", wordcount_get_memory_usage(counter->words), run_stats);
         }
+        stats_set_counter("occurrence_buckets", word_stats.buckets, run_stats);
+    }
+    if(spill){
+        stats_set_counter("spill_runs", spill_get_runs_count(spill), run_stats);
+        stats_set_counter("spill_bytes", spill_get_bytes(spill), run_stats);
     }
+    FILE *file = (OptArgs.stats_path) ? fopen(OptArgs.stats_path, "w") : stderr;
+    if(!file){
+        return -1;
+    }
+    int res = stats_write(file, run_stats);
+    if(file != stderr && fclose(file) != 0){
+        res = -1;
+    }
+    return res;
 }
 
-int save_trie_on_file(char *filepath, Trie *trie){
-    char *write_mode = (sortbyoccurrency) ? "a" : "w";
-    int res = 0;
-    FILE *file = fopen(filepath, write_mode);
-    if(!file){
+int collect_word_stats(const char *word, int occurrences, void *visit){
+    StatsVisit *current = visit;
+    if(add_occurrence_bucket(occurrences) < 0){
         return -1;
     }
-    List *wordlist = trie_get_wordlist(trie);
-    ListIterator *wl_iterator = list_iterator_new(wordlist);
-    while(list_iterator_has_next(wl_iterator)){
-        list_iterator_advance(wl_iterator);
-        res = fprintf(file, "%s\n", list_iterator_get_element(wl_iterator));
-        if(res < 0) return -1;
+    word_stats.words++;
+    return current->visitor(word, occurrences, current->context);
+}
+
+int add_occurrence_bucket(int occurrences){
+    if(occurrences <= 0){
+        return 0;
+    }
+    if((word_stats.buckets + 1) * 2 > word_stats.capacity){
+        size_t capacity = (word_stats.capacity) ? word_stats.capacity * 2 : 1024;
+        int *buckets = calloc(capacity, sizeof(int));
+        if(!buckets){
+            return -1;
+        }
+        for(size_t i = 0; i < word_stats.capacity; i++){
+            if(word_stats.occurrences[i] != 0){
+                insert_occurrence_bucket(word_stats.occurrences[i], buckets, capacity);
+            }
+        }
+        free(word_stats.occurrences);
+        word_stats.occurrences = buckets;
+        word_stats.capacity = capacity;
+    }
+    if(insert_occurrence_bucket(occurrences, word_stats.occurrences, word_stats.capacity)){
+        word_stats.buckets++;
     }
-    list_iterator_destroy(wl_iterator);
-    list_destroy(wordlist);
     return 0;
 }
 
-bool word_is_valid(const char *word){
-    if(!word){
-        return false;
+/* Restituisce true se occurrences non era nell'insieme; capacity è una potenza di 2 */
+bool insert_occurrence_bucket(int occurrences, int *buckets, size_t capacity){
+    size_t slot = ((uint32_t) occurrences * 2654435761u) & (capacity - 1);
+    while(buckets[slot] != 0){
+        if(buckets[slot] == occurrences){
+            return false;
+        }
+        slot = (slot + 1) & (capacity - 1);
     }
-    if(strlen(word) < OptArgs.minimum_word_length){
-        return false;
+    buckets[slot] = occurrences;
+    return true;
+}
+
+int ignore_word(const char *word, int occurrences, void *context){
+    (void) word;
+    (void) occurrences;
+    (void) context;
+    return 0;
+}
+
+/* Tempo reale monotono, non influenzato dalle modifiche dell'orologio di sistema */
+double get_time(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Con temp_path il testo viene scritto lì e poi sostituisce l'output.
+ * Lo snapshot viene completato per ultimo, quando il testo è chiuso e
+ * al suo posto, così non risulta mai più vecchio dell'output che
+ * descrive; se la scrittura si interrompe prima, lo snapshot rimasto
+ * è più vecchio e --update lo ignora.
+ */
+void save_output(char *output_path, char *temp_path, Counter *counter){
+    assert(counter);
+    int fd = open((temp_path) ? temp_path : output_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(fd < 0){
+        die("Error in output file");
     }
-    for(int i = 0; i < strlen(word); i++){
-        if(!isalnum(word[i]))
-            return false;
-        if(alpha && isdigit(word[i]))
-            return false;
+    Output output = {NULL, NULL};
+    output.text = writer_new(fd, OUTPUT_BUFFER_SIZE);
+    int res = (output.text) ? 0 : -1;
+    if(res == 0 && snapshot){
+        output.snapshot = snapshot_writer_new(OptArgs.snapshot_path);
+        if(!output.snapshot){
+            res = -1;
+        }
     }
-    if(trie_contains(word, OptArgs.words_to_ignore)){
-        return false;
+    if(res == 0){
+        if(approx){
+            res = spacesaving_visit(counter->top_words, write_word_estimate, &output);
+        } else if(OptArgs.top > 0){
+            res = save_top_words(counter, &output);
+        } else {
+            res = visit_words(counter, sortbyoccurrency, write_word, &output);
+        }
     }
-    return true;
+    if(res == 0){
+        res = writer_flush(output.text);
+    }
+    writer_destroy(output.text);
+    if(close(fd) != 0){
+        res = -1;
+    }
+    if(res == 0 && temp_path){
+        res = rename(temp_path, output_path);
+    }
+    if(res == 0 && output.snapshot){
+        res = snapshot_writer_close(output.snapshot);
+        output.snapshot = NULL;
+    }
+    snapshot_writer_destroy(output.snapshot);
+    if(res != 0){
+        die("Error in output file");
+    }
+}
+
+/* Scrive le parole in ordine alfabetico nel formato binario letto da --merge */
+void save_partial(const char *output_path, Counter *counter){
+    RunWriter *writer = runfile_writer_new(output_path, RUNFILE_BY_WORD);
+    if(!writer){
+        die("Error in output file");
+    }
+    if(visit_words(counter, false, runfile_writer_add, writer) != 0){
+        runfile_writer_destroy(writer);
+        die("Error in output file");
+    }
+    if(runfile_writer_close(writer) < 0){
+        die("Error in output file");
+    }
+}
+
+int save_top_words(Counter *counter, Output *output){
+    TopK *topk = topk_new(OptArgs.top);
+    if(!topk){
+        return -1;
+    }
+    int res = visit_words(counter, false, offer_word, topk);
+    if(res == 0){
+        res = topk_visit(topk, write_word, output);
+    }
+    topk_destroy(topk);
+    return res;
+}
+
+int offer_word(const char *word, int occurrences, void *topk){
+    return topk_offer(word, occurrences, topk);
+}
+
+int write_word(const char *word, int occurrences, void *output){
+    Writer *writer = ((Output *) output)->text;
+    if(writer_write(word, strlen(word), writer) < 0 || writer_write_char(' ', writer) < 0){
+        return -1;
+    }
+    if(writer_write_int(occurrences, writer) < 0 || writer_write_char('\n', writer) < 0){
+        return -1;
+    }
+    SnapshotWriter *snapshot_writer = ((Output *) output)->snapshot;
+    return (snapshot_writer) ? snapshot_writer_add(word, occurrences, snapshot_writer) : 0;
+}
+
+/* Le occorrenze reali sono comprese tra il minimo garantito e la stima */
+int write_word_estimate(const char *word, int count, int error, void *output){
+    Writer *writer = ((Output *) output)->text;
+    if(writer_write(word, strlen(word), writer) < 0 || writer_write_char(' ', writer) < 0){
+        return -1;
+    }
+    if(writer_write_int(count, writer) < 0 || writer_write(" (min ", 6, writer) < 0){
+        return -1;
+    }
+    if(writer_write_int(count - error, writer) < 0 || writer_write(")\n", 2, writer) < 0){
+        return -1;
+    }
+    SnapshotWriter *snapshot_writer = ((Output *) output)->snapshot;
+    return (snapshot_writer) ? snapshot_writer_add(word, count, snapshot_writer) : 0;
 }
 
 char *get_absolute_path(const char *path){
@@ -465,29 +1815,189 @@ int convert_to_int(const char *text){
     return result;
 }
 
+WordCount *words_count_new(){
+    return wordcount_new(OptArgs.engine, hugepages);
+}
+
+int counter_init(Counter *counter){
+    counter->words = NULL;
+    counter->map = word_map;
+    counter->top_words = NULL;
+    counter->live = true;
+    atomic_fetch_add(&live_counters, 1);
+    counter->files = 0;
+    counter->bytes = 0;
+    counter->tokens = 0;
+    counter->valid_tokens = 0;
+    if(approx){
+        counter->top_words = spacesaving_new(OptArgs.top);
+        return (counter->top_words) ? 0 : -1;
+    }
+    if(counter->map){
+        return 0;
+    }
+    counter->words = words_count_new();
+    return (counter->words) ? 0 : -1;
+}
+
+int counter_merge(const Counter *source, Counter *destination){
+    destination->files += source->files;
+    destination->bytes += source->bytes;
+    destination->tokens += source->tokens;
+    destination->valid_tokens += source->valid_tokens;
+    if(approx){
+        return spacesaving_merge(source->top_words, destination->top_words);
+    }
+    /* I thread hanno già contato le parole nella mappa condivisa */
+    if(source->map){
+        return 0;
+    }
+    if(wordcount_merge(source->words, destination->words) < 0){
+        return -1;
+    }
+    return (spill) ? counter_spill_if_full(destination) : 0;
+}
+
+/* Il limite di --memory-limit è diviso tra tutti i conteggi esistenti */
+int counter_spill_if_full(Counter *counter){
+    if(wordcount_get_memory_usage(counter->words) < get_counter_memory_limit()){
+        return 0;
+    }
+    return counter_spill(counter);
+}
+
+/* Un conteggio vuoto non viene scaricato, così non aggiunge un file vuoto */
+int counter_spill(Counter *counter){
+    if(wordcount_is_empty(counter->words)){
+        return 0;
+    }
+    if(spill_write(counter->words, spill) < 0){
+        return -1;
+    }
+    wordcount_destroy(counter->words);
+    counter->words = words_count_new();
+    return (counter->words) ? 0 : -1;
+}
+
+size_t get_counter_memory_limit(){
+    unsigned int counters = atomic_load(&live_counters);
+    return (size_t) OptArgs.memory_limit_mb * 1024 * 1024 / ((counters > 0) ? counters : 1);
+}
+
+/*
+ * Con --stats ogni visita raccoglie di nuovo le WordStats: gli output
+ * scritti con --flush-mb o --flush-seconds visitano conteggi parziali,
+ * quindi valgono quelle dell'ultima visita, cioè dell'output finale.
+ */
+int visit_words(Counter *counter, bool by_occurrences, WordCountVisitor visitor, void *context){
+    if(!print_stats){
+        return visit_counted_words(counter, by_occurrences, visitor, context);
+    }
+    word_stats.words = 0;
+    word_stats.buckets = 0;
+    if(word_stats.occurrences){
+        memset(word_stats.occurrences, 0, word_stats.capacity * sizeof(int));
+    }
+    StatsVisit visit = {visitor, context};
+    int res = visit_counted_words(counter, by_occurrences, collect_word_stats, &visit);
+    word_stats.collected = (res == 0);
+    return res;
+}
+
+/*
+ * Visita le parole contate dovunque si trovino. Se una parte è stata
+ * scaricata su disco, le parole in memoria vengono unite agli scarichi
+ * senza scaricarle, così le scritture di --flush-mb e --flush-seconds
+ * non aggiungono file. L'ordinamento per occorrenze usa la memoria di
+ * --memory-limit lasciata libera dalle parole in memoria.
+ */
+int visit_counted_words(Counter *counter, bool by_occurrences, WordCountVisitor visitor, void *context){
+    if(counter->map){
+        return (by_occurrences) ? wordmap_visit_by_occurrences(counter->map, visitor, context)
+            : wordmap_visit(counter->map, visitor, context);
+    }
+    if(spill && spill_get_runs_count(spill) > 0){
+        if(!by_occurrences){
+            return spill_visit(spill, counter->words, visitor, context);
+        }
+        size_t limit = (size_t) OptArgs.memory_limit_mb * 1024 * 1024;
+        size_t used = wordcount_get_memory_usage(counter->words);
+        size_t block_limit = (used < limit / 2) ? limit - used : limit / 2;
+        return spill_visit_by_occurrences(spill, counter->words, block_limit, visitor, context);
+    }
+    return (by_occurrences) ? wordcount_visit_by_occurrences(counter->words, visitor, context)
+        : wordcount_visit(counter->words, visitor, context);
+}
+
+void counter_destroy(Counter *counter){
+    if(counter->live){
+        atomic_fetch_sub(&live_counters, 1);
+        counter->live = false;
+    }
+    wordcount_destroy(counter->words);
+    spacesaving_destroy(counter->top_words);
+}
+
 void initialize_global(){
     recursive = false;
     follow = false;
-    alpha = false;
     sortbyoccurrency = false;
     update = false;
     log = false;
+    hugepages = false;
+    approx = false;
+    snapshot = false;
+    io_uring = false;
+    print_stats = false;
+    shared_map = false;
+    merge = false;
+    counting_options = false;
+    engine_selected = false;
 
-    OptArgs.files_to_exclude = list_new();
+    OptArgs.files_to_exclude = exclude_set_new();
     if(!OptArgs.files_to_exclude) die(NULL);
-    OptArgs.minimum_word_length = 0;
-    OptArgs.words_to_ignore = trie_new();
-    if(!OptArgs.words_to_ignore) die(NULL);
-    files = list_new();
-    if(!files) die(NULL);
+    OptArgs.threads = 1;
+    OptArgs.top = 0;
+    OptArgs.readers = DEFAULT_READERS;
+    OptArgs.queue_depth = DEFAULT_QUEUE_DEPTH;
+    OptArgs.buffer_size_kb = DEFAULT_BUFFER_SIZE_KB;
+    OptArgs.flush_mb = 0;
+    OptArgs.flush_seconds = 0;
+    OptArgs.split_size_mb = DEFAULT_SPLIT_SIZE_MB;
+    OptArgs.memory_limit_mb = 0;
+    OptArgs.temp_directory = NULL;
+    OptArgs.shard_index = 0;
+    OptArgs.shard_count = 0;
+    OptArgs.engine = WORDCOUNT_TRIE;
+    OptArgs.words_filter = wordfilter_new();
+    if(!OptArgs.words_filter) die(NULL);
+    files = NULL;
+    word_map = NULL;
+    spill = NULL;
+    streams = list_new();
+    if(!streams) die(NULL);
+    file_log = NULL;
+    run_stats = stats_new();
+    if(!run_stats) die(NULL);
+    word_stats = (WordStats) {false, 0, NULL, 0, 0};
 }
 
 void free_global(){
-    list_destroy(OptArgs.files_to_exclude);
-    trie_destroy(OptArgs.words_to_ignore);
+    exclude_set_destroy(OptArgs.files_to_exclude);
+    wordfilter_destroy(OptArgs.words_filter);
     free(OptArgs.output_path);
     free(OptArgs.log_path);
-    list_destroy(files);
+    free(OptArgs.snapshot_path);
+    free(OptArgs.manifest_path);
+    free(OptArgs.stats_path);
+    free(OptArgs.temp_directory);
+    walker_destroy(files);
+    list_destroy(streams);
+    wordmap_destroy(word_map);
+    spill_destroy(spill);
+    filelog_close(file_log);
+    stats_destroy(run_stats);
+    free(word_stats.occurrences);
 }
 
 void exit_success(){
@@ -502,21 +2012,64 @@ void die(char *message){
 }
 
 void print_help(){
-    printf("\tUsage: swordx [options] [inputs]\n\n");
+    printf("\tUsage: swordx [options] [inputs]\n");
+    printf("\t       swordx --merge [options] [partials]\n\n");
+    printf("\tAn input can be a file, a folder, a glob pattern, a FIFO or - for the standard input;\n");
+    printf("\tFIFOs and the standard input are read in blocks as data arrives, after the other inputs\n");
+    printf("\tswordx --merge combines the partial counts written with --shard into the output, with -o, -s, --top, --snapshot and --stats\n\n");
     printf("  HELP:\n");
     printf("\t-h / --help : help\n");
     printf("  OUTPUTS:\n");
     printf("\t-o / --output : output filename\n");
     printf("\t-l / --log <file> : viene generato un file di log\n");
+    printf("\t\t<file>.csv has a row per file: words, ignored words, wall-clock seconds, bytes, tokens, tokens/s and MB/s\n");
+    printf("\t--stats[=<file>] : JSON measures are written to stderr or to <file>: wall and CPU time of each phase, bytes, tokens, distinct words, trie nodes and bytes (map bytes with --shared-map), occurrence buckets, peak RSS and allocations\n");
     printf("\t-s / --sortbyoccurrency : le parole nel file di output vengono inserite per numero di occorrenze\n");
     printf("\t--update <file> : viene fatto update\n");
+    printf("\t--manifest <file> : the processed files are recorded in <file>; the next run with the same <file> only processes added, changed or removed files\n");
+    printf("\t--snapshot : a binary snapshot of the output is also written to <output>.snap; --update reads it instead of the output when it is up to date\n");
+    printf("\t--top <num> : only the <num> most frequent words are written, sorted by occurrences\n");
+    printf("\t--flush-mb <num> : while reading a FIFO or the standard input, the output is rewritten after every <num> MB\n");
+    printf("\t--flush-seconds <num> : while reading a FIFO or the standard input, the output is rewritten every <num> seconds, even if no data arrives\n");
+    printf("\t--shard <i>/<N> : only the files whose path hash falls in shard <i> of <N> (1 <= <i> <= <N>) are counted; the output is a binary partial count for --merge\n");
+    printf("\t\tevery shard must be given the same inputs: a file is assigned by the input name and its path below the input, so the inputs may be in different folders\n");
+    printf("\t--merge : the inputs are partial counts written with --shard, combined into one output as if all the files had been counted together\n");
+    printf("\t--approx : with --top, words are counted in memory proportional to <num>; each count is an upper bound followed by the guaranteed minimum\n");
     printf("  FOLDERS:\n");
     printf("\t-r / --recursive : all subdirectories are followed in the process\n");
     printf("\t-f / --follow : links are followed in the process\n");
     printf("\t-e / --exclude <file> the specified file is not considered in processing\n");
+    printf("\t\ta folder is skipped with all its subfolders; <file> can be a glob pattern (\"*.log\", \"build/*\")\n");
     printf("  WORDS:\n");
     printf("\t-a / --alpha : only words containing alphabetic characters are considered in the statistics\n");
     printf("\t-m / --min <num> : the minimum word length\n");
     printf("\t-i / --ignore <file> : the file is list of word (one for lines) who ignored in the stats\n");
+    printf("  PERFORMANCE:\n");
+    printf("\t-t / --threads <num> : folders are walked and files are processed by <num> threads\n");
+    printf("\t--split-size <MiB> : files larger than <MiB> are split in up to --threads ranges counted in parallel, with the threads not already counting other split files (default %d, 0 disables)\n", DEFAULT_SPLIT_SIZE_MB);
+    printf("\t--shared-map : all threads count in one concurrent hash map instead of a trie each, so memory does not grow with --threads\n");
+    printf("\t--engine trie|hash : words are counted in a trie (default) or in a hash table sorted only when the output is written; the output is the same. Not valid with --shared-map or --approx, which count in their own structures\n");
+    printf("\t--memory-limit <MiB> : when the words counted by a thread exceed <MiB> divided by the counts in use, one per thread and per range of a split file, they are written to a sorted run on disk and counting restarts; the runs are merged when the output is written\n");
+    printf("\t--temp-dir <dir> : the --memory-limit runs are written in a new folder inside <dir> (default $TMPDIR or %s), removed at exit\n", DEFAULT_TEMP_DIRECTORY);
+    printf("\t--hugepages : the words trie is allocated on huge pages when available\n");
+    printf("\t--readers <num> : files are opened and read ahead by <num> threads while the others split them in words (default %d: files are read by the threads that count them)\n", DEFAULT_READERS);
+    printf("\t--queue-depth <num> : at most <num> files are read ahead (default %d)\n", DEFAULT_QUEUE_DEPTH);
+    printf("\t--io-uring : files are read ahead with io_uring, keeping up to --queue-depth files in flight; read() is used when io_uring is not available\n");
+    printf("\t--buffer-size <KiB> : the first <KiB> of each file are read ahead, the rest is read by the kernel (default %d)\n", DEFAULT_BUFFER_SIZE_KB);
     printf("\n\n");
-}
\ No newline at end of file
+}
+
+/* Cerca --stats prima di process_command(), anche abbreviata come la accetta getopt_long() */
+bool stats_requested(int argc, char *argv[]){
+    for(int i = 1; i < argc && strcmp(argv[i], "--") != 0; i++){
+        if(strncmp(argv[i], "--", 2) != 0){
+            continue;
+        }
+        const char *name = argv[i] + 2;
+        size_t length = strcspn(name, "=");
+        if(length >= 2 && length <= strlen("stats") && strncmp(name, "stats", length) == 0){
+            return true;
+        }
+    }
+    return false;
+}
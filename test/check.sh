@@ -0,0 +1,66 @@
+#!/bin/sh
+# Verifiche di regressione di swordx, eseguite da make check.
+# Uso: test/check.sh <swordx>
+
+SWORDX=$1
+WORK=$(mktemp -d)
+FAILED=0
+trap 'rm -rf "$WORK"' EXIT
+
+fail(){
+    echo "FAIL: $1"
+    FAILED=1
+}
+
+# --stats con --flush-seconds riporta i conteggi dell'output finale, non dell'ultimo parziale
+check_stats_after_flush(){
+    mkfifo "$WORK/fifo"
+    ( echo "first"; sleep 2; cat test/hard.txt test/monkey ) > "$WORK/fifo" &
+    "$SWORDX" --flush-seconds 1 --stats="$WORK/stats.json" -o "$WORK/flush.out" "$WORK/fifo" || fail "stats after flush: exit status"
+    wait
+    words=$(wc -l < "$WORK/flush.out")
+    grep -q "\"distinct_words\": $words," "$WORK/stats.json" || fail "stats after flush: distinct_words is not $words"
+}
+
+# Un manifest troncato non è valido: il conteggio torna completo
+check_truncated_manifest(){
+    mkdir "$WORK/tree"
+    cp test/hard.txt test/monkey "$WORK/tree"
+    "$SWORDX" -r "$WORK/tree" --manifest "$WORK/manifest" -o "$WORK/manifest.out" || fail "truncated manifest: first run"
+    truncate -s -5 "$WORK/manifest"
+    echo "added words" >> "$WORK/tree/hard.txt"
+    "$SWORDX" -r "$WORK/tree" --manifest "$WORK/manifest" -o "$WORK/truncated.out" || fail "truncated manifest: exit status"
+    "$SWORDX" -r "$WORK/tree" -o "$WORK/full.out"
+    cmp -s "$WORK/truncated.out" "$WORK/full.out" || fail "truncated manifest: output differs from a full count"
+}
+
+# Con --memory-limit le scritture periodiche non aggiungono scarichi e lo snapshot non è più vecchio dell'output
+check_flush_with_memory_limit(){
+    awk 'BEGIN{for(i = 0; i < 200000; i++){n = i; w = ""; do{w = w sprintf("%c", 97 + n % 26); n = int(n / 26)}while(n > 0); print w}}' > "$WORK/words.txt"
+    "$SWORDX" --memory-limit 1 --stats="$WORK/plain.json" -o "$WORK/plain.out" "$WORK/words.txt" test/hard.txt
+    mkfifo "$WORK/spill_fifo"
+    ( cat "$WORK/words.txt"; sleep 2; cat test/hard.txt ) > "$WORK/spill_fifo" &
+    "$SWORDX" --memory-limit 1 --flush-seconds 1 --snapshot --stats="$WORK/flush.json" -o "$WORK/spill.out" "$WORK/spill_fifo" || fail "flush with memory limit: exit status"
+    wait
+    cmp -s "$WORK/plain.out" "$WORK/spill.out" || fail "flush with memory limit: output differs"
+    [ "$(grep spill_runs "$WORK/plain.json")" = "$(grep spill_runs "$WORK/flush.json")" ] || fail "flush with memory limit: the flushes added spill runs"
+    [ "$WORK/spill.out" -nt "$WORK/spill.out.snap" ] && fail "flush with memory limit: the snapshot is older than the output"
+}
+
+# Due parziali la cui somma supera INT_MAX: --merge fallisce invece di scrivere un conteggio negativo
+check_count_overflow(){
+    for partial in "$WORK/partial1" "$WORK/partial2"; do
+        # Intestazione con una parola, poi 2000000000 occorrenze di "hello"
+        printf 'SWXRUN01\000\000\000\000\000\000\000\000\001\000\000\000\000\000\000\000\000\224\065\167\005\000\000\000hello' > "$partial"
+    done
+    "$SWORDX" --merge -o "$WORK/overflow.out" "$WORK/partial1" "$WORK/partial2" 2>/dev/null && fail "count overflow: --merge succeeded"
+    grep -q -- "-" "$WORK/overflow.out" 2>/dev/null && fail "count overflow: negative count written"
+}
+
+check_stats_after_flush
+check_truncated_manifest
+check_flush_with_memory_limit
+check_count_overflow
+
+[ $FAILED -eq 0 ] && echo "All checks passed."
+exit $FAILED